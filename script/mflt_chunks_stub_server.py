@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026, Nordic Semiconductor ASA
+# SPDX-License-Identifier: Apache-2.0
+"""
+Local stand-in for the Memfault chunks endpoint
+
+Accepts POST /api/v0/chunks/<device serial> with a single chunk
+(application/octet-stream) or several chunks (multipart/mixed) on persistent
+HTTP/1.1 connections, as sent by the firmware's HTTPS upload. Reports chunks
+and requests per connection, so connection reuse and request packing can be
+checked without the Memfault cloud.
+
+Point the firmware at it with:
+  CONFIG_MFLT_UPLOAD_CHUNKS_HOST="<host address>"
+  CONFIG_MFLT_UPLOAD_CHUNKS_PORT=8080
+  CONFIG_MFLT_UPLOAD_CHUNKS_NO_TLS=y    (unless --cert is given)
+"""
+
+import os
+import ssl
+import sys
+import time
+import argparse
+import logging
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+CHUNKS_PATH = '/api/v0/chunks/'
+
+
+def parse_multipart(body: bytes, boundary: bytes) -> list:
+    """Split a multipart/mixed body into its part payloads"""
+    delimiter = b'--' + boundary
+    parts = []
+    pos = body.find(delimiter)
+    if pos < 0:
+        raise ValueError("Boundary not found")
+
+    while True:
+        pos += len(delimiter)
+        if body[pos:pos + 2] == b'--':
+            return parts
+        if body[pos:pos + 2] != b'\r\n':
+            raise ValueError(f"Malformed delimiter at offset {pos}")
+        pos += 2
+
+        header_end = body.find(b'\r\n\r\n', pos)
+        if header_end < 0:
+            raise ValueError(f"Unterminated part header at offset {pos}")
+
+        headers = {}
+        for line in body[pos:header_end].split(b'\r\n'):
+            name, _, value = line.partition(b':')
+            headers[name.strip().lower()] = value.strip()
+        pos = header_end + 4
+
+        # Binary chunks may contain anything, prefer the part length
+        if b'content-length' in headers:
+            end = pos + int(headers[b'content-length'])
+        else:
+            end = body.find(b'\r\n' + delimiter, pos)
+            if end < 0:
+                raise ValueError(f"Unterminated part at offset {pos}")
+
+        parts.append(body[pos:end])
+        pos = body.find(delimiter, end)
+        if pos < 0:
+            raise ValueError("Missing close delimiter")
+
+
+class ChunksHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+    save_dir = None
+    fail_every = 0
+    total_requests = 0
+
+    def setup(self):
+        super().setup()
+        self.requests = 0
+        self.connected_at = time.monotonic()
+        print(f"{self.client_address[0]}: connected")
+
+    def finish(self):
+        super().finish()
+        print(f"{self.client_address[0]}: closed after {self.requests} request(s), "
+              f"{time.monotonic() - self.connected_at:.1f} s")
+
+    def log_message(self, format, *args):
+        logging.debug(f"{self.client_address[0]}: {format % args}")
+
+    def reply(self, status: int):
+        self.send_response(status)
+        self.send_header('Content-Length', '0')
+        self.end_headers()
+
+    def do_POST(self):
+        length = int(self.headers.get('Content-Length', 0))
+        body = self.rfile.read(length)
+        self.requests += 1
+        ChunksHandler.total_requests += 1
+
+        if not self.path.startswith(CHUNKS_PATH):
+            self.reply(404)
+            return
+
+        if not self.headers.get('Memfault-Project-Key'):
+            logging.warning("Request without Memfault-Project-Key")
+
+        if self.fail_every and ChunksHandler.total_requests % self.fail_every == 0:
+            print(f"{self.client_address[0]}: simulating a server error")
+            self.reply(503)
+            return
+
+        serial = self.path[len(CHUNKS_PATH):]
+        content_type = self.headers.get('Content-Type', '')
+
+        try:
+            if content_type.startswith('multipart/mixed'):
+                boundary = content_type.partition('boundary=')[2].strip('"')
+                chunks = parse_multipart(body, boundary.encode())
+            else:
+                chunks = [body]
+        except ValueError as e:
+            print(f"{serial}: malformed request: {e}")
+            self.reply(400)
+            return
+
+        print(f"{serial}: request {self.requests} on connection, {len(body)} bytes, "
+              f"{len(chunks)} chunk(s) of {[len(c) for c in chunks]}")
+
+        if self.save_dir:
+            with open(os.path.join(self.save_dir, f"{serial}.bin"), 'ab') as f:
+                for chunk in chunks:
+                    f.write(chunk)
+
+        self.reply(202)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Local stand-in for the Memfault chunks endpoint')
+    parser.add_argument('-p', '--port', type=int, default=8080, help='Port to listen on')
+    parser.add_argument('--cert', help='Server certificate (PEM), enables HTTPS')
+    parser.add_argument('--key', help='Server private key (PEM)')
+    parser.add_argument('-i', '--idle-timeout', type=float, default=60,
+                        help='Close connections idle for this many seconds')
+    parser.add_argument('-f', '--fail-every', type=int, default=0,
+                        help='Answer every Nth request with HTTP 503')
+    parser.add_argument('-s', '--save-dir', help='Append received chunks to <serial>.bin in this directory')
+    parser.add_argument('-d', '--debug', action='store_true', help='Enable debug output')
+
+    args = parser.parse_args()
+
+    # Configure logging
+    if args.debug:
+        logging.basicConfig(level=logging.DEBUG, format='%(levelname)s: %(message)s')
+    else:
+        logging.basicConfig(level=logging.WARNING, format='%(levelname)s: %(message)s')
+
+    if args.save_dir:
+        os.makedirs(args.save_dir, exist_ok=True)
+
+    ChunksHandler.timeout = args.idle_timeout
+    ChunksHandler.fail_every = args.fail_every
+    ChunksHandler.save_dir = args.save_dir
+
+    server = ThreadingHTTPServer(('', args.port), ChunksHandler)
+
+    if args.cert:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        try:
+            context.load_cert_chain(args.cert, args.key)
+        except (OSError, ssl.SSLError) as e:
+            print(f"Error: cannot load certificate: {e}")
+            sys.exit(1)
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+
+    scheme = 'https' if args.cert else 'http'
+    print(f"Serving {scheme}://0.0.0.0:{args.port}{CHUNKS_PATH}<serial>, "
+          f"idle timeout {args.idle_timeout:g} s")
+
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+    print(f"Handled {ChunksHandler.total_requests} request(s)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026, Nordic Semiconductor ASA
+# SPDX-License-Identifier: Apache-2.0
+"""
+Expand dictionary log CDRs uploaded by the mflt_dict_log module
+
+The blob starts with a header (magic "MFDL", version, records dropped since
+the previous collection, uptime at collection and, from version 2, messages
+rate limited since the previous collection), followed by records of a 16-bit
+little-endian tag:
+
+  0x0000-0x7fff  length of the Zephyr dictionary log message that follows
+  0x8000-0xbfff  repeats of the previous message (version 2 and later)
+  0xc000         uptime in ms of the following messages, 32-bit (version 3)
+  0xc001         the device booted (version 3)
+
+The messages are expanded with Zephyr's dictionary log parser and the
+log_dictionary.json database of the same build, found next to zephyr.elf:
+
+  build/<app>/zephyr/log_dictionary.json
+
+The parser is loaded from $ZEPHYR_BASE/scripts/logging/dictionary.
+"""
+
+import sys
+import os
+import argparse
+import logging
+import struct
+
+BLOB_MAGIC = 0x4c44464d
+HEADERS = {
+    1: struct.Struct('<IB3xII'),
+    2: struct.Struct('<IB3xIII'),
+    3: struct.Struct('<IB3xIII'),
+}
+RECORD_TAG = struct.Struct('<H')
+REC_REPEAT = 0x8000
+REC_META_MASK = 0xc000
+REC_TIME = 0xc000
+REC_BOOT = 0xc001
+
+
+class Repeat(int):
+    """Repeats of the previous message"""
+
+
+class TimeMark(int):
+    """Uptime in ms of the following messages"""
+
+
+BOOT = object()
+
+
+def split_blob(data: bytes):
+    """Return the header fields and the records of a blob
+
+    A record is a dictionary message (bytes), a Repeat, a TimeMark or BOOT.
+    """
+    if len(data) < 5:
+        raise ValueError(f"Blob too short: {len(data)} bytes")
+
+    magic, version = struct.unpack_from('<IB', data)
+    if magic != BLOB_MAGIC:
+        raise ValueError(f"Not a dictionary log blob, magic 0x{magic:08x}")
+    if version not in HEADERS:
+        raise ValueError(f"Unsupported blob version {version}")
+
+    header = HEADERS[version]
+    if len(data) < header.size:
+        raise ValueError(f"Blob too short: {len(data)} bytes")
+    fields = header.unpack_from(data)
+    dropped, uptime_ms = fields[2:4]
+    limited = fields[4] if version >= 2 else 0
+
+    records = []
+    pos = header.size
+    while pos < len(data):
+        if pos + RECORD_TAG.size > len(data):
+            raise ValueError(f"Truncated record tag at offset {pos}")
+        (length,) = RECORD_TAG.unpack_from(data, pos)
+        pos += RECORD_TAG.size
+        if length == REC_TIME and version >= 3:
+            if pos + 4 > len(data):
+                raise ValueError(f"Truncated time mark at offset {pos}")
+            records.append(TimeMark(struct.unpack_from('<I', data, pos)[0]))
+            pos += 4
+            continue
+        if length == REC_BOOT and version >= 3:
+            records.append(BOOT)
+            continue
+        if length & REC_META_MASK == REC_REPEAT or (version < 3 and length & REC_REPEAT):
+            records.append(Repeat(length & ~REC_REPEAT))
+            continue
+        if length & REC_META_MASK:
+            raise ValueError(f"Unknown record tag 0x{length:04x} at offset {pos - 2}")
+        if pos + length > len(data):
+            raise ValueError(f"Truncated record at offset {pos}")
+        records.append(data[pos:pos + length])
+        pos += length
+
+    return dropped, limited, uptime_ms, records
+
+
+def load_parser(zephyr_base: str, db_file: str):
+    sys.path.insert(0, os.path.join(zephyr_base, 'scripts', 'logging', 'dictionary'))
+    try:
+        import dictionary_parser
+        from dictionary_parser.log_database import LogDatabase
+    except ImportError as e:
+        raise RuntimeError(f"Zephyr dictionary log parser not found: {e}")
+
+    database = LogDatabase.read_json_database(db_file)
+    if database is None:
+        raise RuntimeError(f"Cannot read log database '{db_file}'")
+
+    parser = dictionary_parser.get_parser(database)
+    if parser is None:
+        raise RuntimeError("Log database version not supported by this Zephyr tree")
+
+    return parser
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Expand dictionary log CDRs uploaded to Memfault')
+    parser.add_argument('blob', help='CDR blob downloaded from Memfault')
+    parser.add_argument('db', help='log_dictionary.json of the firmware build')
+    parser.add_argument('-z', '--zephyr-base', default=os.environ.get('ZEPHYR_BASE'),
+                        help='Zephyr tree providing the parser (default: $ZEPHYR_BASE)')
+    parser.add_argument('-d', '--debug', action='store_true', help='Enable debug output')
+
+    args = parser.parse_args()
+
+    # Configure logging
+    if args.debug:
+        logging.basicConfig(level=logging.DEBUG, format='%(levelname)s: %(message)s')
+    else:
+        logging.basicConfig(level=logging.WARNING, format='%(levelname)s: %(message)s')
+
+    if not args.zephyr_base:
+        print("Error: set ZEPHYR_BASE or pass --zephyr-base")
+        sys.exit(1)
+
+    try:
+        with open(args.blob, 'rb') as f:
+            dropped, limited, uptime_ms, records = split_blob(f.read())
+    except (OSError, ValueError) as e:
+        print(f"Error: cannot read '{args.blob}': {e}")
+        sys.exit(1)
+
+    messages = [r for r in records if isinstance(r, bytes)]
+    print(f"Collected at uptime {uptime_ms} ms, {len(messages)} record(s), "
+          f"{dropped} dropped and {limited} rate limited before collection")
+    logging.debug(f"Record sizes: {[len(r) for r in messages]}")
+
+    try:
+        log_parser = load_parser(args.zephyr_base, args.db)
+    except RuntimeError as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    # Message by message, so repeat counts and marks print in place
+    for record in records:
+        if record is BOOT:
+            print("--- boot ---")
+        elif isinstance(record, TimeMark):
+            logging.debug(f"uptime {int(record)} ms")
+        elif isinstance(record, Repeat):
+            print(f"    (previous message repeated {int(record)} times)")
+        else:
+            log_parser.parse_log_data(record, debug=args.debug)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026, Nordic Semiconductor ASA
+# SPDX-License-Identifier: Apache-2.0
+"""
+Decode CBOR telemetry batches published by the mqtt_batch module
+
+A batch is one CBOR array: the uptime in milliseconds when the batch was
+started, followed by records of the form [offset ms, name, value].
+"""
+
+import sys
+import os
+import argparse
+import logging
+import struct
+
+BREAK = object()
+
+
+class CborDecoder:
+    """Minimal CBOR decoder covering the subset used by the firmware"""
+
+    def __init__(self, data: bytes):
+        self.data = data
+        self.pos = 0
+
+    def read(self, n: int) -> bytes:
+        if self.pos + n > len(self.data):
+            raise ValueError(f"Truncated input at offset {self.pos}")
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def read_arg(self, info: int):
+        if info < 24:
+            return info
+        if info == 24:
+            return self.read(1)[0]
+        if info == 25:
+            return struct.unpack('>H', self.read(2))[0]
+        if info == 26:
+            return struct.unpack('>I', self.read(4))[0]
+        if info == 27:
+            return struct.unpack('>Q', self.read(8))[0]
+        if info == 31:
+            return None
+        raise ValueError(f"Reserved additional info {info} at offset {self.pos - 1}")
+
+    def decode(self):
+        start = self.pos
+        initial = self.read(1)[0]
+        major = initial >> 5
+        info = initial & 0x1f
+
+        if initial == 0xff:
+            return BREAK
+
+        if major == 7:
+            if info == 20:
+                return False
+            if info == 21:
+                return True
+            if info in (22, 23):
+                return None
+            if info == 25:
+                return self.decode_half(self.read(2))
+            if info == 26:
+                return struct.unpack('>f', self.read(4))[0]
+            if info == 27:
+                return struct.unpack('>d', self.read(8))[0]
+            raise ValueError(f"Unsupported simple value {info} at offset {start}")
+
+        arg = self.read_arg(info)
+        logging.debug(f"offset {start}: major {major}, argument {arg}")
+
+        if major == 0:
+            return arg
+        if major == 1:
+            return -1 - arg
+        if major in (2, 3):
+            if arg is None:
+                chunks = []
+                while True:
+                    item = self.decode()
+                    if item is BREAK:
+                        break
+                    chunks.append(item)
+                value = b''.join(chunks) if major == 2 else ''.join(chunks)
+            else:
+                value = self.read(arg)
+                if major == 3:
+                    value = value.decode('utf-8')
+            return value
+        if major == 4:
+            items = []
+            while arg is None or len(items) < arg:
+                item = self.decode()
+                if item is BREAK:
+                    if arg is not None:
+                        raise ValueError(f"Unexpected break at offset {self.pos - 1}")
+                    break
+                items.append(item)
+            return items
+        if major == 5:
+            items = {}
+            while arg is None or len(items) < arg:
+                key = self.decode()
+                if key is BREAK:
+                    break
+                items[key] = self.decode()
+            return items
+        if major == 6:
+            # Tags carry no meaning for the batches, return the tagged item
+            return self.decode()
+
+        raise ValueError(f"Unsupported major type {major} at offset {start}")
+
+    @staticmethod
+    def decode_half(raw: bytes) -> float:
+        half = struct.unpack('>H', raw)[0]
+        exp = (half >> 10) & 0x1f
+        mant = half & 0x3ff
+        if exp == 0:
+            val = mant * 2 ** -24
+        elif exp == 31:
+            val = float('inf') if mant == 0 else float('nan')
+        else:
+            val = (mant + 1024) * 2 ** (exp - 25)
+        return -val if half & 0x8000 else val
+
+
+def format_value(value) -> str:
+    if isinstance(value, bytes):
+        return value.hex()
+    return str(value)
+
+
+def print_batch(batch) -> int:
+    """Print the records of one batch, return the number of records"""
+    if not isinstance(batch, list) or not batch or not isinstance(batch[0], int):
+        print(f"Not a telemetry batch: {batch!r}")
+        return 0
+
+    base_ms = batch[0]
+    records = batch[1:]
+    print(f"Batch started at uptime {base_ms} ms, {len(records)} record(s)")
+
+    for record in records:
+        if not isinstance(record, list) or len(record) != 3:
+            print(f"  Malformed record: {record!r}")
+            continue
+        offset_ms, name, value = record
+        print(f"  {base_ms + offset_ms:>12} ms  {name:<24} {format_value(value)}")
+
+    return len(records)
+
+
+def read_input(source: str) -> bytes:
+    if source == '-':
+        raw = sys.stdin.buffer.read()
+        try:
+            return bytes.fromhex(raw.decode('ascii').replace(' ', '').replace('\n', ''))
+        except (UnicodeDecodeError, ValueError):
+            return raw
+
+    if os.path.isfile(source):
+        with open(source, 'rb') as f:
+            data = f.read()
+        logging.debug(f"Read {len(data)} bytes from file '{source}'")
+        return data
+
+    # Assume it's a hex string
+    clean_hex = source.replace(' ', '').replace('0x', '').replace('\n', '')
+    data = bytes.fromhex(clean_hex)
+    logging.debug(f"Parsed {len(data)} bytes from hex string")
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode CBOR telemetry batches published over MQTT')
+    parser.add_argument('payload', help="Hex string, path to a binary file, or '-' for stdin")
+    parser.add_argument('-d', '--debug', action='store_true', help='Enable debug output')
+
+    args = parser.parse_args()
+
+    # Configure logging
+    if args.debug:
+        logging.basicConfig(level=logging.DEBUG, format='%(levelname)s: %(message)s')
+    else:
+        logging.basicConfig(level=logging.WARNING, format='%(levelname)s: %(message)s')
+
+    try:
+        data = read_input(args.payload)
+    except (OSError, ValueError) as e:
+        print(f"Error: cannot read '{args.payload}': {e}")
+        sys.exit(1)
+
+    # A capture may hold several batches back to back
+    decoder = CborDecoder(data)
+    total = 0
+    try:
+        while decoder.pos < len(data):
+            total += print_batch(decoder.decode())
+    except ValueError as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    logging.debug(f"Decoded {total} record(s)")
+
+
+if __name__ == "__main__":
+    main()
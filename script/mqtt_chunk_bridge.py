@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026, Nordic Semiconductor ASA
+# SPDX-License-Identifier: Apache-2.0
+"""
+Forward Memfault chunks published over MQTT to the Memfault chunks API
+
+Stand-in for a cloud side bridge when the firmware is built with
+CONFIG_MFLT_MQTT_CHUNKS. Subscribes to Memfault/<device serial>/chunks and
+posts every chunk, in arrival order, to
+<chunks URL>/api/v0/chunks/<device serial>.
+
+Requires paho-mqtt (pip install paho-mqtt).
+"""
+
+import sys
+import time
+import argparse
+import logging
+import urllib.error
+import urllib.request
+
+try:
+    import paho.mqtt.client as mqtt
+except ImportError:
+    print("Error: paho-mqtt is required, install it with 'pip install paho-mqtt'")
+    sys.exit(1)
+
+TOPIC_FILTER = 'Memfault/{serial}/chunks'
+POST_ATTEMPTS = 5
+
+
+class ChunkBridge:
+    def __init__(self, project_key: str, chunks_url: str, dry_run: bool = False):
+        self.project_key = project_key
+        self.chunks_url = chunks_url.rstrip('/')
+        self.dry_run = dry_run
+        self.forwarded = 0
+        self.failed = 0
+
+    def post_chunk(self, serial: str, chunk: bytes) -> bool:
+        """Post one chunk, retrying with backoff on server and network errors"""
+        url = f"{self.chunks_url}/api/v0/chunks/{serial}"
+        request = urllib.request.Request(url, data=chunk, method='POST', headers={
+            'Memfault-Project-Key': self.project_key,
+            'Content-Type': 'application/octet-stream',
+        })
+
+        for attempt in range(POST_ATTEMPTS):
+            try:
+                with urllib.request.urlopen(request, timeout=10) as response:
+                    logging.debug(f"{serial}: HTTP {response.status}")
+                    return True
+            except urllib.error.HTTPError as e:
+                if e.code < 500 and e.code != 429:
+                    logging.error(f"{serial}: chunk rejected, HTTP {e.code}")
+                    return False
+                logging.warning(f"{serial}: HTTP {e.code}, attempt {attempt + 1}")
+            except urllib.error.URLError as e:
+                logging.warning(f"{serial}: {e.reason}, attempt {attempt + 1}")
+            time.sleep(2 ** attempt)
+
+        return False
+
+    def on_message(self, client, userdata, message):
+        parts = message.topic.split('/')
+        if len(parts) != 3:
+            logging.warning(f"Ignoring message on unexpected topic {message.topic}")
+            return
+
+        serial = parts[1]
+        chunk = bytes(message.payload)
+        print(f"{serial}: {len(chunk)} byte chunk")
+
+        if self.dry_run:
+            return
+
+        # Posted from the network thread so chunks stay in order per device
+        if self.post_chunk(serial, chunk):
+            self.forwarded += 1
+        else:
+            self.failed += 1
+            print(f"{serial}: failed to forward chunk")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Forward Memfault chunks from MQTT to the Memfault chunks API')
+    parser.add_argument('-k', '--project-key', help='Memfault project key')
+    parser.add_argument('-b', '--broker', default='test.mosquitto.org', help='MQTT broker hostname')
+    parser.add_argument('-p', '--port', type=int, default=1883, help='MQTT broker port')
+    parser.add_argument('-s', '--serial', default='+', help="Device serial to bridge, '+' for all")
+    parser.add_argument('--chunks-url', default='https://chunks.memfault.com', help='Memfault chunks endpoint')
+    parser.add_argument('-n', '--dry-run', action='store_true', help='Print received chunks without forwarding')
+    parser.add_argument('-d', '--debug', action='store_true', help='Enable debug output')
+
+    args = parser.parse_args()
+
+    # Configure logging
+    if args.debug:
+        logging.basicConfig(level=logging.DEBUG, format='%(levelname)s: %(message)s')
+    else:
+        logging.basicConfig(level=logging.WARNING, format='%(levelname)s: %(message)s')
+
+    if not args.project_key and not args.dry_run:
+        print("Error: --project-key is required unless --dry-run is given")
+        sys.exit(1)
+
+    bridge = ChunkBridge(args.project_key, args.chunks_url, args.dry_run)
+    topic = TOPIC_FILTER.format(serial=args.serial)
+
+    # paho-mqtt 2.x needs the callback API version, 1.x does not know it
+    try:
+        client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION1)
+    except AttributeError:
+        client = mqtt.Client()
+    client.on_message = bridge.on_message
+    client.on_connect = lambda c, userdata, flags, rc: c.subscribe(topic, qos=1)
+
+    client.connect(args.broker, args.port)
+    print(f"Bridging {topic} on {args.broker}:{args.port}")
+
+    try:
+        client.loop_forever()
+    except KeyboardInterrupt:
+        pass
+
+    print(f"Forwarded {bridge.forwarded} chunk(s), {bridge.failed} failed")
+
+
+if __name__ == "__main__":
+    main()
@@ -29,7 +29,8 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(ble_prov, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
 
-#define WIFI_RECONNECT_DELAY_SEC 5
+#include "net_events.h"
+#include "wifi_conn.h"
 
 #ifdef CONFIG_WIFI_PROV_ADV_DATA_UPDATE
 #define ADV_DATA_UPDATE_INTERVAL CONFIG_WIFI_PROV_ADV_DATA_UPDATE_INTERVAL
@@ -53,17 +54,9 @@ LOG_MODULE_REGISTER(ble_prov, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
 #define ADV_DAEMON_STACK_SIZE 4096
 #define ADV_DAEMON_PRIORITY   5
 
-/* Work item for triggering WiFi connection after provisioning */
-static struct k_work_delayable wifi_connect_work;
-static bool wifi_connect_requested = false;
-
 /* Track BLE connection state to avoid updating advertising while connected */
 static struct bt_conn *current_conn = NULL;
 
-static bool wifi_reconnect_pending = false;
-
-static struct net_mgmt_event_callback wifi_mgmt_cb;
-
 /* Flag to track if we've already requested connection after provisioning */
 static bool connection_requested_after_provisioning = false;
 
@@ -94,67 +87,6 @@ static const struct bt_data sd[] = {
 static struct k_work_delayable update_adv_param_work;
 static struct k_work_delayable update_adv_data_work;
 
-static void wifi_mgmt_event_handler(struct net_mgmt_event_callback *cb, uint64_t mgmt_event,
-				    struct net_if *iface)
-{
-	ARG_UNUSED(iface);
-
-	if (!wifi_prov_state_get()) {
-		return;
-	}
-
-	switch (mgmt_event) {
-	case NET_EVENT_WIFI_DISCONNECT_RESULT:
-		/* Skip reconnect if BLE client is connected (provisioning in progress) */
-		if (current_conn != NULL) {
-			LOG_INF("BLE client connected, skipping WiFi auto-reconnect");
-			break;
-		}
-		/* Schedule reconnect only if not already pending */
-		if (!wifi_reconnect_pending) {
-			wifi_reconnect_pending = true;
-			k_work_reschedule(&wifi_connect_work, K_SECONDS(WIFI_RECONNECT_DELAY_SEC));
-			LOG_INF("WiFi disconnected, scheduling reconnect");
-		}
-		break;
-	case NET_EVENT_WIFI_CONNECT_RESULT:
-		/* Reset reconnect flag on connection result */
-		wifi_reconnect_pending = false;
-		break;
-	default:
-		break;
-	}
-}
-
-static void wifi_connect_work_handler(struct k_work *work)
-{
-	int err;
-	struct net_if *iface = net_if_get_default();
-
-	/* Skip reconnect if BLE client is connected (provisioning in progress) */
-	if (current_conn != NULL) {
-		LOG_INF("BLE client connected, skipping WiFi reconnect attempt");
-		wifi_reconnect_pending = false;
-		return;
-	}
-
-	/* Check if credentials are now available (they were just provisioned) */
-	if (!wifi_credentials_is_empty()) {
-		LOG_INF("WiFi credentials detected, attempting to connect");
-		err = net_mgmt(NET_REQUEST_WIFI_CONNECT_STORED, iface, NULL, 0);
-		if (err) {
-			LOG_ERR("WiFi connection request failed: %d", err);
-			/* Reset flag to allow retry */
-			wifi_connect_requested = false;
-			wifi_reconnect_pending = false;
-			connection_requested_after_provisioning = false;
-		} else {
-			LOG_INF("WiFi connection request sent successfully");
-			wifi_reconnect_pending = false;
-		}
-	}
-}
-
 static void update_wifi_status_in_adv(void)
 {
 	int rc;
@@ -195,7 +127,7 @@ static void update_wifi_status_in_adv(void)
 
 			if (!wifi_is_connected) {
 				connection_requested_after_provisioning = true;
-				k_work_reschedule(&wifi_connect_work, K_SECONDS(2));
+				wifi_conn_credentials_changed();
 				LOG_INF("WiFi credentials provisioned, scheduling connection "
 					"attempt");
 			}
@@ -230,6 +162,9 @@ static void connected(struct bt_conn *conn, uint8_t err)
 	/* Store connection reference and stop advertising updates */
 	current_conn = bt_conn_ref(conn);
 	k_work_cancel_delayable(&update_adv_data_work);
+
+	/* Keep the radio free for the provisioning client */
+	wifi_conn_pause(true);
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -245,6 +180,8 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
+	wifi_conn_pause(false);
+
 	k_work_reschedule_for_queue(&adv_daemon_work_q, &update_adv_param_work,
 				    K_SECONDS(ADV_PARAM_UPDATE_DELAY));
 	/* Delay ad data update until after advertising restarts to avoid EAGAIN (-11) */
@@ -386,6 +323,16 @@ static void update_dev_name(struct net_linkaddr *mac_addr)
 	byte_to_hex(&device_name[6], mac_addr->addr[5], 'A');
 }
 
+/* Update advertisement data with current WiFi status */
+static void on_network_change(bool up)
+{
+	ARG_UNUSED(up);
+
+	k_work_reschedule_for_queue(&adv_daemon_work_q, &update_adv_data_work, K_NO_WAIT);
+}
+
+NET_EVENTS_SUB_DEFINE(ble_prov_sub, on_network_change);
+
 int ble_prov_init(void)
 {
 	int rc;
@@ -442,17 +389,10 @@ int ble_prov_init(void)
 
 	update_wifi_status_in_adv();
 
-	/* Register WiFi management event handler for reconnect logic */
-	net_mgmt_init_event_callback(&wifi_mgmt_cb, wifi_mgmt_event_handler,
-				     NET_EVENT_WIFI_DISCONNECT_RESULT |
-					     NET_EVENT_WIFI_CONNECT_RESULT);
-	net_mgmt_add_event_callback(&wifi_mgmt_cb);
-
 	k_work_queue_init(&adv_daemon_work_q);
 	k_work_queue_start(&adv_daemon_work_q, adv_daemon_stack_area,
 			   K_THREAD_STACK_SIZEOF(adv_daemon_stack_area), ADV_DAEMON_PRIORITY, NULL);
 
-	k_work_init_delayable(&wifi_connect_work, wifi_connect_work_handler);
 	k_work_init_delayable(&update_adv_param_work, update_adv_param_task);
 	k_work_init_delayable(&update_adv_data_work, update_adv_data_task);
 #ifdef CONFIG_WIFI_PROV_ADV_DATA_UPDATE
@@ -460,17 +400,7 @@ int ble_prov_init(void)
 				  K_SECONDS(ADV_DATA_UPDATE_INTERVAL));
 #endif /* CONFIG_WIFI_PROV_ADV_DATA_UPDATE */
 
-	return 0;
-}
-
-void ble_prov_update_wifi_status(bool connected)
-{
-	/* Reset connection request flag when WiFi connects */
-	if (connected) {
-		wifi_connect_requested = false;
-		wifi_reconnect_pending = false;
-	}
+	net_events_subscribe(&ble_prov_sub);
 
-	/* Update advertisement data with current WiFi status */
-	k_work_reschedule_for_queue(&adv_daemon_work_q, &update_adv_data_work, K_NO_WAIT);
+	return 0;
 }
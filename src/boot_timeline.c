@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Boot timeline. Startup milestones are stamped with the uptime they were
+ * first reached at and published as metrics in the next heartbeat, so the
+ * time from power-on to the first upload can be followed per phase across
+ * the fleet.
+ */
+
+#include "boot_timeline.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <memfault/metrics/metrics.h>
+
+LOG_MODULE_REGISTER(boot_timeline, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+static const char *const phase_names[] = {
+	[BOOT_PHASE_MAIN] = "main",
+	[BOOT_PHASE_WIFI_READY] = "wifi ready",
+	[BOOT_PHASE_BLE_READY] = "ble ready",
+	[BOOT_PHASE_WIFI_CONNECTED] = "wifi connected",
+	[BOOT_PHASE_NET_CONNECTED] = "net connected",
+	[BOOT_PHASE_FIRST_UPLOAD] = "first upload",
+};
+
+static struct k_spinlock lock;
+/* 0 until reached, uptime is at least 1 ms by the time main() runs */
+static uint32_t reached_ms[BOOT_PHASE_COUNT];
+static uint32_t published;
+
+void boot_timeline_mark(enum boot_phase phase)
+{
+	uint32_t now = k_uptime_get_32();
+	k_spinlock_key_t key;
+
+	if (phase >= BOOT_PHASE_COUNT) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	if (reached_ms[phase] != 0) {
+		k_spin_unlock(&lock, key);
+		return;
+	}
+	reached_ms[phase] = MAX(now, 1);
+	k_spin_unlock(&lock, key);
+
+	LOG_INF("Boot phase %s at %u ms", phase_names[phase], now);
+
+	if (phase == BOOT_PHASE_FIRST_UPLOAD) {
+		LOG_INF("Boot timeline - wifi ready: %u, ble ready: %u, wifi connected: %u, "
+			"net connected: %u, first upload: %u ms",
+			reached_ms[BOOT_PHASE_WIFI_READY], reached_ms[BOOT_PHASE_BLE_READY],
+			reached_ms[BOOT_PHASE_WIFI_CONNECTED], reached_ms[BOOT_PHASE_NET_CONNECTED],
+			now);
+	}
+}
+
+static void phase_publish(enum boot_phase phase, uint32_t ms)
+{
+	switch (phase) {
+	case BOOT_PHASE_MAIN:
+		MEMFAULT_METRIC_SET_UNSIGNED(boot_main_ms, ms);
+		break;
+	case BOOT_PHASE_WIFI_READY:
+		MEMFAULT_METRIC_SET_UNSIGNED(boot_wifi_ready_ms, ms);
+		break;
+	case BOOT_PHASE_BLE_READY:
+		MEMFAULT_METRIC_SET_UNSIGNED(boot_ble_ready_ms, ms);
+		break;
+	case BOOT_PHASE_WIFI_CONNECTED:
+		MEMFAULT_METRIC_SET_UNSIGNED(boot_wifi_connected_ms, ms);
+		break;
+	case BOOT_PHASE_NET_CONNECTED:
+		MEMFAULT_METRIC_SET_UNSIGNED(boot_net_connected_ms, ms);
+		break;
+	case BOOT_PHASE_FIRST_UPLOAD:
+		MEMFAULT_METRIC_SET_UNSIGNED(boot_first_upload_ms, ms);
+		break;
+	default:
+		break;
+	}
+}
+
+void boot_timeline_collect(void)
+{
+	uint32_t snapshot[BOOT_PHASE_COUNT];
+	uint32_t fresh = 0;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+		snapshot[i] = reached_ms[i];
+		if (snapshot[i] != 0 && !(published & BIT(i))) {
+			fresh |= BIT(i);
+		}
+	}
+	published |= fresh;
+	k_spin_unlock(&lock, key);
+
+	/* Phases not reached or already reported stay unset */
+	for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+		if (fresh & BIT(i)) {
+			phase_publish(i, snapshot[i]);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Startup milestones, in the order they are usually reached. */
+enum boot_phase {
+	/* main() entered */
+	BOOT_PHASE_MAIN,
+	/* Wi-Fi supplicant ready for connect requests */
+	BOOT_PHASE_WIFI_READY,
+	/* Bluetooth enabled and provisioning advertising */
+	BOOT_PHASE_BLE_READY,
+	/* Associated with the AP */
+	BOOT_PHASE_WIFI_CONNECTED,
+	/* L4 connectivity, IP address assigned */
+	BOOT_PHASE_NET_CONNECTED,
+	/* First Memfault upload session that sent data without errors */
+	BOOT_PHASE_FIRST_UPLOAD,
+	BOOT_PHASE_COUNT,
+};
+
+/**
+ * @brief Record the uptime a phase was reached.
+ *
+ * Only the first call per phase and boot is kept, so later reconnects and
+ * uploads can call it unconditionally. Callable from any thread.
+ */
+void boot_timeline_mark(enum boot_phase phase);
+
+/**
+ * @brief Publish the phases reached since the last heartbeat.
+ *
+ * Each phase is published once per boot. Called from
+ * memfault_metrics_heartbeat_collect_data().
+ */
+void boot_timeline_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Diagnostic action executor. Buttons, the shell and MQTT commands only
+ * queue actions, which run one at a time on a dedicated workqueue. Collecting
+ * the nRF70 firmware statistics waits for the RPU lock, so running it in the
+ * button callback stalled the system workqueue.
+ *
+ * Each action has one work item: a request for an action that is already
+ * queued is merged into it, and every source that asked for it gets the
+ * completion report.
+ */
+
+#include "diag_exec.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <memfault/metrics/metrics.h>
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif
+
+#include "mflt_ota_triggers.h"
+#include "mflt_upload_sched.h"
+#include "net_events.h"
+
+#ifdef CONFIG_NRF70_FW_STATS_CDR_ENABLED
+#include "mflt_nrf70_fw_stats_cdr.h"
+#endif
+
+LOG_MODULE_REGISTER(diag_exec, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define DIAG_EXEC_PRIORITY K_PRIO_PREEMPT(7)
+
+static const char *const action_names[] = {
+	[DIAG_ACTION_HEARTBEAT] = "heartbeat",
+	[DIAG_ACTION_FW_STATS] = "fw_stats",
+	[DIAG_ACTION_UPLOAD] = "upload",
+	[DIAG_ACTION_OTA_CHECK] = "ota_check",
+};
+
+BUILD_ASSERT(ARRAY_SIZE(action_names) == DIAG_ACTION_COUNT);
+
+static const char *const source_names[] = {
+	[DIAG_SOURCE_BUTTON] = "button",
+	[DIAG_SOURCE_SHELL] = "shell",
+	[DIAG_SOURCE_REMOTE] = "remote",
+};
+
+BUILD_ASSERT(ARRAY_SIZE(source_names) == DIAG_SOURCE_COUNT);
+
+struct diag_slot {
+	struct k_work work;
+	/* Sources waiting for the queued run, 0 while not queued */
+	uint32_t sources;
+	int64_t queued_at;
+};
+
+K_THREAD_STACK_DEFINE(diag_exec_stack, CONFIG_DIAG_EXEC_STACK_SIZE);
+static struct k_work_q diag_exec_wq;
+
+static struct k_spinlock lock;
+static struct diag_slot slots[DIAG_ACTION_COUNT];
+static diag_exec_report_t reporters[DIAG_SOURCE_COUNT];
+
+/* Totals and worst cases of the current heartbeat interval */
+static uint32_t runs;
+static uint32_t merged;
+static uint32_t failures;
+static uint32_t max_latency_ms;
+static uint32_t max_run_ms;
+
+static int heartbeat_run(void)
+{
+	memfault_metrics_heartbeat_debug_trigger();
+	return 0;
+}
+
+static int fw_stats_run(void)
+{
+#ifdef CONFIG_NRF70_FW_STATS_CDR_ENABLED
+	int err = mflt_nrf70_fw_stats_cdr_collect();
+
+	if (err) {
+		return err;
+	}
+
+	LOG_INF("nRF70 FW stats CDR collected (%zu bytes)", mflt_nrf70_fw_stats_cdr_get_size());
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int upload_run(uint32_t sources)
+{
+	if (!net_events_connected()) {
+		return -ENOTCONN;
+	}
+
+	mflt_upload_sched_request((sources & BIT(DIAG_SOURCE_BUTTON)) ? MFLT_UPLOAD_TRIGGER_BUTTON
+								       : MFLT_UPLOAD_TRIGGER_COMMAND,
+				  true);
+	return 0;
+}
+
+static int ota_check_run(void)
+{
+	mflt_ota_triggers_notify_button();
+	return 0;
+}
+
+static void slot_work_fn(struct k_work *work)
+{
+	struct diag_slot *slot = CONTAINER_OF(work, struct diag_slot, work);
+	enum diag_action action = slot - slots;
+	k_spinlock_key_t key;
+	uint32_t sources;
+	uint32_t latency_ms;
+	uint32_t run_ms;
+	int64_t start;
+	int result;
+
+	/* Requests from here on queue another run */
+	key = k_spin_lock(&lock);
+	sources = slot->sources;
+	start = k_uptime_get();
+	latency_ms = (uint32_t)(start - slot->queued_at);
+	slot->sources = 0;
+	k_spin_unlock(&lock, key);
+
+	switch (action) {
+	case DIAG_ACTION_HEARTBEAT:
+		result = heartbeat_run();
+		break;
+	case DIAG_ACTION_FW_STATS:
+		result = fw_stats_run();
+		break;
+	case DIAG_ACTION_UPLOAD:
+		result = upload_run(sources);
+		break;
+	case DIAG_ACTION_OTA_CHECK:
+		result = ota_check_run();
+		break;
+	default:
+		result = -EINVAL;
+		break;
+	}
+
+	run_ms = (uint32_t)(k_uptime_get() - start);
+
+	if (result) {
+		LOG_WRN("Action %s failed after %u ms: %d", action_names[action], run_ms, result);
+	} else {
+		LOG_INF("Action %s done in %u ms, queued %u ms", action_names[action], run_ms,
+			latency_ms);
+	}
+
+	key = k_spin_lock(&lock);
+	runs++;
+	failures += result ? 1 : 0;
+	max_latency_ms = MAX(max_latency_ms, latency_ms);
+	max_run_ms = MAX(max_run_ms, run_ms);
+	k_spin_unlock(&lock, key);
+
+	for (int i = 0; i < DIAG_SOURCE_COUNT; i++) {
+		if ((sources & BIT(i)) && reporters[i]) {
+			reporters[i](action, result);
+		}
+	}
+}
+
+void diag_exec_init(void)
+{
+	struct k_work_queue_config cfg = {
+		.name = "diag_exec",
+	};
+
+	for (int i = 0; i < DIAG_ACTION_COUNT; i++) {
+		k_work_init(&slots[i].work, slot_work_fn);
+	}
+
+	k_work_queue_start(&diag_exec_wq, diag_exec_stack, K_THREAD_STACK_SIZEOF(diag_exec_stack),
+			   DIAG_EXEC_PRIORITY, &cfg);
+}
+
+int diag_exec_submit(enum diag_action action, enum diag_source source)
+{
+	struct diag_slot *slot;
+	k_spinlock_key_t key;
+	bool pending;
+	int err;
+
+	if (action >= DIAG_ACTION_COUNT || source >= DIAG_SOURCE_COUNT) {
+		return -EINVAL;
+	}
+
+	slot = &slots[action];
+
+	key = k_spin_lock(&lock);
+	pending = slot->sources != 0;
+	if (!pending) {
+		err = k_work_submit_to_queue(&diag_exec_wq, &slot->work);
+		if (err < 0) {
+			k_spin_unlock(&lock, key);
+			LOG_ERR("Action %s not queued: %d", action_names[action], err);
+			return err;
+		}
+		slot->queued_at = k_uptime_get();
+	} else {
+		merged++;
+	}
+	slot->sources |= BIT(source);
+	k_spin_unlock(&lock, key);
+
+	LOG_DBG("Action %s from %s %s", action_names[action], source_names[source],
+		pending ? "merged" : "queued");
+
+	return pending ? -EALREADY : 0;
+}
+
+void diag_exec_reporter_set(enum diag_source source, diag_exec_report_t report)
+{
+	if (source < DIAG_SOURCE_COUNT) {
+		reporters[source] = report;
+	}
+}
+
+int diag_exec_action_parse(const char *name, size_t len)
+{
+	for (int i = 0; i < DIAG_ACTION_COUNT; i++) {
+		if (strlen(action_names[i]) == len && memcmp(action_names[i], name, len) == 0) {
+			return i;
+		}
+	}
+
+	return -EINVAL;
+}
+
+const char *diag_exec_action_name(enum diag_action action)
+{
+	return action < DIAG_ACTION_COUNT ? action_names[action] : "unknown";
+}
+
+void diag_exec_collect(void)
+{
+	uint32_t count, merged_count, fail_count, latency_ms, run_ms;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	count = runs;
+	merged_count = merged;
+	fail_count = failures;
+	latency_ms = max_latency_ms;
+	run_ms = max_run_ms;
+	runs = 0;
+	merged = 0;
+	failures = 0;
+	max_latency_ms = 0;
+	max_run_ms = 0;
+	k_spin_unlock(&lock, key);
+
+	MEMFAULT_METRIC_SET_UNSIGNED(diag_exec_count, count);
+	MEMFAULT_METRIC_SET_UNSIGNED(diag_exec_merged_count, merged_count);
+	MEMFAULT_METRIC_SET_UNSIGNED(diag_exec_fail_count, fail_count);
+
+	/* Leave timing metrics unset for intervals without a run */
+	if (count > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(diag_exec_max_latency_ms, latency_ms);
+		MEMFAULT_METRIC_SET_UNSIGNED(diag_exec_max_run_ms, run_ms);
+	}
+}
+
+#ifdef CONFIG_SHELL
+static int cmd_diag(const struct shell *sh, size_t argc, char **argv)
+{
+	int action = diag_exec_action_parse(argv[1], strlen(argv[1]));
+	int err;
+
+	if (action < 0) {
+		shell_error(sh, "Unknown action %s", argv[1]);
+		return -EINVAL;
+	}
+
+	err = diag_exec_submit(action, DIAG_SOURCE_SHELL);
+	if (err && err != -EALREADY) {
+		shell_error(sh, "%s not queued: %d", action_names[action], err);
+		return err;
+	}
+
+	shell_print(sh, "%s %s", action_names[action], err ? "already queued" : "queued");
+	return 0;
+}
+
+SHELL_CMD_ARG_REGISTER(diag, NULL, "Queue a diagnostic action: heartbeat, fw_stats, upload, "
+				   "ota_check",
+		       cmd_diag, 2, 0);
+#endif
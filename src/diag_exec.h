@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** User-triggered diagnostic actions. */
+enum diag_action {
+	/* Close the heartbeat interval and capture the metrics */
+	DIAG_ACTION_HEARTBEAT,
+	/* Capture the nRF70 firmware statistics as a CDR */
+	DIAG_ACTION_FW_STATS,
+	/* Upload the captured Memfault data */
+	DIAG_ACTION_UPLOAD,
+	/* Check for a Memfault OTA update */
+	DIAG_ACTION_OTA_CHECK,
+	DIAG_ACTION_COUNT,
+};
+
+/** Where an action was requested from. */
+enum diag_source {
+	DIAG_SOURCE_BUTTON,
+	DIAG_SOURCE_SHELL,
+	DIAG_SOURCE_REMOTE,
+	DIAG_SOURCE_COUNT,
+};
+
+/**
+ * @brief Completion report of an action
+ *
+ * Runs on the executor workqueue, once per completed run for every source
+ * that requested it.
+ *
+ * @param action Completed action
+ * @param result 0 on success, negative error code on failure
+ */
+typedef void (*diag_exec_report_t)(enum diag_action action, int result);
+
+/**
+ * @brief Start the executor workqueue.
+ */
+void diag_exec_init(void);
+
+/**
+ * @brief Queue an action.
+ *
+ * Returns at once, the action runs on the executor workqueue. A request for
+ * an action that is already queued is merged into it.
+ *
+ * @return 0 if queued, -EALREADY if merged into a queued request,
+ *         -EINVAL for an unknown action or source, other negative error
+ *         codes if the executor is not started
+ */
+int diag_exec_submit(enum diag_action action, enum diag_source source);
+
+/**
+ * @brief Set the completion report of a source, NULL for none.
+ */
+void diag_exec_reporter_set(enum diag_source source, diag_exec_report_t report);
+
+/**
+ * @brief Look up an action by name, e.g. from a shell or MQTT command.
+ *
+ * @param name Action name, need not be null-terminated.
+ * @param len Length of @p name.
+ * @return The action, or -EINVAL if there is none by that name
+ */
+int diag_exec_action_parse(const char *name, size_t len);
+
+/**
+ * @brief Get the name of an action.
+ */
+const char *diag_exec_action_name(enum diag_action action);
+
+/**
+ * @brief Publish queue latency and run time of the elapsed interval.
+ *
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void diag_exec_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,657 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * On-flash layout, per erase sector:
+ *
+ *   [sector header: magic, seq][record][record]...[erased]
+ *
+ * and per record:
+ *
+ *   [status u32][len u16][reserved u16][crc32 u32][data, padded to 4 bytes]
+ *
+ * The status word moves from erased (0xFFFFFFFF) to committed (0xFFFF0000) to
+ * consumed (0x00000000) by programming bits to zero only, so a record never
+ * needs an erase before its sector is reused. Header and data are written
+ * first, then the CRC, which is computed while the data streams in, and the
+ * status last, which makes the commit atomic.
+ */
+
+#include "flash_ring.h"
+
+#include <string.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(flash_ring, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define SECTOR_MAGIC 0x46524e47 /* "FRNG" */
+
+#define REC_STATUS_ERASED    0xFFFFFFFFU
+#define REC_STATUS_COMMITTED 0xFFFF0000U
+#define REC_STATUS_CONSUMED  0x00000000U
+
+#define REC_LEN_ERASED 0xFFFF
+#define REC_CRC_ERASED 0xFFFFFFFFU
+#define REC_ALIGN      4
+
+/* Records are streamed to and from flash in pieces of this size */
+#define PIECE_LEN 64
+
+struct sector_hdr {
+	uint32_t magic;
+	uint32_t seq;
+};
+
+struct rec_hdr {
+	uint32_t status;
+	uint16_t len;
+	uint16_t reserved;
+	uint32_t crc;
+};
+
+BUILD_ASSERT(sizeof(struct sector_hdr) % REC_ALIGN == 0);
+BUILD_ASSERT(sizeof(struct rec_hdr) % REC_ALIGN == 0);
+BUILD_ASSERT(PIECE_LEN % REC_ALIGN == 0);
+
+static inline off_t sector_base(const struct flash_ring *ring, uint16_t sector)
+{
+	return (off_t)sector * ring->sector_size;
+}
+
+static inline uint16_t sector_next(const struct flash_ring *ring, uint16_t sector)
+{
+	return (sector + 1) % ring->sector_count;
+}
+
+static inline uint32_t rec_size(uint16_t len)
+{
+	return sizeof(struct rec_hdr) + ROUND_UP(len, REC_ALIGN);
+}
+
+static int ring_write(struct flash_ring *ring, off_t off, const void *data, size_t len)
+{
+	ring->bytes_programmed += len;
+	return flash_area_write(ring->fa, off, data, len);
+}
+
+/* @return 1 if a record header was read, 0 at the end of the sector's records */
+static int rec_hdr_read(const struct flash_ring *ring, uint16_t sector, uint32_t off,
+			struct rec_hdr *hdr)
+{
+	int err;
+
+	if (off + sizeof(*hdr) > ring->sector_size) {
+		return 0;
+	}
+
+	err = flash_area_read(ring->fa, sector_base(ring, sector) + off, hdr, sizeof(*hdr));
+	if (err) {
+		return err;
+	}
+
+	if (hdr->len == REC_LEN_ERASED || off + rec_size(hdr->len) > ring->sector_size) {
+		return 0;
+	}
+
+	return 1;
+}
+
+static int rec_status_write(struct flash_ring *ring, uint16_t sector, uint32_t off,
+			    uint32_t status)
+{
+	return ring_write(ring, sector_base(ring, sector) + off, &status, sizeof(status));
+}
+
+static int sector_start(struct flash_ring *ring, uint16_t sector)
+{
+	struct sector_hdr hdr = {
+		.magic = SECTOR_MAGIC,
+		.seq = ring->write_seq + 1,
+	};
+	int err;
+
+	if (ring->head_ok_sector == sector) {
+		ring->head_ok = false;
+	}
+
+	ring->erase_count++;
+	err = flash_area_erase(ring->fa, sector_base(ring, sector), ring->sector_size);
+	if (err) {
+		LOG_ERR("Failed to erase sector %u, err %d", sector, err);
+		return err;
+	}
+
+	err = ring_write(ring, sector_base(ring, sector), &hdr, sizeof(hdr));
+	if (err) {
+		LOG_ERR("Failed to write sector %u header, err %d", sector, err);
+		return err;
+	}
+
+	ring->write_seq = hdr.seq;
+	ring->write_sector = sector;
+	ring->write_off = sizeof(hdr);
+
+	return 0;
+}
+
+static bool read_at_write_pos(const struct flash_ring *ring)
+{
+	return ring->read_sector == ring->write_sector && ring->read_off == ring->write_off;
+}
+
+/* Move the read position to the oldest committed record, or to the write position */
+static int read_normalize(struct flash_ring *ring)
+{
+	struct rec_hdr hdr;
+	int ret;
+
+	while (!read_at_write_pos(ring)) {
+		ret = rec_hdr_read(ring, ring->read_sector, ring->read_off, &hdr);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (ret == 0) {
+			if (ring->read_sector == ring->write_sector) {
+				/* Write position is past a gap, catch up with it */
+				ring->read_off = ring->write_off;
+				break;
+			}
+			ring->read_sector = sector_next(ring, ring->read_sector);
+			ring->read_off = sizeof(struct sector_hdr);
+			continue;
+		}
+
+		if (hdr.status == REC_STATUS_COMMITTED) {
+			break;
+		}
+
+		ring->read_off += rec_size(hdr.len);
+	}
+
+	return 0;
+}
+
+/* Count committed records of a sector, optionally finding the end of its records */
+static int sector_scan(const struct flash_ring *ring, uint16_t sector, uint32_t *count,
+		       uint32_t *end_off)
+{
+	uint32_t off = sizeof(struct sector_hdr);
+	struct rec_hdr hdr;
+	int ret;
+
+	*count = 0;
+
+	while ((ret = rec_hdr_read(ring, sector, off, &hdr)) == 1) {
+		if (hdr.status == REC_STATUS_COMMITTED) {
+			(*count)++;
+		}
+		off += rec_size(hdr.len);
+	}
+
+	if (end_off) {
+		*end_off = off;
+	}
+
+	return (ret < 0) ? ret : 0;
+}
+
+static int ring_recover(struct flash_ring *ring)
+{
+	struct sector_hdr hdr;
+	bool found = false;
+	uint16_t newest = 0;
+	uint16_t oldest = 0;
+	uint32_t newest_seq = 0;
+	uint32_t oldest_seq = UINT32_MAX;
+	uint32_t records;
+	int err;
+
+	for (uint16_t sector = 0; sector < ring->sector_count; sector++) {
+		err = flash_area_read(ring->fa, sector_base(ring, sector), &hdr, sizeof(hdr));
+		if (err) {
+			return err;
+		}
+
+		if (hdr.magic != SECTOR_MAGIC) {
+			continue;
+		}
+
+		found = true;
+		if (hdr.seq >= newest_seq) {
+			newest_seq = hdr.seq;
+			newest = sector;
+		}
+		if (hdr.seq < oldest_seq) {
+			oldest_seq = hdr.seq;
+			oldest = sector;
+		}
+	}
+
+	ring->count = 0;
+	ring->write_seq = newest_seq;
+
+	if (!found) {
+		LOG_INF("No records found, formatting");
+		err = sector_start(ring, 0);
+		if (err) {
+			return err;
+		}
+		ring->read_sector = ring->write_sector;
+		ring->read_off = ring->write_off;
+		return 0;
+	}
+
+	ring->write_sector = newest;
+	err = sector_scan(ring, newest, &records, &ring->write_off);
+	if (err) {
+		return err;
+	}
+
+	/* Sectors are written in index order, so oldest..newest is contiguous */
+	for (uint16_t sector = oldest;; sector = sector_next(ring, sector)) {
+		err = sector_scan(ring, sector, &records, NULL);
+		if (err) {
+			return err;
+		}
+		ring->count += records;
+
+		if (sector == newest) {
+			break;
+		}
+	}
+
+	ring->read_sector = oldest;
+	ring->read_off = sizeof(struct sector_hdr);
+
+	return read_normalize(ring);
+}
+
+int flash_ring_init(struct flash_ring *ring, uint8_t area_id)
+{
+	struct flash_pages_info info;
+	int err;
+
+	k_mutex_init(&ring->lock);
+	ring->dropped = 0;
+	ring->bytes_programmed = 0;
+	ring->erase_count = 0;
+	ring->head_ok = false;
+
+	err = flash_area_open(area_id, &ring->fa);
+	if (err) {
+		LOG_ERR("Failed to open flash area %u, err %d", area_id, err);
+		return err;
+	}
+
+	err = flash_get_page_info_by_offs(flash_area_get_device(ring->fa), ring->fa->fa_off,
+					  &info);
+	if (err) {
+		LOG_ERR("Failed to get sector size, err %d", err);
+		return err;
+	}
+
+	ring->sector_size = info.size;
+	ring->sector_count = ring->fa->fa_size / info.size;
+	if (ring->sector_count < 2) {
+		LOG_ERR("Flash area %u needs at least two sectors", area_id);
+		return -EINVAL;
+	}
+
+	err = ring_recover(ring);
+	if (err) {
+		LOG_ERR("Failed to recover records, err %d", err);
+		return err;
+	}
+
+	LOG_INF("Flash area %u: %u x %u B sectors, %u record(s)", area_id, ring->sector_count,
+		ring->sector_size, ring->count);
+
+	return 0;
+}
+
+static int ring_advance(struct flash_ring *ring)
+{
+	uint16_t next = sector_next(ring, ring->write_sector);
+	uint32_t records;
+	int err;
+
+	if (ring->read_sector == next) {
+		/* Full, the oldest sector makes room for new records */
+		err = sector_scan(ring, next, &records, NULL);
+		if (err) {
+			return err;
+		}
+
+		ring->count -= MIN(records, ring->count);
+		ring->dropped += records;
+		LOG_WRN("Full, dropped %u record(s)", records);
+
+		ring->read_sector = sector_next(ring, next);
+		ring->read_off = sizeof(struct sector_hdr);
+	}
+
+	err = sector_start(ring, next);
+	if (err) {
+		return err;
+	}
+
+	/* An empty ring keeps its read position on the write position */
+	if (ring->count == 0) {
+		ring->read_sector = ring->write_sector;
+		ring->read_off = ring->write_off;
+		return 0;
+	}
+
+	return read_normalize(ring);
+}
+
+int flash_ring_append_stream(struct flash_ring *ring, size_t len, flash_ring_source_t source,
+			     void *ctx)
+{
+	struct rec_hdr hdr = {
+		.status = REC_STATUS_ERASED,
+		.len = len,
+		.reserved = 0xFFFF,
+		.crc = REC_CRC_ERASED,
+	};
+	uint8_t piece[PIECE_LEN];
+	uint32_t crc = 0;
+	size_t done = 0;
+	size_t n;
+	uint16_t sector;
+	off_t off;
+	int err;
+
+	if (len == 0 || len > flash_ring_max_record_len(ring)) {
+		return -EMSGSIZE;
+	}
+
+	k_mutex_lock(&ring->lock, K_FOREVER);
+
+	if (ring->write_off + rec_size(len) > ring->sector_size) {
+		err = ring_advance(ring);
+		if (err) {
+			goto out;
+		}
+	}
+
+	sector = ring->write_sector;
+	off = sector_base(ring, sector) + ring->write_off;
+
+	/* The CRC is still erased here and programmed once the data is known */
+	err = ring_write(ring, off, &hdr, sizeof(hdr));
+
+	while (!err && done < len) {
+		n = MIN(sizeof(piece), len - done);
+		err = source(ctx, done, piece, n);
+		if (err) {
+			break;
+		}
+
+		crc = crc32_ieee_update(crc, piece, n);
+		memset(&piece[n], 0, ROUND_UP(n, REC_ALIGN) - n);
+		err = ring_write(ring, off + sizeof(hdr) + done, piece, ROUND_UP(n, REC_ALIGN));
+		done += n;
+	}
+
+	if (!err) {
+		err = ring_write(ring, off + offsetof(struct rec_hdr, crc), &crc, sizeof(crc));
+	}
+	if (!err) {
+		err = rec_status_write(ring, sector, ring->write_off, REC_STATUS_COMMITTED);
+	}
+
+	/* The space is used even if the write failed, the record is just never committed */
+	ring->write_off += rec_size(len);
+
+	if (err) {
+		LOG_ERR("Failed to write record, err %d", err);
+		(void)read_normalize(ring);
+		goto out;
+	}
+
+	ring->count++;
+
+out:
+	k_mutex_unlock(&ring->lock);
+	return err;
+}
+
+static int buf_source(void *ctx, size_t off, void *buf, size_t len)
+{
+	memcpy(buf, (const uint8_t *)ctx + off, len);
+	return 0;
+}
+
+int flash_ring_append(struct flash_ring *ring, const void *data, size_t len)
+{
+	return flash_ring_append_stream(ring, len, buf_source, (void *)data);
+}
+
+/* Read the header of the oldest record. Called with the lock held. */
+static int head_hdr_get(struct flash_ring *ring, struct rec_hdr *hdr)
+{
+	int ret;
+
+	if (ring->count == 0 || read_at_write_pos(ring)) {
+		return -ENODATA;
+	}
+
+	ret = rec_hdr_read(ring, ring->read_sector, ring->read_off, hdr);
+	if (ret <= 0) {
+		return (ret == 0) ? -EIO : ret;
+	}
+
+	return 0;
+}
+
+static inline off_t head_data_off(const struct flash_ring *ring)
+{
+	return sector_base(ring, ring->read_sector) + ring->read_off + sizeof(struct rec_hdr);
+}
+
+/* Drop the corrupt oldest record. Called with the lock held. */
+static int head_drop_corrupt(struct flash_ring *ring, const struct rec_hdr *hdr)
+{
+	LOG_WRN("CRC mismatch in sector %u at 0x%x, skipping", ring->read_sector,
+		ring->read_off);
+	(void)rec_status_write(ring, ring->read_sector, ring->read_off, REC_STATUS_CONSUMED);
+	ring->read_off += rec_size(hdr->len);
+	ring->count--;
+	ring->dropped++;
+
+	return read_normalize(ring);
+}
+
+int flash_ring_head(struct flash_ring *ring, size_t *len)
+{
+	uint8_t piece[PIECE_LEN];
+	struct rec_hdr hdr;
+	uint32_t crc;
+	size_t n;
+	int ret;
+
+	k_mutex_lock(&ring->lock, K_FOREVER);
+
+	while (true) {
+		ret = head_hdr_get(ring, &hdr);
+		if (ret) {
+			break;
+		}
+
+		if (ring->head_ok && ring->head_ok_sector == ring->read_sector &&
+		    ring->head_ok_off == ring->read_off) {
+			*len = hdr.len;
+			break;
+		}
+
+		crc = 0;
+		for (size_t done = 0; !ret && done < hdr.len; done += n) {
+			n = MIN(sizeof(piece), hdr.len - done);
+			ret = flash_area_read(ring->fa, head_data_off(ring) + done, piece, n);
+			crc = crc32_ieee_update(crc, piece, n);
+		}
+
+		if (ret) {
+			break;
+		}
+
+		if (crc == hdr.crc) {
+			ring->head_ok = true;
+			ring->head_ok_sector = ring->read_sector;
+			ring->head_ok_off = ring->read_off;
+			*len = hdr.len;
+			break;
+		}
+
+		ret = head_drop_corrupt(ring, &hdr);
+		if (ret) {
+			break;
+		}
+	}
+
+	k_mutex_unlock(&ring->lock);
+	return ret;
+}
+
+int flash_ring_read(struct flash_ring *ring, size_t off, void *buf, size_t len)
+{
+	struct rec_hdr hdr;
+	int ret;
+
+	k_mutex_lock(&ring->lock, K_FOREVER);
+
+	ret = head_hdr_get(ring, &hdr);
+	if (!ret && off + len > hdr.len) {
+		ret = -EINVAL;
+	}
+	if (!ret) {
+		ret = flash_area_read(ring->fa, head_data_off(ring) + off, buf, len);
+	}
+
+	k_mutex_unlock(&ring->lock);
+	return ret;
+}
+
+int flash_ring_peek(struct flash_ring *ring, void *buf, size_t size)
+{
+	struct rec_hdr hdr;
+	int ret;
+
+	k_mutex_lock(&ring->lock, K_FOREVER);
+
+	while (true) {
+		ret = head_hdr_get(ring, &hdr);
+		if (ret) {
+			break;
+		}
+
+		if (hdr.len > size) {
+			ret = -ENOBUFS;
+			break;
+		}
+
+		ret = flash_area_read(ring->fa, head_data_off(ring), buf, hdr.len);
+		if (ret) {
+			break;
+		}
+
+		if (crc32_ieee(buf, hdr.len) == hdr.crc) {
+			ret = hdr.len;
+			break;
+		}
+
+		/* Corrupt record, drop it and try the next one */
+		ret = head_drop_corrupt(ring, &hdr);
+		if (ret) {
+			break;
+		}
+	}
+
+	k_mutex_unlock(&ring->lock);
+	return ret;
+}
+
+int flash_ring_consume(struct flash_ring *ring)
+{
+	struct rec_hdr hdr;
+	int ret;
+
+	k_mutex_lock(&ring->lock, K_FOREVER);
+
+	if (ring->count == 0 || read_at_write_pos(ring)) {
+		ret = -ENODATA;
+		goto out;
+	}
+
+	ret = rec_hdr_read(ring, ring->read_sector, ring->read_off, &hdr);
+	if (ret <= 0) {
+		ret = (ret == 0) ? -EIO : ret;
+		goto out;
+	}
+
+	ret = rec_status_write(ring, ring->read_sector, ring->read_off, REC_STATUS_CONSUMED);
+	if (ret) {
+		goto out;
+	}
+
+	ring->read_off += rec_size(hdr.len);
+	ring->count--;
+	ret = read_normalize(ring);
+
+out:
+	k_mutex_unlock(&ring->lock);
+	return ret;
+}
+
+int flash_ring_clear(struct flash_ring *ring)
+{
+	int err;
+
+	k_mutex_lock(&ring->lock, K_FOREVER);
+
+	ring->head_ok = false;
+	ring->erase_count += ring->sector_count;
+	err = flash_area_erase(ring->fa, 0, (size_t)ring->sector_count * ring->sector_size);
+	if (!err) {
+		ring->write_seq = 0;
+		ring->count = 0;
+		err = sector_start(ring, 0);
+		ring->read_sector = ring->write_sector;
+		ring->read_off = ring->write_off;
+	}
+
+	k_mutex_unlock(&ring->lock);
+	return err;
+}
+
+uint32_t flash_ring_count(struct flash_ring *ring)
+{
+	return ring->count;
+}
+
+uint32_t flash_ring_dropped(struct flash_ring *ring)
+{
+	return ring->dropped;
+}
+
+uint32_t flash_ring_bytes_programmed(struct flash_ring *ring)
+{
+	return ring->bytes_programmed;
+}
+
+uint32_t flash_ring_erase_count(struct flash_ring *ring)
+{
+	return ring->erase_count;
+}
+
+size_t flash_ring_max_record_len(const struct flash_ring *ring)
+{
+	return MIN(ring->sector_size - sizeof(struct sector_hdr) - sizeof(struct rec_hdr),
+		   REC_LEN_ERASED - 1);
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef FLASH_RING_H_
+#define FLASH_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Append-only record ring on a flash partition
+ *
+ * Records are appended to the current sector and consumed in order from the
+ * oldest one. Consuming a record only programs its status word, so a sector is
+ * erased once per pass over the partition. When the partition is full the
+ * oldest sector is erased and its unconsumed records are dropped.
+ *
+ * The ring survives reboots: committed records that were not consumed are
+ * found again by flash_ring_init(). A record interrupted by a power loss is
+ * never committed and is skipped.
+ */
+struct flash_ring {
+	const struct flash_area *fa;
+	uint32_t sector_size;
+	uint16_t sector_count;
+
+	/* Next record is written here */
+	uint16_t write_sector;
+	uint32_t write_off;
+	uint32_t write_seq;
+
+	/* Oldest unconsumed record, equal to the write position when empty */
+	uint16_t read_sector;
+	uint32_t read_off;
+
+	/* Oldest record whose CRC flash_ring_head() already checked */
+	bool head_ok;
+	uint16_t head_ok_sector;
+	uint32_t head_ok_off;
+
+	uint32_t count;
+	uint32_t dropped;
+	uint32_t bytes_programmed;
+	uint32_t erase_count;
+	struct k_mutex lock;
+};
+
+/**
+ * @brief Source of a record appended with flash_ring_append_stream()
+ *
+ * @param ctx Context given to flash_ring_append_stream()
+ * @param off Offset into the record
+ * @param buf Destination buffer
+ * @param len Number of bytes to copy
+ * @return 0 on success, negative error code to abort the append
+ */
+typedef int (*flash_ring_source_t)(void *ctx, size_t off, void *buf, size_t len);
+
+/**
+ * @brief Open a partition and recover the records it holds
+ *
+ * The partition must span at least two erase sectors.
+ *
+ * @param ring Ring to initialize
+ * @param area_id Flash area ID, e.g. FIXED_PARTITION_ID(label)
+ * @return 0 on success, negative error code on failure
+ */
+int flash_ring_init(struct flash_ring *ring, uint8_t area_id);
+
+/**
+ * @brief Append a record
+ *
+ * @return 0 on success, -EMSGSIZE if the record can never fit a sector,
+ *         other negative error code on flash failure
+ */
+int flash_ring_append(struct flash_ring *ring, const void *data, size_t len);
+
+/**
+ * @brief Append a record read piecewise from @p source
+ *
+ * The record is never held in RAM as a whole. It is only committed if
+ * @p source returns all of it.
+ *
+ * @return 0 on success, -EMSGSIZE if the record can never fit a sector,
+ *         error of @p source, other negative error code on flash failure
+ */
+int flash_ring_append_stream(struct flash_ring *ring, size_t len, flash_ring_source_t source,
+			     void *ctx);
+
+/**
+ * @brief Get the length of the oldest record without reading it into RAM
+ *
+ * The CRC of the record is checked once, from flash. Corrupt records are
+ * dropped like in flash_ring_peek().
+ *
+ * @return 0 on success, -ENODATA if the ring is empty, other negative error
+ *         code on failure
+ */
+int flash_ring_head(struct flash_ring *ring, size_t *len);
+
+/**
+ * @brief Read part of the oldest record
+ *
+ * @return 0 on success, -ENODATA if the ring is empty, -EINVAL if the range
+ *         is outside the record, other negative error code on failure
+ */
+int flash_ring_read(struct flash_ring *ring, size_t off, void *buf, size_t len);
+
+/**
+ * @brief Read the oldest record without consuming it
+ *
+ * @param ring Ring to read from
+ * @param buf Destination buffer
+ * @param size Size of @p buf
+ * @return Record length on success, -ENODATA if the ring is empty,
+ *         -ENOBUFS if @p buf is too small, other negative error code on failure
+ */
+int flash_ring_peek(struct flash_ring *ring, void *buf, size_t size);
+
+/**
+ * @brief Consume the oldest record
+ *
+ * @return 0 on success, -ENODATA if the ring is empty, negative error code on failure
+ */
+int flash_ring_consume(struct flash_ring *ring);
+
+/**
+ * @brief Erase all records
+ */
+int flash_ring_clear(struct flash_ring *ring);
+
+/**
+ * @brief Number of unconsumed records
+ */
+uint32_t flash_ring_count(struct flash_ring *ring);
+
+/**
+ * @brief Number of records dropped because the ring was full, since init
+ */
+uint32_t flash_ring_dropped(struct flash_ring *ring);
+
+/**
+ * @brief Bytes programmed since init, including headers, padding and status words
+ */
+uint32_t flash_ring_bytes_programmed(struct flash_ring *ring);
+
+/**
+ * @brief Number of sector erases since init
+ */
+uint32_t flash_ring_erase_count(struct flash_ring *ring);
+
+/**
+ * @brief Largest record that fits a sector
+ */
+size_t flash_ring_max_record_len(const struct flash_ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_RING_H_ */
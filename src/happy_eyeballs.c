@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Dual-stack connection establishment following RFC 8305 (Happy Eyeballs v2),
+ * reduced to one address per family:
+ *
+ * - A and AAAA queries are sent in parallel.
+ * - The preferred family (IPv6, or the family that won last time for the host)
+ *   is attempted first. If the other family answers first, the connector waits
+ *   the Resolution Delay for the preferred answer before using it.
+ * - A second attempt is started when the first has not completed within the
+ *   Connection Attempt Delay, or right away when the first fails.
+ * - The first socket to connect wins, the other attempt is abandoned and the
+ *   winning family is cached per host.
+ */
+
+#include "happy_eyeballs.h"
+
+#include <string.h>
+#include <limits.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/dns_resolve.h>
+
+#if defined(CONFIG_POSIX_API)
+#include <zephyr/posix/fcntl.h>
+#endif
+
+LOG_MODULE_REGISTER(happy_eyeballs, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+/* Fixed slot per family, attempt order is kept separately in he_conn.order */
+#define SLOT_IPV6 0
+#define SLOT_IPV4 1
+
+#define HE_HOSTNAME_MAX_LEN 64
+
+struct he_cache_entry {
+	char hostname[HE_HOSTNAME_MAX_LEN];
+	sa_family_t family;
+	int64_t expires_at;
+};
+
+static struct he_cache_entry family_cache[CONFIG_HAPPY_EYEBALLS_CACHE_SIZE];
+static K_MUTEX_DEFINE(family_cache_lock);
+
+static const sa_family_t slot_family[HE_FAMILY_COUNT] = {
+	[SLOT_IPV6] = AF_INET6,
+	[SLOT_IPV4] = AF_INET,
+};
+
+static const enum dns_query_type slot_query_type[HE_FAMILY_COUNT] = {
+	[SLOT_IPV6] = DNS_QUERY_TYPE_AAAA,
+	[SLOT_IPV4] = DNS_QUERY_TYPE_A,
+};
+
+static sa_family_t cache_lookup(const char *hostname)
+{
+	sa_family_t family = AF_UNSPEC;
+	int64_t now = k_uptime_get();
+
+	k_mutex_lock(&family_cache_lock, K_FOREVER);
+	for (size_t i = 0; i < ARRAY_SIZE(family_cache); i++) {
+		if (family_cache[i].expires_at > now &&
+		    strncmp(family_cache[i].hostname, hostname, HE_HOSTNAME_MAX_LEN) == 0) {
+			family = family_cache[i].family;
+			break;
+		}
+	}
+	k_mutex_unlock(&family_cache_lock);
+
+	return family;
+}
+
+static void cache_store(const char *hostname, sa_family_t family)
+{
+	struct he_cache_entry *slot = &family_cache[0];
+	int64_t now = k_uptime_get();
+
+	k_mutex_lock(&family_cache_lock, K_FOREVER);
+	for (size_t i = 0; i < ARRAY_SIZE(family_cache); i++) {
+		struct he_cache_entry *entry = &family_cache[i];
+
+		if (strncmp(entry->hostname, hostname, HE_HOSTNAME_MAX_LEN) == 0) {
+			slot = entry;
+			break;
+		}
+
+		/* Otherwise replace the entry closest to expiry */
+		if (entry->expires_at < slot->expires_at) {
+			slot = entry;
+		}
+	}
+
+	strncpy(slot->hostname, hostname, sizeof(slot->hostname) - 1);
+	slot->hostname[sizeof(slot->hostname) - 1] = '\0';
+	slot->family = family;
+	slot->expires_at = now + (int64_t)CONFIG_HAPPY_EYEBALLS_CACHE_TTL_SEC * MSEC_PER_SEC;
+	k_mutex_unlock(&family_cache_lock);
+}
+
+static void dns_result_cb(enum dns_resolve_status status, struct dns_addrinfo *info,
+			  void *user_data)
+{
+	struct he_query *query = user_data;
+	struct he_conn *conn = query->conn;
+	uint8_t slot = query->slot;
+
+	if (atomic_test_bit(&conn->dns_done, slot)) {
+		return;
+	}
+
+	if (status == DNS_EAI_INPROGRESS) {
+		/* Keep the first address of the answer */
+		if (info && conn->addrlen[slot] == 0 && info->ai_family == slot_family[slot]) {
+			memcpy(&conn->addr[slot], &info->ai_addr, info->ai_addrlen);
+			conn->addrlen[slot] = info->ai_addrlen;
+		}
+		return;
+	}
+
+	if (status != DNS_EAI_ALLDONE || conn->addrlen[slot] == 0) {
+		atomic_set_bit(&conn->dns_failed, slot);
+	}
+
+	atomic_set_bit(&conn->dns_done, slot);
+
+	if (conn->wake) {
+		conn->wake(conn);
+	}
+}
+
+static bool slot_resolved(const struct he_conn *conn, uint8_t slot)
+{
+	return atomic_test_bit(&conn->dns_done, slot) && !atomic_test_bit(&conn->dns_failed, slot);
+}
+
+static void close_attempt(struct he_conn *conn, uint8_t slot)
+{
+	if (conn->fd[slot] >= 0) {
+		(void)zsock_close(conn->fd[slot]);
+		conn->fd[slot] = -1;
+	}
+}
+
+static void cancel_lookups(struct he_conn *conn)
+{
+	for (uint8_t slot = 0; slot < HE_FAMILY_COUNT; slot++) {
+		if (!atomic_test_and_set_bit(&conn->dns_done, slot)) {
+			atomic_set_bit(&conn->dns_failed, slot);
+			(void)dns_cancel_addr_info(conn->query[slot].id);
+		}
+	}
+}
+
+/* @return 1 if connected right away, 0 if in progress, negative error code on failure */
+static int start_attempt(struct he_conn *conn, uint8_t slot)
+{
+	struct sockaddr *addr = (struct sockaddr *)&conn->addr[slot];
+	int fd;
+	int err;
+
+	conn->attempted[slot] = true;
+	conn->last_attempt_at = k_uptime_get();
+
+	if (slot_family[slot] == AF_INET6) {
+		net_sin6(addr)->sin6_port = htons(conn->port);
+	} else {
+		net_sin(addr)->sin_port = htons(conn->port);
+	}
+
+	fd = zsock_socket(slot_family[slot], conn->type ? conn->type : SOCK_STREAM, conn->proto);
+	if (fd < 0) {
+		LOG_WRN("%s: socket(%s) failed, err %d", conn->hostname,
+			net_family2str(slot_family[slot]), errno);
+		return -errno;
+	}
+
+	if (conn->setup) {
+		err = conn->setup(fd, conn->user_data);
+		if (err) {
+			(void)zsock_close(fd);
+			return err;
+		}
+	}
+
+	err = zsock_fcntl(fd, F_SETFL, O_NONBLOCK);
+	if (err) {
+		err = -errno;
+		(void)zsock_close(fd);
+		return err;
+	}
+
+	LOG_DBG("%s: connecting over %s", conn->hostname, net_family2str(slot_family[slot]));
+
+	conn->fd[slot] = fd;
+
+	err = zsock_connect(fd, addr, conn->addrlen[slot]);
+	if (err == 0) {
+		return 1;
+	}
+
+	if (errno == EINPROGRESS || errno == EAGAIN) {
+		return 0;
+	}
+
+	err = -errno;
+	LOG_WRN("%s: connect over %s failed, err %d", conn->hostname,
+		net_family2str(slot_family[slot]), err);
+	close_attempt(conn, slot);
+	return err;
+}
+
+static int finish_won(struct he_conn *conn, uint8_t slot)
+{
+	int fd = conn->fd[slot];
+
+	conn->fd[slot] = -1;
+	cancel_lookups(conn);
+	for (uint8_t other = 0; other < HE_FAMILY_COUNT; other++) {
+		close_attempt(conn, other);
+	}
+	conn->active = false;
+
+	cache_store(conn->hostname, slot_family[slot]);
+
+	LOG_INF("%s: connected over %s in %lld ms", conn->hostname,
+		net_family2str(slot_family[slot]), k_uptime_get() - conn->started_at);
+
+	return fd;
+}
+
+static bool attempt_in_flight(const struct he_conn *conn)
+{
+	for (uint8_t slot = 0; slot < HE_FAMILY_COUNT; slot++) {
+		if (conn->fd[slot] >= 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Index into conn->order of the next slot to attempt, or -1 to wait */
+static int next_attempt(const struct he_conn *conn, int64_t now)
+{
+	for (int i = 0; i < HE_FAMILY_COUNT; i++) {
+		uint8_t slot = conn->order[i];
+
+		if (conn->attempted[slot]) {
+			continue;
+		}
+
+		if (!slot_resolved(conn, slot)) {
+			if (atomic_test_bit(&conn->dns_failed, slot)) {
+				continue;
+			}
+
+			/* Preferred answer outstanding, fall through to the other family only
+			 * once the Resolution Delay has passed since the first answer.
+			 */
+			if (conn->resolved_at &&
+			    now - conn->resolved_at >= CONFIG_HAPPY_EYEBALLS_RESOLUTION_DELAY_MS) {
+				continue;
+			}
+			return -1;
+		}
+
+		if (attempt_in_flight(conn) &&
+		    now - conn->last_attempt_at < CONFIG_HAPPY_EYEBALLS_CONNECT_ATTEMPT_DELAY_MS) {
+			return -1;
+		}
+
+		return i;
+	}
+
+	return -1;
+}
+
+int he_conn_start(struct he_conn *conn)
+{
+	sa_family_t preferred;
+	int issued = 0;
+	int err;
+
+	conn->started_at = k_uptime_get();
+	conn->resolved_at = 0;
+	conn->last_attempt_at = 0;
+	atomic_clear(&conn->dns_done);
+	atomic_clear(&conn->dns_failed);
+
+	for (uint8_t slot = 0; slot < HE_FAMILY_COUNT; slot++) {
+		conn->query[slot].conn = conn;
+		conn->query[slot].slot = slot;
+		conn->addrlen[slot] = 0;
+		conn->fd[slot] = -1;
+		conn->attempted[slot] = false;
+	}
+
+	preferred = cache_lookup(conn->hostname);
+	if (preferred == AF_INET || !IS_ENABLED(CONFIG_NET_IPV6)) {
+		conn->order[0] = SLOT_IPV4;
+		conn->order[1] = SLOT_IPV6;
+	} else {
+		conn->order[0] = SLOT_IPV6;
+		conn->order[1] = SLOT_IPV4;
+	}
+
+	conn->active = true;
+
+	for (uint8_t slot = 0; slot < HE_FAMILY_COUNT; slot++) {
+		if ((slot_family[slot] == AF_INET6 && !IS_ENABLED(CONFIG_NET_IPV6)) ||
+		    (slot_family[slot] == AF_INET && !IS_ENABLED(CONFIG_NET_IPV4))) {
+			atomic_set_bit(&conn->dns_failed, slot);
+			atomic_set_bit(&conn->dns_done, slot);
+			continue;
+		}
+
+		err = dns_get_addr_info(conn->hostname, slot_query_type[slot], &conn->query[slot].id,
+					dns_result_cb, &conn->query[slot],
+					CONFIG_NET_SOCKETS_DNS_TIMEOUT);
+		if (err) {
+			LOG_WRN("%s: %s lookup failed to start, err %d", conn->hostname,
+				net_family2str(slot_family[slot]), err);
+			atomic_set_bit(&conn->dns_failed, slot);
+			atomic_set_bit(&conn->dns_done, slot);
+			continue;
+		}
+		issued++;
+	}
+
+	if (issued == 0) {
+		conn->active = false;
+		return -EHOSTUNREACH;
+	}
+
+	return 0;
+}
+
+int he_conn_pollfds(const struct he_conn *conn, struct zsock_pollfd *fds, int max)
+{
+	int n = 0;
+
+	for (uint8_t slot = 0; slot < HE_FAMILY_COUNT && n < max; slot++) {
+		if (conn->fd[slot] >= 0) {
+			fds[n].fd = conn->fd[slot];
+			fds[n].events = ZSOCK_POLLOUT;
+			fds[n].revents = 0;
+			n++;
+		}
+	}
+
+	return n;
+}
+
+int he_conn_process(struct he_conn *conn, const struct zsock_pollfd *fds, int nfds)
+{
+	int64_t now = k_uptime_get();
+	int next;
+	int ret;
+
+	if (!conn->active) {
+		return -EINVAL;
+	}
+
+	/* Completed or failed attempts */
+	for (uint8_t slot = 0; slot < HE_FAMILY_COUNT; slot++) {
+		short revents = 0;
+		int sock_err = 0;
+		socklen_t len = sizeof(sock_err);
+
+		if (conn->fd[slot] < 0) {
+			continue;
+		}
+
+		for (int i = 0; i < nfds; i++) {
+			if (fds[i].fd == conn->fd[slot]) {
+				revents = fds[i].revents;
+				break;
+			}
+		}
+
+		if (!(revents & (ZSOCK_POLLOUT | ZSOCK_POLLERR | ZSOCK_POLLHUP))) {
+			continue;
+		}
+
+		if (zsock_getsockopt(conn->fd[slot], SOL_SOCKET, SO_ERROR, &sock_err, &len) == 0 &&
+		    sock_err == 0 && !(revents & ZSOCK_POLLERR)) {
+			return finish_won(conn, slot);
+		}
+
+		LOG_WRN("%s: connect over %s failed, err %d", conn->hostname,
+			net_family2str(slot_family[slot]), sock_err);
+		close_attempt(conn, slot);
+		/* Let the next family go right away */
+		conn->last_attempt_at = 0;
+	}
+
+	if (conn->resolved_at == 0 &&
+	    (slot_resolved(conn, SLOT_IPV6) || slot_resolved(conn, SLOT_IPV4))) {
+		conn->resolved_at = now;
+	}
+
+	/* New attempts, several may start back to back when attempts fail immediately */
+	while ((next = next_attempt(conn, now)) >= 0) {
+		uint8_t slot = conn->order[next];
+
+		ret = start_attempt(conn, slot);
+		if (ret == 1) {
+			return finish_won(conn, slot);
+		}
+		if (ret == 0) {
+			break;
+		}
+		conn->last_attempt_at = 0;
+	}
+
+	if (attempt_in_flight(conn)) {
+		return -EINPROGRESS;
+	}
+
+	for (uint8_t slot = 0; slot < HE_FAMILY_COUNT; slot++) {
+		if (!atomic_test_bit(&conn->dns_done, slot) ||
+		    (slot_resolved(conn, slot) && !conn->attempted[slot])) {
+			return -EINPROGRESS;
+		}
+	}
+
+	LOG_WRN("%s: all connection attempts failed", conn->hostname);
+	conn->active = false;
+	return -EHOSTUNREACH;
+}
+
+int he_conn_timeout_ms(const struct he_conn *conn)
+{
+	int64_t now = k_uptime_get();
+	int64_t wake_at = INT64_MAX;
+
+	for (int i = 0; i < HE_FAMILY_COUNT; i++) {
+		uint8_t slot = conn->order[i];
+
+		if (conn->attempted[slot] || atomic_test_bit(&conn->dns_failed, slot)) {
+			continue;
+		}
+
+		if (!atomic_test_bit(&conn->dns_done, slot)) {
+			if (conn->resolved_at) {
+				wake_at = MIN(wake_at, conn->resolved_at +
+							       CONFIG_HAPPY_EYEBALLS_RESOLUTION_DELAY_MS);
+			}
+			continue;
+		}
+
+		if (attempt_in_flight(conn)) {
+			wake_at = MIN(wake_at, conn->last_attempt_at +
+						       CONFIG_HAPPY_EYEBALLS_CONNECT_ATTEMPT_DELAY_MS);
+		} else {
+			wake_at = now;
+		}
+	}
+
+	if (wake_at == INT64_MAX) {
+		return -1;
+	}
+
+	return (int)CLAMP(wake_at - now, 0, INT_MAX);
+}
+
+void he_conn_abort(struct he_conn *conn)
+{
+	cancel_lookups(conn);
+
+	for (uint8_t slot = 0; slot < HE_FAMILY_COUNT; slot++) {
+		close_attempt(conn, slot);
+	}
+
+	conn->active = false;
+}
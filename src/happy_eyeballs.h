@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef HAPPY_EYEBALLS_H_
+#define HAPPY_EYEBALLS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/sys/atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Slots per connection, one per address family */
+#define HE_FAMILY_COUNT 2
+
+/**
+ * @brief Socket setup hook, called for every socket before it connects
+ *
+ * Used to apply TLS options. A non-zero return aborts that attempt.
+ */
+typedef int (*he_socket_setup_t)(int fd, void *user_data);
+
+struct he_conn;
+
+/**
+ * @brief Wake hook, called from the DNS resolver context when a lookup completes
+ *
+ * The owner of a non-blocking connection uses it to return from zsock_poll().
+ */
+typedef void (*he_wake_t)(struct he_conn *conn);
+
+/* Context of one DNS query, lets the resolver callback tell A and AAAA answers apart */
+struct he_query {
+	struct he_conn *conn;
+	uint16_t id;
+	uint8_t slot;
+};
+
+/**
+ * @brief Dual-stack connection establishment state (RFC 8305)
+ *
+ * Fields below the configuration block are private to the connector.
+ */
+struct he_conn {
+	/* Configuration, set before he_conn_start() */
+	const char *hostname;
+	uint16_t port;
+	/* Socket type, 0 selects SOCK_STREAM */
+	int type;
+	int proto;
+	he_socket_setup_t setup;
+	he_wake_t wake;
+	/* Passed to the setup hook */
+	void *user_data;
+
+	/* Private */
+	int64_t started_at;
+	int64_t resolved_at;
+	int64_t last_attempt_at;
+	uint8_t order[HE_FAMILY_COUNT];
+	struct he_query query[HE_FAMILY_COUNT];
+	atomic_t dns_done;
+	atomic_t dns_failed;
+	struct sockaddr_storage addr[HE_FAMILY_COUNT];
+	socklen_t addrlen[HE_FAMILY_COUNT];
+	int fd[HE_FAMILY_COUNT];
+	bool attempted[HE_FAMILY_COUNT];
+	bool active;
+};
+
+/**
+ * @brief Start resolving and connecting
+ *
+ * Issues A and AAAA queries in parallel. Connection attempts are started as
+ * answers arrive, preferring the family that won last time for this host.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int he_conn_start(struct he_conn *conn);
+
+/**
+ * @brief Add the sockets of pending connection attempts to a poll set
+ *
+ * @param conn Connection in progress
+ * @param fds Poll set to append to
+ * @param max Free entries in @p fds
+ * @return Number of entries appended
+ */
+int he_conn_pollfds(const struct he_conn *conn, struct zsock_pollfd *fds, int max);
+
+/**
+ * @brief Advance the connection after zsock_poll() returned
+ *
+ * @param conn Connection in progress
+ * @param fds Poll set as returned by zsock_poll(), may contain unrelated entries
+ * @param nfds Number of entries in @p fds
+ * @return Connected socket (>= 0) once an attempt won,
+ *         -EINPROGRESS while attempts are pending,
+ *         other negative error code when every attempt failed
+ */
+int he_conn_process(struct he_conn *conn, const struct zsock_pollfd *fds, int nfds);
+
+/**
+ * @brief Milliseconds until the connector needs to run again without socket activity
+ *
+ * @return Timeout for zsock_poll(), -1 if only socket or DNS activity is awaited
+ */
+int he_conn_timeout_ms(const struct he_conn *conn);
+
+/**
+ * @brief Abort all pending lookups and attempts
+ */
+void he_conn_abort(struct he_conn *conn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAPPY_EYEBALLS_H_ */
@@ -7,18 +7,26 @@
 #include "https_client.h"
 
 #include <string.h>
+#include <limits.h>
 #include <zephyr/kernel.h>
 #include <stdlib.h>
 #include <zephyr/net/socket.h>
 #include <zephyr/net/tls_credentials.h>
+#include <zephyr/zvfs/eventfd.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/logging/log.h>
 #include <memfault/metrics/metrics.h>
 
+#include "happy_eyeballs.h"
+#include "net_events.h"
+#include "net_policy.h"
+
 #if defined(CONFIG_POSIX_API)
 #include <zephyr/posix/arpa/inet.h>
 #include <zephyr/posix/netdb.h>
 #include <zephyr/posix/unistd.h>
 #include <zephyr/posix/sys/socket.h>
+#include <zephyr/posix/fcntl.h>
 #endif
 
 #if CONFIG_MODEM_KEY_MGMT
@@ -27,25 +35,84 @@
 
 LOG_MODULE_REGISTER(https_client_app, CONFIG_HTTPS_CLIENT_LOG_LEVEL);
 
-#define HTTPS_PORT "443"
-#define HTTP_HEAD                                                                                  \
-	"HEAD / HTTP/1.1\r\n"                                                                      \
-	"Host: " CONFIG_HTTPS_HOSTNAME ":" HTTPS_PORT "\r\n"                                       \
+#define HTTPS_PORT     443
+#define HTTP_REQ_FMT                                                                               \
+	"%s %s HTTP/1.1\r\n"                                                                       \
+	"Host: %s:%d\r\n"                                                                          \
 	"Connection: close\r\n\r\n"
 
-#define HTTP_HEAD_LEN (sizeof(HTTP_HEAD) - 1)
-#define HTTP_HDR_END  "\r\n\r\n"
-
-#define RECV_BUF_SIZE 2048
-#define TLS_SEC_TAG   42
-
-#define HTTPS_REQUEST_INTERVAL_SEC CONFIG_HTTPS_REQUEST_INTERVAL_SEC
-
-static const char send_buf[] = HTTP_HEAD;
+#define REQ_BUF_SIZE         192
+#define STATUS_LINE_BUF_SIZE 64
+#define RECV_BUF_SIZE        2048
+#define TLS_SEC_TAG          42
+
+/* One eventfd slot plus up to one socket per address family and target */
+#define HTTPS_POLL_FDS (1 + HE_FAMILY_COUNT * HTTPS_TARGET_COUNT)
+
+enum https_target_state {
+	HTTPS_TARGET_IDLE,
+	HTTPS_TARGET_CONNECTING,
+	HTTPS_TARGET_SENDING,
+	HTTPS_TARGET_RECEIVING,
+};
+
+struct https_target_cfg {
+	const char *name;
+	const char *hostname;
+	const char *path;
+	const char *method;
+	uint32_t interval_sec;
+	uint32_t timeout_ms;
+};
+
+struct https_target {
+	const struct https_target_cfg *cfg;
+	enum https_target_state state;
+	int fd;
+	/* Uptime (ms) at which the next request is started */
+	int64_t next_run;
+	/* Uptime (ms) at which the in-flight request is abandoned */
+	int64_t deadline;
+	int64_t started_at;
+
+	/* Adaptive timeout, retry spacing and failure isolation */
+	struct net_rtt_estimator rtt;
+	struct net_backoff retry;
+	struct net_breaker breaker;
+
+	/* Dual-stack lookup and connect, owns the sockets until one connects */
+	struct he_conn he;
+
+	char req[REQ_BUF_SIZE];
+	size_t req_len;
+	size_t req_off;
+	char status_line[STATUS_LINE_BUF_SIZE];
+	size_t status_len;
+	bool status_done;
+	size_t rx_total;
+};
+
+#define HTTPS_CLIENT_TARGET_DEFINE(_name, _hostname, _path, _method, _interval_sec, _timeout_ms)  \
+	{                                                                                          \
+		.name = STRINGIFY(_name),                                                          \
+		.hostname = _hostname,                                                             \
+		.path = _path,                                                                     \
+		.method = _method,                                                                 \
+		.interval_sec = _interval_sec,                                                     \
+		.timeout_ms = _timeout_ms,                                                         \
+	},
+static const struct https_target_cfg target_cfgs[] = {
+#include "https_client_targets.def"
+};
+#undef HTTPS_CLIENT_TARGET_DEFINE
+
+#define HTTPS_TARGET_COUNT ARRAY_SIZE(target_cfgs)
+
+static struct https_target targets[HTTPS_TARGET_COUNT];
 static char recv_buf[RECV_BUF_SIZE];
-static K_SEM_DEFINE(https_thread_sem, 0, 1);
+static int wake_fd = -1;
 static bool https_client_running = false;
-static bool network_ready = false;
+static atomic_t network_ready = ATOMIC_INIT(0);
 static uint32_t https_req_total;    /* Local counter for total requests */
 static uint32_t https_req_failures; /* Local counter for failed requests */
 
@@ -120,7 +187,7 @@ static int cert_provision(void)
 }
 
 /* Setup TLS options on a given socket */
-static int tls_setup(int fd)
+static int tls_setup(int fd, const char *hostname)
 {
 	int err;
 	int verify;
@@ -154,8 +221,7 @@ static int tls_setup(int fd)
 		return err;
 	}
 
-	err = setsockopt(fd, SOL_TLS, TLS_HOSTNAME, CONFIG_HTTPS_HOSTNAME,
-			 sizeof(CONFIG_HTTPS_HOSTNAME) - 1);
+	err = setsockopt(fd, SOL_TLS, TLS_HOSTNAME, hostname, strlen(hostname));
 	if (err) {
 		LOG_ERR("Failed to setup TLS hostname, err %d", errno);
 		return err;
@@ -163,142 +229,275 @@ static int tls_setup(int fd)
 	return 0;
 }
 
-static void send_http_request(void)
+/* Wake the client thread out of zsock_poll() */
+static void https_client_wake(void)
+{
+	if (wake_fd >= 0) {
+		(void)zvfs_eventfd_write(wake_fd, 1);
+	}
+}
+
+/* Happy Eyeballs hooks */
+static int target_socket_setup(int fd, void *user_data)
+{
+	struct https_target *t = user_data;
+
+	return tls_setup(fd, t->cfg->hostname);
+}
+
+static void target_wake(struct he_conn *conn)
+{
+	ARG_UNUSED(conn);
+
+	https_client_wake();
+}
+
+static void target_close(struct https_target *t)
+{
+	if (t->state == HTTPS_TARGET_CONNECTING) {
+		he_conn_abort(&t->he);
+	}
+
+	if (t->fd >= 0) {
+		/* Graceful shutdown - notify peer we're done sending */
+		(void)zsock_shutdown(t->fd, ZSOCK_SHUT_RDWR);
+		(void)close(t->fd);
+		t->fd = -1;
+	}
+
+	t->state = HTTPS_TARGET_IDLE;
+}
+
+static void target_finish(struct https_target *t, bool request_failed)
+{
+	int64_t now = k_uptime_get();
+
+	target_close(t);
+
+	if (request_failed) {
+		https_req_failures++;
+		MEMFAULT_METRIC_SET_UNSIGNED(https_req_fail_count, https_req_failures);
+
+		if (net_breaker_failure(&t->breaker)) {
+			LOG_WRN("[%s] Circuit open, pausing requests for %u ms", t->cfg->name,
+				net_breaker_remaining_ms(&t->breaker));
+			t->next_run = now + net_breaker_remaining_ms(&t->breaker);
+		} else {
+			/* Retry ahead of the regular interval, spread by jittered backoff */
+			t->next_run = MIN(t->next_run, now + net_backoff_next_ms(&t->retry));
+		}
+	} else {
+		net_rtt_update(&t->rtt, (uint32_t)(now - t->started_at));
+		net_backoff_reset(&t->retry);
+		net_breaker_success(&t->breaker);
+	}
+	/* Log local metrics after each request */
+	LOG_INF("HTTPS Request Test Metrics - Total: %u, Failures: %u", https_req_total,
+		https_req_failures);
+}
+
+static void target_start(struct https_target *t, int64_t now)
 {
 	int err;
-	int fd = -1;
-	char *p;
-	int bytes;
-	size_t off;
-	struct addrinfo *res = NULL;
-	struct addrinfo hints = {
-		.ai_flags = AI_NUMERICSERV, /* Let getaddrinfo() set port */
-		.ai_socktype = SOCK_STREAM,
-		.ai_family = AF_INET, /* Force IPv4 to reduce DNS lookup time */
-	};
-	char peer_addr[INET6_ADDRSTRLEN];
-	bool request_failed = false;
 
-	if (!network_ready) {
-		LOG_WRN("Network not ready, skipping HTTPS request");
+	if (!net_breaker_allow(&t->breaker)) {
+		t->next_run = now + net_breaker_remaining_ms(&t->breaker);
 		return;
 	}
 
+	/* Schedule on a fixed cadence so a slow request does not drift the interval */
+	t->next_run = now + (int64_t)t->cfg->interval_sec * MSEC_PER_SEC;
+	t->started_at = now;
+	t->deadline = now + net_rtt_timeout_ms(&t->rtt);
+
 	/* Increment total request count (both local and Memfault) */
 	https_req_total++;
 	MEMFAULT_METRIC_SET_UNSIGNED(https_req_total_count, https_req_total);
 
-	LOG_INF("Looking up %s", CONFIG_HTTPS_HOSTNAME);
+	LOG_INF("[%s] Connecting to %s:%d", t->cfg->name, t->cfg->hostname, HTTPS_PORT);
 
-	err = getaddrinfo(CONFIG_HTTPS_HOSTNAME, HTTPS_PORT, &hints, &res);
+	t->req_off = 0;
+	t->status_len = 0;
+	t->status_done = false;
+	t->rx_total = 0;
+
+	/* Lookup and connect run in the background, their sockets join the poll set */
+	err = he_conn_start(&t->he);
 	if (err) {
-		LOG_ERR("getaddrinfo() failed, err %d", errno);
-		request_failed = true;
-		goto clean_up;
+		LOG_ERR("[%s] Failed to start lookup, err %d", t->cfg->name, err);
+		target_finish(t, true);
+		return;
 	}
 
-	inet_ntop(res->ai_family, &((struct sockaddr_in *)(res->ai_addr))->sin_addr, peer_addr,
-		  INET6_ADDRSTRLEN);
-	LOG_INF("Resolved %s (%s)", peer_addr, net_family2str(res->ai_family));
+	t->state = HTTPS_TARGET_CONNECTING;
+}
 
-	if (IS_ENABLED(CONFIG_SAMPLE_TFM_MBEDTLS)) {
-		fd = socket(res->ai_family, SOCK_STREAM | SOCK_NATIVE_TLS, IPPROTO_TLS_1_2);
-	} else {
-		fd = socket(res->ai_family, SOCK_STREAM, IPPROTO_TLS_1_2);
-	}
-	if (fd == -1) {
-		LOG_ERR("socket() failed, err %d", errno);
-		request_failed = true;
-		goto clean_up;
-	}
+static void target_send(struct https_target *t);
 
-	/* Set socket timeouts to prevent hanging */
-	struct timeval timeout = {
-		.tv_sec = 30,
-		.tv_usec = 0,
-	};
-	(void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-	(void)setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+static void target_connecting(struct https_target *t, const struct zsock_pollfd *fds, int nfds)
+{
+	int ret;
 
-	/* Setup TLS socket options */
-	err = tls_setup(fd);
-	if (err) {
-		LOG_ERR("TLS setup failed");
-		request_failed = true;
-		goto clean_up;
+	ret = he_conn_process(&t->he, fds, nfds);
+	if (ret == -EINPROGRESS) {
+		return;
 	}
 
-	LOG_INF("Connecting to %s:%d", CONFIG_HTTPS_HOSTNAME,
-		ntohs(((struct sockaddr_in *)(res->ai_addr))->sin_port));
-	err = connect(fd, res->ai_addr, res->ai_addrlen);
-	if (err) {
-		LOG_ERR("connect() failed, err: %d", errno);
-		request_failed = true;
-		goto clean_up;
+	if (ret < 0) {
+		LOG_ERR("[%s] connect() failed, err: %d", t->cfg->name, ret);
+		/* Connector already released its sockets */
+		t->state = HTTPS_TARGET_IDLE;
+		target_finish(t, true);
+		return;
 	}
 
-	off = 0;
-	do {
-		bytes = send(fd, &send_buf[off], HTTP_HEAD_LEN - off, 0);
+	t->fd = ret;
+	t->state = HTTPS_TARGET_SENDING;
+	/* TLS handshake starts on first send, no need to wait for another POLLOUT */
+	target_send(t);
+}
+
+static void target_send(struct https_target *t)
+{
+	ssize_t bytes;
+
+	while (t->req_off < t->req_len) {
+		bytes = send(t->fd, &t->req[t->req_off], t->req_len - t->req_off, 0);
 		if (bytes < 0) {
-			LOG_ERR("send() failed, err %d", errno);
-			request_failed = true;
-			goto clean_up;
+			if (errno == EAGAIN) {
+				/* TLS handshake or TX window pending, wait for POLLOUT */
+				return;
+			}
+			LOG_ERR("[%s] send() failed, err %d", t->cfg->name, errno);
+			target_finish(t, true);
+			return;
 		}
-		off += bytes;
-	} while (off < HTTP_HEAD_LEN);
+		t->req_off += bytes;
+	}
 
-	LOG_INF("Sent %d bytes", off);
+	LOG_INF("[%s] Sent %zu bytes", t->cfg->name, t->req_off);
+	t->state = HTTPS_TARGET_RECEIVING;
+}
+
+static void target_recv(struct https_target *t)
+{
+	ssize_t bytes;
 
-	off = 0;
-	do {
-		bytes = recv(fd, &recv_buf[off], RECV_BUF_SIZE - off, 0);
+	while (true) {
+		bytes = recv(t->fd, recv_buf, sizeof(recv_buf), 0);
 		if (bytes < 0) {
-			LOG_ERR("recv() failed, err %d", errno);
-			request_failed = true;
-			goto clean_up;
+			if (errno == EAGAIN) {
+				return;
+			}
+			LOG_ERR("[%s] recv() failed, err %d", t->cfg->name, errno);
+			target_finish(t, true);
+			return;
 		}
-		off += bytes;
-	} while (bytes != 0 /* peer closed connection */);
 
-	LOG_INF("Received %d bytes", off);
+		if (bytes == 0) {
+			/* Peer closed connection */
+			break;
+		}
 
-	/* Make sure recv_buf is NULL terminated (for safe use with strstr) */
-	if (off < sizeof(recv_buf)) {
-		recv_buf[off] = '\0';
-	} else {
-		recv_buf[sizeof(recv_buf) - 1] = '\0';
+		/* Only the status line is kept, the rest of the response is discarded */
+		for (ssize_t i = 0; i < bytes && !t->status_done; i++) {
+			if (recv_buf[i] == '\r' || recv_buf[i] == '\n' ||
+			    t->status_len == sizeof(t->status_line) - 1) {
+				t->status_done = true;
+				break;
+			}
+			t->status_line[t->status_len++] = recv_buf[i];
+		}
+		t->rx_total += bytes;
 	}
 
-	/* Print HTTP response */
-	p = strstr(recv_buf, "\r\n");
-	if (p) {
-		off = p - recv_buf;
-		recv_buf[off + 1] = '\0';
-		LOG_INF("Response: %s", recv_buf);
+	t->status_line[t->status_len] = '\0';
+
+	LOG_INF("[%s] Received %zu bytes", t->cfg->name, t->rx_total);
+	if (t->status_len > 0) {
+		LOG_INF("[%s] Response: %s", t->cfg->name, t->status_line);
 	}
 
-	LOG_DBG("Finished, closing socket");
+	LOG_DBG("[%s] Finished, closing socket", t->cfg->name);
+	target_finish(t, false);
+}
 
-clean_up:
-	if (request_failed) {
-		https_req_failures++;
-		MEMFAULT_METRIC_SET_UNSIGNED(https_req_fail_count, https_req_failures);
+static void target_process(struct https_target *t, const struct zsock_pollfd *fds, int nfds,
+			   short revents, int64_t now)
+{
+	if (t->state == HTTPS_TARGET_IDLE) {
+		if (atomic_get(&network_ready) && now >= t->next_run) {
+			target_start(t, now);
+		}
+		return;
 	}
-	/* Log local metrics after each request */
-	LOG_INF("HTTPS Request Test Metrics - Total: %u, Failures: %u", https_req_total,
-		https_req_failures);
 
-	if (fd >= 0) {
-		/* Graceful shutdown - notify peer we're done sending */
-		(void)zsock_shutdown(fd, ZSOCK_SHUT_RDWR);
-		(void)close(fd);
-		/* Small delay to allow TCP/TLS resources to be released */
-		k_sleep(K_MSEC(100));
+	if (!atomic_get(&network_ready)) {
+		LOG_INF("[%s] Network lost, aborting request", t->cfg->name);
+		target_close(t);
+		/* Says nothing about the server, a trial request is made again */
+		net_breaker_abort(&t->breaker);
+		return;
+	}
+
+	if (now >= t->deadline) {
+		LOG_ERR("[%s] Request timed out after %u ms", t->cfg->name,
+			net_rtt_timeout_ms(&t->rtt));
+		net_rtt_timeout_backoff(&t->rtt);
+		target_finish(t, true);
+		return;
+	}
+
+	/* A failed attempt while connecting is handled by the connector, which
+	 * then tries the other address family
+	 */
+	if (t->state != HTTPS_TARGET_CONNECTING && (revents & (ZSOCK_POLLERR | ZSOCK_POLLNVAL))) {
+		LOG_ERR("[%s] Socket error, revents 0x%x", t->cfg->name, revents);
+		target_finish(t, true);
+		return;
+	}
+
+	switch (t->state) {
+	case HTTPS_TARGET_CONNECTING:
+		target_connecting(t, fds, nfds);
+		break;
+	case HTTPS_TARGET_SENDING:
+		if (revents & ZSOCK_POLLOUT) {
+			target_send(t);
+		}
+		break;
+	case HTTPS_TARGET_RECEIVING:
+		if (revents & (ZSOCK_POLLIN | ZSOCK_POLLHUP)) {
+			target_recv(t);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/* Milliseconds until the earliest target deadline or scheduled start, -1 when idle */
+static int next_poll_timeout(int64_t now)
+{
+	int64_t next = INT64_MAX;
+
+	for (size_t i = 0; i < HTTPS_TARGET_COUNT; i++) {
+		struct https_target *t = &targets[i];
+
+		if (t->state == HTTPS_TARGET_CONNECTING && he_conn_timeout_ms(&t->he) >= 0) {
+			next = MIN(next, MIN(t->deadline, now + he_conn_timeout_ms(&t->he)));
+		} else if (t->state != HTTPS_TARGET_IDLE) {
+			next = MIN(next, t->deadline);
+		} else if (atomic_get(&network_ready)) {
+			next = MIN(next, t->next_run);
+		}
 	}
-	if (res) {
-		freeaddrinfo(res);
+
+	if (next == INT64_MAX) {
+		return -1;
 	}
+
+	return (int)CLAMP(next - now, 0, INT_MAX);
 }
 
 static void https_client_thread(void *arg1, void *arg2, void *arg3)
@@ -307,72 +506,163 @@ static void https_client_thread(void *arg1, void *arg2, void *arg3)
 	ARG_UNUSED(arg2);
 	ARG_UNUSED(arg3);
 
-	uint32_t http_request_count = 1;
-	int cert_provisioned = 0;
+	struct zsock_pollfd fds[HTTPS_POLL_FDS];
+	struct https_target *fd_owner[HTTPS_POLL_FDS];
+	bool cert_provisioned = false;
+	zvfs_eventfd_t val;
+	int64_t now;
+	int nfds;
+	int ret;
 
-	LOG_INF("HTTPS client thread started");
+	LOG_INF("HTTPS client thread started, %zu target(s)", HTTPS_TARGET_COUNT);
 
 	while (https_client_running) {
-		/* Wait for network connection */
-		k_sem_take(&https_thread_sem, K_FOREVER);
+		nfds = 0;
+		fds[nfds].fd = wake_fd;
+		fds[nfds].events = ZSOCK_POLLIN;
+		fd_owner[nfds++] = NULL;
 
-		if (!https_client_running) {
-			break;
+		for (size_t i = 0; i < HTTPS_TARGET_COUNT; i++) {
+			struct https_target *t = &targets[i];
+
+			if (t->state == HTTPS_TARGET_CONNECTING) {
+				int n = he_conn_pollfds(&t->he, &fds[nfds], HTTPS_POLL_FDS - nfds);
+
+				while (n-- > 0) {
+					fd_owner[nfds++] = t;
+				}
+				continue;
+			}
+
+			if (t->fd < 0) {
+				continue;
+			}
+
+			fds[nfds].fd = t->fd;
+			fds[nfds].events = (t->state == HTTPS_TARGET_RECEIVING) ? ZSOCK_POLLIN
+										: ZSOCK_POLLOUT;
+			fd_owner[nfds++] = t;
+		}
+
+		ret = zsock_poll(fds, nfds, next_poll_timeout(k_uptime_get()));
+		if (ret < 0) {
+			LOG_ERR("zsock_poll() failed, err %d", errno);
+			k_sleep(K_SECONDS(1));
+			continue;
+		}
+
+		if (fds[0].revents & ZSOCK_POLLIN) {
+			(void)zvfs_eventfd_read(wake_fd, &val);
 		}
 
 		/* Provision certificates once when first connected */
-		if (!cert_provisioned) {
+		if (!cert_provisioned && atomic_get(&network_ready)) {
 			int err = cert_provision();
+
 			if (err) {
 				LOG_ERR("Certificate provisioning failed: %d", err);
-				network_ready = false;
+				atomic_clear(&network_ready);
 				continue;
 			}
-			cert_provisioned = 1;
+			cert_provisioned = true;
 			LOG_INF("Certificate provisioned successfully");
 		}
 
-		network_ready = true;
-		LOG_INF("Network ready, sending HTTPS requests every %d seconds",
-			HTTPS_REQUEST_INTERVAL_SEC);
+		now = k_uptime_get();
 
-		k_sleep(K_SECONDS(3));
-		while (https_client_running && network_ready) {
-			send_http_request();
-			LOG_INF("HTTP request count: %d", http_request_count++);
+		for (size_t i = 0; i < HTTPS_TARGET_COUNT; i++) {
+			struct https_target *t = &targets[i];
+			short revents = 0;
 
-			/* Sleep for the configured interval */
-			k_sleep(K_SECONDS(HTTPS_REQUEST_INTERVAL_SEC));
-		}
+			for (int j = 1; j < nfds; j++) {
+				if (fd_owner[j] == t) {
+					revents = fds[j].revents;
+					break;
+				}
+			}
 
-		LOG_INF("Network disconnected or client stopped");
+			target_process(t, fds, nfds, revents, now);
+		}
 	}
 
 	LOG_INF("HTTPS client thread exiting");
 }
 
 K_THREAD_DEFINE(https_client_tid, CONFIG_HTTPS_CLIENT_STACK_SIZE, https_client_thread, NULL, NULL,
-		NULL, CONFIG_HTTPS_CLIENT_THREAD_PRIORITY, 0, 0);
+		NULL, CONFIG_HTTPS_CLIENT_THREAD_PRIORITY, 0, SYS_FOREVER_MS);
 
-int https_client_init(void)
+static void on_network_change(bool connected)
 {
-	LOG_INF("HTTPS client initialized");
-	https_client_running = true;
-	return 0;
-}
-
-void https_client_notify_connected(void)
-{
-	if (https_client_running) {
+	if (connected) {
 		LOG_INF("Network connected, notifying HTTPS client");
-		network_ready = true;
-		/* Only give semaphore if it's not already taken */
-		k_sem_give(&https_thread_sem);
+
+		/* Start every target right away, then on its own interval */
+		for (size_t i = 0; i < HTTPS_TARGET_COUNT; i++) {
+			targets[i].next_run = k_uptime_get();
+		}
+
+		atomic_set(&network_ready, 1);
+	} else {
+		LOG_INF("Network disconnected, pausing HTTPS client");
+		atomic_clear(&network_ready);
 	}
+
+	https_client_wake();
 }
 
-void https_client_notify_disconnected(void)
+NET_EVENTS_SUB_DEFINE(https_client_sub, on_network_change);
+
+int https_client_init(void)
 {
-	LOG_INF("Network disconnected, pausing HTTPS client");
-	network_ready = false;
+	int len;
+
+	wake_fd = zvfs_eventfd(0, ZVFS_EFD_NONBLOCK);
+	if (wake_fd < 0) {
+		LOG_ERR("Failed to create eventfd, err %d", errno);
+		return -errno;
+	}
+
+	for (size_t i = 0; i < HTTPS_TARGET_COUNT; i++) {
+		struct https_target *t = &targets[i];
+
+		t->cfg = &target_cfgs[i];
+		t->fd = -1;
+		t->state = HTTPS_TARGET_IDLE;
+
+		t->he.hostname = t->cfg->hostname;
+		t->he.port = HTTPS_PORT;
+		t->he.type = IS_ENABLED(CONFIG_SAMPLE_TFM_MBEDTLS) ? (SOCK_STREAM | SOCK_NATIVE_TLS)
+								  : SOCK_STREAM;
+		t->he.proto = IPPROTO_TLS_1_2;
+		t->he.setup = target_socket_setup;
+		t->he.wake = target_wake;
+		t->he.user_data = t;
+
+		/* Start conservatively at the configured timeout until RTTs are measured */
+		net_rtt_init(&t->rtt, t->cfg->timeout_ms, CONFIG_HTTPS_REQUEST_MIN_TIMEOUT_MS,
+			     t->cfg->timeout_ms);
+		net_backoff_init(&t->retry, CONFIG_HTTPS_RETRY_BASE_MS,
+				 t->cfg->interval_sec * MSEC_PER_SEC);
+		net_breaker_init(&t->breaker, CONFIG_HTTPS_CLIENT_BREAKER_THRESHOLD,
+				 CONFIG_HTTPS_CLIENT_BREAKER_OPEN_SEC * MSEC_PER_SEC);
+
+		len = snprintk(t->req, sizeof(t->req), HTTP_REQ_FMT, t->cfg->method, t->cfg->path,
+			       t->cfg->hostname, HTTPS_PORT);
+		if ((len < 0) || (len >= sizeof(t->req))) {
+			LOG_ERR("[%s] Request buffer too small", t->cfg->name);
+			return -EMSGSIZE;
+		}
+		t->req_len = len;
+
+		LOG_INF("[%s] %s https://%s%s every %u s, timeout up to %u ms", t->cfg->name,
+			t->cfg->method, t->cfg->hostname, t->cfg->path, t->cfg->interval_sec,
+			t->cfg->timeout_ms);
+	}
+
+	https_client_running = true;
+	k_thread_start(https_client_tid);
+	net_events_subscribe(&https_client_sub);
+
+	LOG_INF("HTTPS client initialized");
+	return 0;
 }
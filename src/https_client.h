@@ -10,25 +10,10 @@
 /**
  * @brief Initialize the HTTPS client
  *
+ * Requests are sent while network connectivity is up, paused while it is lost.
+ *
  * @return 0 on success, negative error code on failure
  */
 int https_client_init(void);
 
-/**
- * @brief Notify HTTPS client that network connection is established
- *
- * This function should be called when the device successfully connects
- * to the network. It will trigger the HTTPS client to start sending
- * periodic requests.
- */
-void https_client_notify_connected(void);
-
-/**
- * @brief Notify HTTPS client that network connection is lost
- *
- * This function should be called when the device loses network connectivity.
- * It will pause the HTTPS client from sending requests.
- */
-void https_client_notify_disconnected(void);
-
 #endif /* HTTPS_CLIENT_H_ */
@@ -6,15 +6,10 @@
 
 #include <zephyr/kernel.h>
 #include <stdio.h>
-#include <zephyr/net/conn_mgr_connectivity.h>
-#include <zephyr/net/conn_mgr_monitor.h>
-#include <zephyr/net/net_mgmt.h>
 #include <zephyr/net/wifi.h>
 #include <zephyr/net/wifi_mgmt.h>
-#include <zephyr/net/wifi_credentials.h>
 #include <memfault/metrics/metrics.h>
 #include <memfault/ports/zephyr/http.h>
-#include <memfault/core/data_packetizer.h>
 #include <memfault/core/log.h>
 #include <memfault/core/trace_event.h>
 #include <memfault/panics/coredump.h>
@@ -25,14 +20,18 @@
 #include <zephyr/sys/util.h>
 #include <zephyr/dfu/mcuboot.h>
 
-#include "mflt_ota_triggers.h"
+#include "boot_timeline.h"
+#include "diag_exec.h"
+#include "mflt_drain.h"
+#include "mflt_upload_sched.h"
+#include "net_events.h"
+#include "wifi_conn.h"
 
 #include <zephyr/logging/log.h>
 #include <zephyr/logging/log_ctrl.h>
 
 #if CONFIG_MEMFAULT_NCS_STACK_METRICS
 #include <memfault_ncs_metrics.h>
-#include "mflt_stack_metrics.h"
 #endif
 
 #ifdef CONFIG_BLE_PROV_ENABLED
@@ -45,6 +44,30 @@
 
 #ifdef CONFIG_MQTT_CLIENT_ENABLED
 #include "mqtt_client.h"
+#include "mqtt_echo_monitor.h"
+#endif
+
+#ifdef CONFIG_MQTT_BATCH
+#include "mqtt_batch.h"
+#endif
+
+#ifdef CONFIG_MFLT_MQTT_CHUNKS
+#include "mflt_mqtt_chunks.h"
+#endif
+
+#ifdef CONFIG_MFLT_EVENT_STORAGE_NV
+#include "mflt_event_storage.h"
+#endif
+
+#ifdef CONFIG_MFLT_DICT_LOG
+#include "mflt_dict_log.h"
+#endif
+
+/* Also without CONFIG_MFLT_FLIGHT_REC, for the trace event macros */
+#include "mflt_flight_rec.h"
+
+#ifdef CONFIG_MFLT_COREDUMP_LZ
+#include "mflt_coredump_lz.h"
 #endif
 
 #ifdef CONFIG_NRF70_FW_STATS_CDR_ENABLED
@@ -53,24 +76,13 @@
 
 LOG_MODULE_REGISTER(memfault_sample, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
 
-/* Macros used to subscribe to specific Zephyr NET management events. */
-#define L4_EVENT_MASK         (NET_EVENT_L4_CONNECTED | NET_EVENT_L4_DISCONNECTED)
-#define CONN_LAYER_EVENT_MASK (NET_EVENT_CONN_IF_FATAL_ERROR)
-
 #define LONG_PRESS_THRESHOLD_MS 3000
 
 static K_SEM_DEFINE(net_conn_sem, 0, 1);
-static bool wifi_connected = false;
-static void reconnect_work_handler(struct k_work *work);
-static K_WORK_DELAYABLE_DEFINE(reconnect_work, reconnect_work_handler);
 
 static int64_t button_press_ts_btn1;
 static int64_t button_press_ts_btn2;
 
-/* Zephyr NET management event callback structures. */
-static struct net_mgmt_event_callback l4_cb;
-static struct net_mgmt_event_callback conn_cb;
-
 /* Recursive Fibonacci calculation used to trigger stack overflow. */
 static int fib(int n)
 {
@@ -90,6 +102,46 @@ void memfault_metrics_heartbeat_collect_data(void)
 
 	/* Append custom Wi-Fi metrics */
 	mflt_wifi_metrics_collect();
+
+	/* Wi-Fi connection attempts and time spent reconnecting */
+	wifi_conn_collect();
+
+	/* Connectivity event delivery latency */
+	net_events_collect();
+
+	/* Startup phases reached since the last heartbeat */
+	boot_timeline_collect();
+
+	/* Diagnostic action queue latency and run time */
+	diag_exec_collect();
+
+	/* Memfault upload volume, timing and backlog of the elapsed interval */
+	mflt_drain_collect();
+
+#ifdef CONFIG_MFLT_EVENT_STORAGE_NV
+	/* Flash event storage depth, write amplification and drain rate */
+	mflt_event_storage_collect();
+#endif
+
+#ifdef CONFIG_MFLT_DICT_LOG
+	/* Dictionary log records captured and dropped */
+	mflt_dict_log_collect();
+#endif
+
+#ifdef CONFIG_MFLT_FLIGHT_REC
+	/* Incidents reported and log windows captured */
+	mflt_flight_rec_collect();
+#endif
+
+#ifdef CONFIG_MFLT_COREDUMP_LZ
+	/* Size of the coredump saved before this boot */
+	mflt_coredump_lz_collect();
+#endif
+
+#ifdef CONFIG_MQTT_CLIENT_ENABLED
+	/* MQTT echo round-trip, loss and ordering of the elapsed interval */
+	mqtt_echo_monitor_collect();
+#endif
 }
 
 /* Handle button presses and trigger faults that can be captured and sent to
@@ -97,6 +149,8 @@ void memfault_metrics_heartbeat_collect_data(void)
  * Only button 1 is available on Thingy:91, the rest are available on nRF9160 DK.
  *	Button 1: Trigger stack overflow.
  *	Button 2: Trigger NULL-pointer dereference.
+ * Short presses only queue diagnostic actions, they run on the executor
+ * workqueue and not in this callback.
  */
 static void button_handler(uint32_t button_states, uint32_t has_changed)
 {
@@ -114,20 +168,12 @@ static void button_handler(uint32_t button_states, uint32_t has_changed)
 			fib(10000);
 		} else {
 			LOG_INF("Button 1 short press detected, triggering Memfault heartbeat");
-			if (wifi_connected) {
-				memfault_metrics_heartbeat_debug_trigger();
+			if (net_events_connected()) {
+				(void)diag_exec_submit(DIAG_ACTION_HEARTBEAT, DIAG_SOURCE_BUTTON);
 #ifdef CONFIG_NRF70_FW_STATS_CDR_ENABLED
-				int cdr_err = mflt_nrf70_fw_stats_cdr_collect();
-				if (cdr_err) {
-					LOG_WRN("nRF70 FW stats CDR collection failed: %d",
-						cdr_err);
-				} else {
-					LOG_INF("nRF70 FW stats CDR collected (%zu bytes), "
-						"uploading...",
-						mflt_nrf70_fw_stats_cdr_get_size());
-				}
+				(void)diag_exec_submit(DIAG_ACTION_FW_STATS, DIAG_SOURCE_BUTTON);
 #endif
-				memfault_zephyr_port_post_data();
+				(void)diag_exec_submit(DIAG_ACTION_UPLOAD, DIAG_SOURCE_BUTTON);
 			} else {
 				LOG_WRN("WiFi not connected, cannot collect metrics");
 			}
@@ -151,7 +197,7 @@ static void button_handler(uint32_t button_states, uint32_t has_changed)
 			ARG_UNUSED(i);
 		} else {
 			LOG_INF("Button 2 short press detected, scheduling Memfault OTA check");
-			mflt_ota_triggers_notify_button();
+			(void)diag_exec_submit(DIAG_ACTION_OTA_CHECK, DIAG_SOURCE_BUTTON);
 		}
 	}
 
@@ -163,14 +209,24 @@ static void button_handler(uint32_t button_states, uint32_t has_changed)
 		} else {
 			LOG_INF("switch_1_toggle_count incremented");
 		}
+#ifdef CONFIG_MQTT_BATCH
+		(void)mqtt_batch_add_int("switch_1", 1);
+#endif
 	}
 
 	if (buttons_pressed & DK_BTN4_MSK) {
 		/* DK_BTN4_MSK is Switch 2 on nRF9160 DK. */
-		MEMFAULT_TRACE_EVENT_WITH_LOG(switch_2_toggled, "Switch state: %d",
-					      buttons_pressed & DK_BTN4_MSK ? 1 : 0);
+		MFLT_TRACE_EVENT_WITH_LOG(switch_2_toggled, "Switch state: %d",
+					  buttons_pressed & DK_BTN4_MSK ? 1 : 0);
 		LOG_INF("switch_2_toggled event has been traced, button state: %d",
 			buttons_pressed & DK_BTN4_MSK ? 1 : 0);
+#ifdef CONFIG_MQTT_CLIENT_ENABLED
+		/* Queued while the broker is unreachable */
+		(void)app_mqtt_client_publish("switch_2_toggled");
+#endif
+#ifdef CONFIG_MQTT_BATCH
+		(void)mqtt_batch_add_int("switch_2", buttons_pressed & DK_BTN4_MSK ? 1 : 0);
+#endif
 	}
 }
 
@@ -197,130 +253,38 @@ static void on_connect(void)
 	/* Trigger collection of heartbeat data. */
 	memfault_metrics_heartbeat_debug_trigger();
 
-	/* Flush the log ring buffer into the Memfault data recorder. */
-	// memfault_log_trigger_collection();
-	/* Check if there is any data available to be sent. */
-	if (!memfault_packetizer_data_available()) {
-		LOG_DBG("There was no data to be sent");
-		return;
-	}
-
-	LOG_DBG("Sending stored data...");
+	/* Logs are not flushed here: they are frozen around incidents by the
+	 * flight recorder or, with CONFIG_MFLT_UPLOAD_LOGS, by the periodic upload.
+	 */
 
-	/* Send the data that has been captured to the memfault cloud.
-	 * This will also happen periodically, with an interval that can be configured using
-	 * CONFIG_MEMFAULT_HTTP_PERIODIC_UPLOAD_INTERVAL_SECS.
+	/* Send the data that has been captured to the memfault cloud, merged with
+	 * other requests and deferred while the link is poor. This also happens
+	 * periodically every CONFIG_MFLT_UPLOAD_INTERVAL_SEC.
 	 */
-	memfault_zephyr_port_post_data();
+	mflt_upload_sched_request(MFLT_UPLOAD_TRIGGER_CONNECT, false);
 }
 
-static void l4_event_handler(struct net_mgmt_event_callback *cb, uint64_t mgmt_event,
-			     struct net_if *iface)
+static void on_network_change(bool connected)
 {
-	switch (mgmt_event) {
-	case NET_EVENT_L4_CONNECTED:
-		LOG_INF("Network connectivity established");
-		wifi_connected = true;
-
-		/* Signal connectivity state change to Memfault */
-		memfault_metrics_connectivity_connected_state_change(
-			kMemfaultMetricsConnectivityState_Connected);
-
-		/* Initialize stack metrics monitoring */
-#if CONFIG_MEMFAULT_NCS_STACK_METRICS
-		mflt_stack_metrics_init();
-		LOG_INF("Stack metrics monitoring initialized");
-#endif
-
-		/* Update BLE advertisement with WiFi connected status */
-#ifdef CONFIG_BLE_PROV_ENABLED
-		ble_prov_update_wifi_status(true);
-#endif
-
-		/* Notify HTTPS client that network is connected */
-#ifdef CONFIG_HTTPS_CLIENT_ENABLED
-		https_client_notify_connected();
-#endif
-
-		/* Notify MQTT client that network is connected */
-#ifdef CONFIG_MQTT_CLIENT_ENABLED
-		app_mqtt_client_notify_connected();
-#endif
+	/* Signal connectivity state change to Memfault */
+	memfault_metrics_connectivity_connected_state_change(
+		connected ? kMemfaultMetricsConnectivityState_Connected
+			  : kMemfaultMetricsConnectivityState_ConnectionLost);
 
+	if (connected) {
+		boot_timeline_mark(BOOT_PHASE_NET_CONNECTED);
 		k_sem_give(&net_conn_sem);
-		mflt_ota_triggers_notify_connected();
-		break;
-	case NET_EVENT_L4_DISCONNECTED:
-		LOG_INF("Network connectivity lost");
-		wifi_connected = false;
-
-		/* Signal connectivity state change to Memfault */
-		memfault_metrics_connectivity_connected_state_change(
-			kMemfaultMetricsConnectivityState_ConnectionLost);
-
-		/* Update BLE advertisement with WiFi disconnected status */
-#ifdef CONFIG_BLE_PROV_ENABLED
-		ble_prov_update_wifi_status(false);
-#endif
-
-		/* Notify HTTPS client that network is disconnected */
-#ifdef CONFIG_HTTPS_CLIENT_ENABLED
-		https_client_notify_disconnected();
-#endif
-
-		/* Notify MQTT client that network is disconnected */
-#ifdef CONFIG_MQTT_CLIENT_ENABLED
-		app_mqtt_client_notify_disconnected();
-#endif
-		break;
-	default:
-		LOG_DBG("Unknown event: 0x%016llX", mgmt_event);
-		return;
 	}
 }
 
-static void connectivity_event_handler(struct net_mgmt_event_callback *cb, uint64_t mgmt_event,
-				       struct net_if *iface)
-{
-	switch (mgmt_event) {
-	case NET_EVENT_CONN_IF_FATAL_ERROR:
-		LOG_ERR("Connectivity fatal error, scheduling reconnect");
-		wifi_connected = false;
-#ifdef CONFIG_BLE_PROV_ENABLED
-		ble_prov_update_wifi_status(false);
-#endif
-		k_work_reschedule(&reconnect_work, K_SECONDS(2));
-		break;
-	case NET_EVENT_CONN_IF_TIMEOUT:
-		LOG_WRN("Connectivity timeout, scheduling reconnect");
-		k_work_reschedule(&reconnect_work, K_SECONDS(1));
-		break;
-	default:
-		break;
-	}
-}
-
-static void reconnect_work_handler(struct k_work *work)
-{
-	int err;
-
-	LOG_INF("Retrying network bring-up after connectivity fault");
-	err = conn_mgr_all_if_up(true);
-	if (err) {
-		LOG_ERR("conn_mgr_all_if_up during retry failed: %d", err);
-		return;
-	}
-
-	err = conn_mgr_all_if_connect(true);
-	if (err) {
-		LOG_ERR("conn_mgr_all_if_connect during retry failed: %d", err);
-	}
-}
+NET_EVENTS_SUB_DEFINE(main_sub, on_network_change);
 
 int main(void)
 {
 	int err;
 
+	boot_timeline_mark(BOOT_PHASE_MAIN);
+
 	LOG_INF("Memfault sample has started! Version: %s", CONFIG_MEMFAULT_NCS_FW_VERSION);
 
 	if (!boot_is_img_confirmed()) {
@@ -332,22 +296,34 @@ int main(void)
 		}
 	}
 
+#ifdef CONFIG_MFLT_DICT_LOG
+	/* Debug logs are kept by the dictionary log capture, which stores them in a
+	 * fraction of the space, so the text capture only keeps info and higher
+	 */
+	memfault_log_set_min_save_level(kMemfaultPlatformLogLevel_Info);
+#else
 	/* Lower the Memfault log capture threshold so debug logs are stored & uploaded, which need
 	 * set CONFIG_MEMFAULT_LOGGING_RAM_SIZE bigger enough*/
 	memfault_log_set_min_save_level(kMemfaultPlatformLogLevel_Debug);
+#endif
+
+	/* Button, shell and MQTT diagnostic actions run on the executor workqueue */
+	diag_exec_init();
 
 	err = dk_buttons_init(button_handler);
 	if (err) {
 		LOG_ERR("dk_buttons_init, error: %d", err);
 	}
 
-	/* Setup handler for Zephyr NET Connection Manager events. */
-	net_mgmt_init_event_callback(&l4_cb, l4_event_handler, L4_EVENT_MASK);
-	net_mgmt_add_event_callback(&l4_cb);
+	/* Connectivity changes reach the modules through the subscriber registry */
+	net_events_init();
+	net_events_subscribe(&main_sub);
 
-	/* Setup handler for Zephyr NET Connection Manager Connectivity layer. */
-	net_mgmt_init_event_callback(&conn_cb, connectivity_event_handler, CONN_LAYER_EVENT_MASK);
-	net_mgmt_add_event_callback(&conn_cb);
+	/* All Wi-Fi connection attempts go through the connectivity manager */
+	wifi_conn_init();
+
+	/* All Memfault uploads go through the scheduler workqueue */
+	mflt_upload_sched_init();
 
 	/* Signal to Memfault that we're starting connectivity (attempting to connect) */
 	memfault_metrics_connectivity_connected_state_change(
@@ -369,6 +345,14 @@ int main(void)
 	}
 #endif
 
+#ifdef CONFIG_MFLT_MQTT_CHUNKS
+	/* Memfault uploads share the MQTT broker connection */
+	err = mflt_mqtt_chunks_init();
+	if (err) {
+		LOG_ERR("Memfault MQTT chunk transport initialization failed: %d", err);
+	}
+#endif
+
 #ifdef CONFIG_NRF70_FW_STATS_CDR_ENABLED
 	/* Initialize nRF70 FW stats CDR module */
 	err = mflt_nrf70_fw_stats_cdr_init();
@@ -379,55 +363,30 @@ int main(void)
 	}
 #endif
 
-#ifdef CONFIG_BLE_PROV_ENABLED
-	/* Sleep 1 second to allow initialization of wifi driver. */
-	k_sleep(K_SECONDS(1));
-
-	/* Bring up network interface first */
-	err = conn_mgr_all_if_up(true);
-	if (err) {
-		LOG_ERR("conn_mgr_all_if_up, error: %d", err);
-	}
+	/* Connect with the stored WiFi credentials. Without credentials the
+	 * connectivity manager waits until they are provisioned over BLE. The
+	 * first attempt is made on the system workqueue once the supplicant is
+	 * ready, so Bluetooth is brought up below in the meantime.
+	 */
+	LOG_INF("Bringing network interface up and connecting to the network");
+	wifi_conn_start();
 
+#ifdef CONFIG_BLE_PROV_ENABLED
 	/* Initialize BLE provisioning so re-provisioning is always available */
 	err = ble_prov_init();
 	if (err) {
 		LOG_ERR("BLE provisioning initialization failed: %d", err);
 	} else {
+		boot_timeline_mark(BOOT_PHASE_BLE_READY);
 		LOG_INF("BLE provisioning initialized successfully");
 	}
-
-	/* Check if WiFi credentials are stored before attempting connection */
-	if (wifi_credentials_is_empty()) {
-		LOG_INF("No stored WiFi credentials found");
-		LOG_INF("Please provision WiFi credentials using BLE");
-	} else {
-		LOG_INF("Attempting to connect to stored WiFi network");
-
-		/* Try to connect using stored WiFi credentials */
-		err = conn_mgr_all_if_connect(true);
-		if (err) {
-			LOG_ERR("WiFi connection request failed: %d", err);
-		}
-	}
-#else
-	/* Connecting to the configured connectivity layer.
-	 * Wi-Fi or LTE depending on the board that the sample was built for.
-	 */
-	LOG_INF("Bringing network interface up and connecting to the network");
-
-	err = conn_mgr_all_if_connect(true);
-	if (err) {
-		__ASSERT(false, "conn_mgr_all_if_connect, error: %d", err);
-		return err;
-	}
 #endif
 
 	/* Performing in an infinite loop to be resilient against
 	 * re-connect bursts directly after boot, e.g. when connected
 	 * to a roaming network or via weak signal. Note that
 	 * Memfault data will be uploaded periodically every
-	 * CONFIG_MEMFAULT_HTTP_PERIODIC_UPLOAD_INTERVAL_SECS.
+	 * CONFIG_MFLT_UPLOAD_INTERVAL_SEC.
 	 * We post data here so as soon as a connection is available
 	 * the latest data will be pushed to Memfault.
 	 */
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Shared budget of custom data recordings.
+ *
+ * Memfault accepts one CDR per device per 24 hours unless Developer Mode is
+ * enabled for the device, further CDRs are dropped by the server. The nRF70
+ * FW stats, the dictionary log and the flight recorder take from one budget,
+ * so together they stay within the quota and a CDR that would be dropped is
+ * not collected in the first place.
+ *
+ * A period starts with the first CDR taken in it. The budget is kept in a
+ * no-init section: a warm reset does not hand out a fresh budget, the period
+ * of a spent budget restarts at boot instead, as the time spent in reset is
+ * unknown. A power cycle clears it.
+ */
+
+#include "mflt_cdr_budget.h"
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(mflt_cdr_budget, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define BUDGET_MAGIC 0x42524443 /* "CDRB" */
+#define PERIOD_MS ((int64_t)CONFIG_MFLT_CDR_BUDGET_PERIOD_SEC * MSEC_PER_SEC)
+
+struct cdr_budget {
+	uint32_t magic;
+	/* CDRs taken in the current period */
+	uint32_t spent;
+	/* Uptime at the start of the current period */
+	int64_t period_start;
+};
+
+static __noinit struct cdr_budget budget;
+static struct k_spinlock lock;
+static bool checked;
+
+/* Called with the lock held */
+static void budget_update(int64_t now)
+{
+	if (!checked) {
+		checked = true;
+
+		if (budget.magic != BUDGET_MAGIC || budget.spent > CONFIG_MFLT_CDR_BUDGET_COUNT) {
+			budget = (struct cdr_budget){.magic = BUDGET_MAGIC};
+		} else {
+			/* Kept over a warm reset */
+			budget.period_start = 0;
+		}
+	}
+
+	if (budget.spent > 0 && now - budget.period_start >= PERIOD_MS) {
+		budget.spent = 0;
+	}
+}
+
+int mflt_cdr_budget_take(const char *reason)
+{
+	int64_t now = k_uptime_get();
+	int64_t next_ms = 0;
+	k_spinlock_key_t key;
+	bool spent;
+
+	key = k_spin_lock(&lock);
+
+	budget_update(now);
+
+	spent = (budget.spent >= CONFIG_MFLT_CDR_BUDGET_COUNT);
+	if (spent) {
+		next_ms = budget.period_start + PERIOD_MS - now;
+	} else {
+		if (budget.spent == 0) {
+			budget.period_start = now;
+		}
+		budget.spent++;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	if (spent) {
+		LOG_INF("CDR budget spent, %s not collected, next in %u s", reason,
+			(uint32_t)(next_ms / MSEC_PER_SEC));
+		return -EAGAIN;
+	}
+
+	LOG_DBG("CDR budget taken by %s", reason);
+	return 0;
+}
+
+void mflt_cdr_budget_give_back(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (budget.spent > 0) {
+		budget.spent--;
+	}
+
+	k_spin_unlock(&lock, key);
+}
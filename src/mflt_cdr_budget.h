@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Take one custom data recording from the shared budget.
+ *
+ * Every CDR source of the sample takes from the budget before it collects,
+ * at most CONFIG_MFLT_CDR_BUDGET_COUNT per CONFIG_MFLT_CDR_BUDGET_PERIOD_SEC
+ * are made. May be called from any thread.
+ *
+ * @param reason CDR collection reason, for the log.
+ *
+ * @return 0 on success, -EAGAIN if the budget of the period is spent
+ */
+int mflt_cdr_budget_take(const char *reason);
+
+/**
+ * @brief Return a recording taken with mflt_cdr_budget_take() that was not collected.
+ */
+void mflt_cdr_budget_give_back(void);
+
+#ifdef __cplusplus
+}
+#endif
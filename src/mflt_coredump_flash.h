@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Fault handler flash access of the compressed coredump storage
+ * (mflt_coredump_lz.c). Interrupts are locked and drivers may be in the
+ * middle of an operation, so the backends drive the hardware directly and
+ * only ever busy-wait.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_MFLT_COREDUMP_LZ_EXTERNAL
+/* MX25R64, slots are erased ahead in thread context */
+#define MFLT_COREDUMP_PARTITION	      mflt_coredump_storage
+#define MFLT_COREDUMP_FLASH_PRE_ERASED 1
+/* Single slot on the internal flash while the external flash is in use */
+#define MFLT_COREDUMP_FALLBACK_PARTITION memfault_storage
+#else
+/* nRF5340 internal flash, pages are erased while saving */
+#define MFLT_COREDUMP_PARTITION	      memfault_storage
+#define MFLT_COREDUMP_FLASH_PRE_ERASED 0
+#endif
+
+/* Erase unit of both flashes */
+#define MFLT_COREDUMP_FLASH_SECTOR_SIZE 4096
+
+/**
+ * @brief Prepare the memfault_storage partition for a save into a slot.
+ *
+ * Pages are erased as the save reaches them.
+ *
+ * @param slot_offset Partition offset of the slot.
+ *
+ * @return true on success
+ */
+bool mflt_coredump_flash_int_begin(uint32_t slot_offset);
+
+/**
+ * @brief Program words at a memfault_storage partition offset.
+ *
+ * The target must be erased or not yet reached by the save. The source must
+ * be in RAM.
+ *
+ * @return true on success
+ */
+bool mflt_coredump_flash_int_program(uint32_t offset, const uint32_t *words, size_t count);
+
+#ifdef CONFIG_MFLT_COREDUMP_LZ_EXTERNAL
+/**
+ * @brief Check that the SPI NOR driver is between commands.
+ *
+ * Taking over SPIM4 in the middle of a command of the driver could leave a
+ * page of another partition partly programmed.
+ *
+ * @return true if the fault handler may take over the external flash
+ */
+bool mflt_coredump_flash_ext_idle(void);
+
+/**
+ * @brief Prepare the mflt_coredump_storage partition for a save into a slot.
+ *
+ * Only call if mflt_coredump_flash_ext_idle() returned true.
+ *
+ * @param slot_offset Partition offset of the slot, erased ahead.
+ *
+ * @return true on success
+ */
+bool mflt_coredump_flash_ext_begin(uint32_t slot_offset);
+
+/**
+ * @brief Program words at a mflt_coredump_storage partition offset.
+ *
+ * The target must be erased. The source must be in RAM.
+ *
+ * @return true on success
+ */
+bool mflt_coredump_flash_ext_program(uint32_t offset, const uint32_t *words, size_t count);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Coredump flash backend on the mflt_coredump_storage partition of the
+ * MX25R64.
+ *
+ * On the nRF7002 DK the MX25R64 is on SPIM4, the QSPI peripheral drives
+ * the nRF7002. The SPI NOR driver needs interrupts, so the fault handler
+ * drives SPIM4 and the chip select through the HAL and polls for
+ * completion. Slots are erased ahead in thread context, the save only
+ * programs pages.
+ *
+ * The driver asserts the chip select for the whole of a command. A fault in
+ * the middle of one leaves it asserted, as interrupts are locked the driver
+ * never completes it, and the save goes to the internal flash instead.
+ */
+
+#include "mflt_coredump_flash.h"
+
+#include <soc.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <hal/nrf_gpio.h>
+#include <hal/nrf_spim.h>
+
+#define FLASH_NODE DT_NODELABEL(mx25r64)
+#define SPIM	   ((NRF_SPIM_Type *)DT_REG_ADDR(DT_BUS(FLASH_NODE)))
+#define CS_PIN	   NRF_DT_GPIOS_TO_PSEL_BY_IDX(DT_BUS(FLASH_NODE), cs_gpios, DT_REG_ADDR(FLASH_NODE))
+
+#define PART_OFFSET FIXED_PARTITION_OFFSET(mflt_coredump_storage)
+
+#define CMD_WREN 0x06
+#define CMD_PP	 0x02
+#define CMD_RDSR 0x05
+#define CMD_RDP	 0xab
+
+#define SR_WIP	   BIT(0)
+#define PAGE_SIZE  256
+#define T_RES1_US  35
+
+/* Longest wait for the flash, a block erase of the driver may be running */
+#define BUSY_TIMEOUT_US (5 * USEC_PER_SEC)
+
+/* SPIM EasyDMA reads RAM only */
+static uint8_t cmd[4];
+static uint8_t status[2];
+
+static bool spim_xfer(const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+{
+	uint32_t waited = 0;
+
+	nrf_spim_tx_buffer_set(SPIM, tx, tx_len);
+	nrf_spim_rx_buffer_set(SPIM, rx, rx_len);
+	nrf_spim_event_clear(SPIM, NRF_SPIM_EVENT_END);
+	nrf_spim_task_trigger(SPIM, NRF_SPIM_TASK_START);
+
+	while (!nrf_spim_event_check(SPIM, NRF_SPIM_EVENT_END)) {
+		if (waited++ > USEC_PER_SEC) {
+			return false;
+		}
+		k_busy_wait(1);
+	}
+
+	nrf_spim_event_clear(SPIM, NRF_SPIM_EVENT_END);
+	return true;
+}
+
+/* Chip select is active low */
+static bool command(const uint8_t *tx, size_t tx_len, const uint8_t *data, size_t data_len,
+		    uint8_t *rx, size_t rx_len)
+{
+	bool ok;
+
+	nrf_gpio_pin_clear(CS_PIN);
+	ok = spim_xfer(tx, tx_len, rx, rx_len);
+	if (ok && data_len > 0) {
+		ok = spim_xfer(data, data_len, NULL, 0);
+	}
+	nrf_gpio_pin_set(CS_PIN);
+
+	return ok;
+}
+
+static bool wait_ready(void)
+{
+	for (uint32_t waited = 0; waited < BUSY_TIMEOUT_US; waited += 10) {
+		cmd[0] = CMD_RDSR;
+		if (!command(cmd, 2, NULL, 0, status, sizeof(status))) {
+			return false;
+		}
+		if (!(status[1] & SR_WIP)) {
+			return true;
+		}
+		k_busy_wait(10);
+	}
+
+	return false;
+}
+
+bool mflt_coredump_flash_ext_idle(void)
+{
+	/* Low while the driver runs a command */
+	return nrf_gpio_pin_out_read(CS_PIN) != 0;
+}
+
+bool mflt_coredump_flash_ext_begin(uint32_t slot_offset)
+{
+	ARG_UNUSED(slot_offset);
+
+	nrf_spim_int_disable(SPIM, NRF_SPIM_ALL_INTS_MASK);
+	nrf_spim_enable(SPIM);
+
+	/* The driver may have put the flash into deep power-down */
+	cmd[0] = CMD_RDP;
+	if (!command(cmd, 1, NULL, 0, NULL, 0)) {
+		return false;
+	}
+	k_busy_wait(T_RES1_US);
+
+	return wait_ready();
+}
+
+bool mflt_coredump_flash_ext_program(uint32_t offset, const uint32_t *words, size_t count)
+{
+	const uint8_t *data = (const uint8_t *)words;
+	uint32_t addr = PART_OFFSET + offset;
+	size_t len = count * sizeof(uint32_t);
+
+	while (len > 0) {
+		/* Page program wraps at page boundaries */
+		size_t n = MIN(len, PAGE_SIZE - addr % PAGE_SIZE);
+
+		cmd[0] = CMD_WREN;
+		if (!command(cmd, 1, NULL, 0, NULL, 0)) {
+			return false;
+		}
+
+		cmd[0] = CMD_PP;
+		cmd[1] = addr >> 16;
+		cmd[2] = addr >> 8;
+		cmd[3] = addr;
+		if (!command(cmd, sizeof(cmd), data, n, NULL, 0) || !wait_ready()) {
+			return false;
+		}
+
+		addr += n;
+		data += n;
+		len -= n;
+	}
+
+	return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Coredump flash backend on the internal memfault_storage partition. The
+ * only backend with CONFIG_MFLT_COREDUMP_LZ_INTERNAL, the fallback of the
+ * external one otherwise.
+ *
+ * nrfx_nvmc busy-waits on the NVMC and needs no interrupts. Pages are
+ * erased as the compressed stream reaches them, so a small coredump
+ * erases little of the partition.
+ */
+
+#include "mflt_coredump_flash.h"
+
+#include <zephyr/storage/flash_map.h>
+#include <nrfx_nvmc.h>
+
+#define PART_ADDR FIXED_PARTITION_OFFSET(memfault_storage)
+
+/* Partition offset up to which the save erased the flash */
+static uint32_t erased_end;
+
+bool mflt_coredump_flash_int_begin(uint32_t slot_offset)
+{
+	/* Drops the previous coredump of the slot at once */
+	if (nrfx_nvmc_page_erase(PART_ADDR + slot_offset) != NRFX_SUCCESS) {
+		return false;
+	}
+
+	erased_end = slot_offset + nrfx_nvmc_flash_page_size_get();
+
+	return true;
+}
+
+bool mflt_coredump_flash_int_program(uint32_t offset, const uint32_t *words, size_t count)
+{
+	uint32_t page = nrfx_nvmc_flash_page_size_get();
+
+	while (erased_end < offset + count * sizeof(uint32_t)) {
+		if (nrfx_nvmc_page_erase(PART_ADDR + erased_end) != NRFX_SUCCESS) {
+			return false;
+		}
+		erased_end += page;
+	}
+
+	nrfx_nvmc_words_write(PART_ADDR + offset, words, count);
+
+	return true;
+}
@@ -0,0 +1,951 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Compressed coredump storage.
+ *
+ * The Memfault SDK writes the coredump sequentially into a virtual storage
+ * of CONFIG_MFLT_COREDUMP_LZ_VIRTUAL_SIZE bytes, several times the flash
+ * available. The writes are compressed on the fly with a byte-aligned LZ77
+ * (fixed 2 KB window, one hash probe per position) and programmed through
+ * a fault-safe backend (mflt_coredump_flash.h). Reads from the packetizer
+ * decompress sequentially, so Memfault receives a regular coredump and
+ * needs no changes.
+ *
+ * Unused stack is filled with 0xaa (CONFIG_INIT_STACKS) and the used part
+ * repeats return addresses and frame layouts, so full thread stacks cost
+ * little flash. A dump that still does not fit is cut after the last
+ * complete coredump block and the total size in the Memfault header is
+ * reduced to match.
+ *
+ * The partition is split into slots, each holding one coredump. On the
+ * external flash free slots are erased ahead, a save takes one and the
+ * oldest coredump is the one the SDK sees until it is uploaded. When no
+ * slot is free the new coredump is not saved. The internal flash has a
+ * single slot, overwritten by every save. With the external flash it is the
+ * fallback slot, taken when the fault interrupted a command of the SPI NOR
+ * driver.
+ *
+ * Stored stream, tokens of:
+ *   0x00-0x7f  n + 1 literal bytes follow
+ *   0x80-0xff  1LLLLDDD DDDDDDDD [E]: match of L + 3 bytes (L 15: + E) at
+ *              distance D + 1
+ */
+
+#include "mflt_coredump_lz.h"
+
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <memfault/core/reboot_tracking.h>
+#include <memfault/metrics/metrics.h>
+#include <memfault/panics/platform/coredump.h>
+
+#include "mflt_coredump_flash.h"
+
+LOG_MODULE_REGISTER(mflt_coredump_lz, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define PART_ID	  FIXED_PARTITION_ID(MFLT_COREDUMP_PARTITION)
+#define PART_SIZE FIXED_PARTITION_SIZE(MFLT_COREDUMP_PARTITION)
+
+#ifdef CONFIG_MFLT_COREDUMP_LZ_SLOTS
+#define SLOT_COUNT CONFIG_MFLT_COREDUMP_LZ_SLOTS
+#else
+#define SLOT_COUNT 1
+#endif
+
+#define SLOT_SIZE ROUND_DOWN(PART_SIZE / SLOT_COUNT, MFLT_COREDUMP_FLASH_SECTOR_SIZE)
+
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+#define FALLBACK_SLOT SLOT_COUNT
+#define FALLBACK_ID   FIXED_PARTITION_ID(MFLT_COREDUMP_FALLBACK_PARTITION)
+#define FALLBACK_SIZE FIXED_PARTITION_SIZE(MFLT_COREDUMP_FALLBACK_PARTITION)
+#define SLOT_TOTAL    (SLOT_COUNT + 1)
+#else
+#define SLOT_TOTAL SLOT_COUNT
+#endif
+
+/* Pause between the sector erases of a slot, for other flash users */
+#define ERASE_PAUSE K_MSEC(10)
+
+#define CD_MAGIC      0x5a4c4443 /* "CDLZ" */
+#define CD_SLOT_READY 0x59444552 /* "REDY" */
+#define CD_VERSION    2
+
+#define CD_FLAG_CUT BIT(0)
+
+/* Room for the Memfault coredump header (magic, version, total_size) */
+#define MFLT_HDR_MAX	       16
+#define MFLT_HDR_TOTAL_OFFSET  8
+
+/* Memfault coredump block header: type, reserved[3], address, length */
+#define BLOCK_HDR_SIZE	       12
+#define BLOCK_LEN_OFFSET       8
+
+/* Start of a slot */
+struct cd_hdr {
+	/* CD_SLOT_READY once erased ahead, 0 once a save started */
+	uint32_t slot_state;
+	/* Programmed last, 0 once uploaded */
+	uint32_t magic;
+	/* Save order */
+	uint32_t seq;
+	uint8_t version;
+	uint8_t flags;
+	uint8_t mflt_hdr_len;
+	uint8_t reserved;
+	/* Bytes written by the SDK */
+	uint32_t raw_size;
+	/* Bytes of them kept, the total size reported to Memfault */
+	uint32_t kept_size;
+	/* Compressed bytes stored */
+	uint32_t stored_size;
+	uint32_t save_ms;
+	uint8_t mflt_hdr[MFLT_HDR_MAX];
+};
+
+#define DATA_OFFSET   sizeof(struct cd_hdr)
+#define DATA_CAPACITY (SLOT_SIZE - DATA_OFFSET)
+
+BUILD_ASSERT(sizeof(struct cd_hdr) % sizeof(uint32_t) == 0);
+BUILD_ASSERT(SLOT_SIZE > DATA_OFFSET);
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+BUILD_ASSERT(FALLBACK_SIZE > DATA_OFFSET);
+#endif
+BUILD_ASSERT(CONFIG_MFLT_COREDUMP_LZ_VIRTUAL_SIZE >= SLOT_SIZE);
+
+#define LZ_RING_SIZE	2048
+#define LZ_RING_MASK	(LZ_RING_SIZE - 1)
+#define LZ_MIN_MATCH	3
+#define LZ_MAX_MATCH	(LZ_MIN_MATCH + 15 + UINT8_MAX)
+#define LZ_MAX_DIST	(LZ_RING_SIZE - LZ_MAX_MATCH)
+#define LZ_MAX_LITERALS 128
+#define LZ_HASH_BITS	10
+
+BUILD_ASSERT(LZ_MAX_DIST <= 2048);
+
+/* Last bytes of the uncompressed stream, the window of both directions */
+static uint8_t ring[LZ_RING_SIZE];
+
+/* Save state, used from the fault handler only */
+static struct {
+	uint32_t start_cycles;
+	uint32_t slot_offset;
+	uint32_t body_start;
+	/* Body bytes written by the SDK */
+	uint32_t raw_pos;
+	/* Last point where the stored stream ends on a block boundary */
+	uint32_t safe_raw;
+	uint32_t safe_stored;
+	/* Block being written */
+	uint8_t blk_hdr[BLOCK_HDR_SIZE];
+	uint8_t blk_hdr_len;
+	uint32_t blk_left;
+	/* Compressor */
+	uint32_t in_pos;
+	uint32_t enc_pos;
+	uint32_t lit_start;
+	uint16_t hash[1 << LZ_HASH_BITS];
+	/* Compressed output, programmed a buffer at a time */
+	uint32_t out_pos;
+	uint32_t out_buf[64];
+	uint32_t capacity;
+	bool fallback;
+	bool overflow;
+	bool flash_err;
+	bool active;
+} enc;
+
+/* Read state, the packetizer reads sequentially */
+static struct {
+	uint32_t raw_pos;
+	uint32_t in_pos;
+	uint16_t lit_left;
+	uint16_t match_left;
+	uint16_t dist;
+	bool ready;
+	/* Stored bytes from cache_pos on */
+	uint32_t cache_pos;
+	uint32_t cache_len;
+	uint8_t cache[64];
+} dec;
+
+/*
+ * Slot table, rebuilt in thread context. The fault handler only reads it,
+ * the header of the visible coredump included, as flash reads need the
+ * driver.
+ */
+static struct {
+	/* Oldest coredump, the one the SDK sees */
+	int visible;
+	struct cd_hdr hdr;
+	/* Newest coredump */
+	int newest;
+	int free_slot;
+	uint32_t next_seq;
+	uint32_t retained;
+	/* Slots to erase ahead */
+	uint32_t dirty;
+} slots = {
+	.visible = -1,
+	.newest = -1,
+	.free_slot = MFLT_COREDUMP_FLASH_PRE_ERASED ? -1 : 0,
+};
+
+static const struct flash_area *fa;
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+static const struct flash_area *fallback_fa;
+#endif
+static K_MUTEX_DEFINE(slots_lock);
+
+/* Newest coredump at boot, reported with the next heartbeat if saved by the previous boot */
+static struct cd_hdr boot_dump;
+static bool boot_dump_found;
+static bool boot_dump_checked;
+
+static void erase_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(erase_work, erase_work_fn);
+
+/* Flash output */
+
+static bool flash_program(uint32_t offset, const uint32_t *words, size_t count)
+{
+#ifdef CONFIG_MFLT_COREDUMP_LZ_EXTERNAL
+	if (!enc.fallback) {
+		return mflt_coredump_flash_ext_program(offset, words, count);
+	}
+#endif
+	return mflt_coredump_flash_int_program(offset, words, count);
+}
+
+static void out_program(uint32_t offset, const uint32_t *words, size_t count)
+{
+	if (!enc.flash_err && !flash_program(enc.slot_offset + offset, words, count)) {
+		enc.flash_err = true;
+		enc.overflow = true;
+	}
+}
+
+static void out_flush(void)
+{
+	size_t used = enc.out_pos % sizeof(enc.out_buf);
+	size_t start = enc.out_pos - used;
+
+	if (used == 0) {
+		return;
+	}
+
+	memset((uint8_t *)enc.out_buf + used, 0xff, sizeof(enc.out_buf) - used);
+	out_program(DATA_OFFSET + start, enc.out_buf, DIV_ROUND_UP(used, sizeof(uint32_t)));
+}
+
+static void out_byte(uint8_t b)
+{
+	if (enc.overflow || enc.out_pos >= enc.capacity) {
+		enc.overflow = true;
+		return;
+	}
+
+	((uint8_t *)enc.out_buf)[enc.out_pos % sizeof(enc.out_buf)] = b;
+	enc.out_pos++;
+
+	if (enc.out_pos % sizeof(enc.out_buf) == 0) {
+		out_program(DATA_OFFSET + enc.out_pos - sizeof(enc.out_buf), enc.out_buf,
+			    ARRAY_SIZE(enc.out_buf));
+	}
+}
+
+/* Compressor */
+
+static uint32_t lz_hash(uint32_t pos)
+{
+	uint32_t v = ring[pos & LZ_RING_MASK] | (ring[(pos + 1) & LZ_RING_MASK] << 8) |
+		     (ring[(pos + 2) & LZ_RING_MASK] << 16);
+
+	return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static void lz_emit_literals(void)
+{
+	uint32_t count = enc.enc_pos - enc.lit_start;
+
+	if (count == 0) {
+		return;
+	}
+
+	out_byte(count - 1);
+	for (uint32_t pos = enc.lit_start; pos < enc.enc_pos; pos++) {
+		out_byte(ring[pos & LZ_RING_MASK]);
+	}
+
+	enc.lit_start = enc.enc_pos;
+}
+
+static void lz_emit_match(uint32_t len, uint32_t dist)
+{
+	uint32_t code = MIN(len - LZ_MIN_MATCH, 15);
+
+	out_byte(0x80 | (code << 3) | ((dist - 1) >> 8));
+	out_byte((dist - 1) & 0xff);
+
+	if (code == 15) {
+		out_byte(len - LZ_MIN_MATCH - 15);
+	}
+}
+
+static void lz_step(void)
+{
+	uint32_t max_len = MIN(enc.in_pos - enc.enc_pos, LZ_MAX_MATCH);
+	uint32_t len = 0;
+	uint32_t dist = 0;
+
+	if (max_len >= LZ_MIN_MATCH) {
+		uint32_t h = lz_hash(enc.enc_pos);
+
+		dist = (uint16_t)(enc.enc_pos - enc.hash[h]);
+		enc.hash[h] = enc.enc_pos;
+
+		if (dist >= 1 && dist <= LZ_MAX_DIST && dist <= enc.enc_pos) {
+			uint32_t cand = enc.enc_pos - dist;
+
+			while (len < max_len && ring[(cand + len) & LZ_RING_MASK] ==
+						       ring[(enc.enc_pos + len) & LZ_RING_MASK]) {
+				len++;
+			}
+		}
+	}
+
+	if (len < LZ_MIN_MATCH) {
+		enc.enc_pos++;
+		if (enc.enc_pos - enc.lit_start == LZ_MAX_LITERALS) {
+			lz_emit_literals();
+		}
+		return;
+	}
+
+	lz_emit_literals();
+	lz_emit_match(len, dist);
+
+	/* Index the matched positions, so runs keep extending */
+	for (uint32_t pos = enc.enc_pos + 1; pos < enc.enc_pos + len; pos++) {
+		if (pos + 2 < enc.in_pos) {
+			enc.hash[lz_hash(pos)] = pos;
+		}
+	}
+
+	enc.enc_pos += len;
+	enc.lit_start = enc.enc_pos;
+}
+
+static void lz_feed(uint8_t b)
+{
+	while (enc.in_pos - enc.enc_pos >= LZ_MAX_MATCH) {
+		lz_step();
+	}
+
+	ring[enc.in_pos & LZ_RING_MASK] = b;
+	enc.in_pos++;
+}
+
+static void lz_flush(void)
+{
+	while (enc.enc_pos < enc.in_pos) {
+		lz_step();
+	}
+
+	lz_emit_literals();
+}
+
+/* Coredump blocks, the stored stream can only be cut between them */
+
+static void block_end(void)
+{
+	enc.blk_hdr_len = 0;
+
+	lz_flush();
+	if (!enc.overflow) {
+		enc.safe_raw = enc.raw_pos;
+		enc.safe_stored = enc.out_pos;
+	}
+}
+
+static void body_write(const uint8_t *data, size_t len)
+{
+	while (len > 0 && !enc.overflow) {
+		size_t n;
+
+		if (enc.blk_hdr_len < BLOCK_HDR_SIZE) {
+			enc.blk_hdr[enc.blk_hdr_len++] = *data;
+			lz_feed(*data);
+			enc.raw_pos++;
+			data++;
+			len--;
+
+			if (enc.blk_hdr_len == BLOCK_HDR_SIZE) {
+				enc.blk_left = sys_get_le32(&enc.blk_hdr[BLOCK_LEN_OFFSET]);
+				if (enc.blk_left == 0) {
+					block_end();
+				}
+			}
+			continue;
+		}
+
+		n = MIN(len, enc.blk_left);
+		for (size_t i = 0; i < n && !enc.overflow; i++) {
+			lz_feed(data[i]);
+		}
+
+		enc.raw_pos += n;
+		enc.blk_left -= n;
+		data += n;
+		len -= n;
+
+		if (enc.blk_left == 0) {
+			block_end();
+		}
+	}
+
+	/* The rest of a dump that does not fit is only counted */
+	enc.raw_pos += len;
+}
+
+static bool finish(const uint8_t *mflt_hdr, size_t len)
+{
+	struct cd_hdr hdr = {
+		.seq = slots.next_seq,
+		.version = CD_VERSION,
+		.mflt_hdr_len = len,
+	};
+	uint32_t magic = CD_MAGIC;
+
+	if (len > MFLT_HDR_MAX || len != enc.body_start) {
+		return false;
+	}
+
+	if (!enc.overflow) {
+		lz_flush();
+	}
+	if (!enc.overflow) {
+		/* Complete dump, footer included */
+		enc.safe_raw = enc.raw_pos;
+		enc.safe_stored = enc.out_pos;
+	}
+
+	out_flush();
+
+	memcpy(hdr.mflt_hdr, mflt_hdr, len);
+	hdr.raw_size = enc.body_start + enc.raw_pos;
+	hdr.kept_size = enc.body_start + enc.safe_raw;
+	hdr.stored_size = enc.safe_stored;
+	hdr.save_ms = k_cyc_to_ms_floor32(k_cycle_get_32() - enc.start_cycles);
+
+	if (hdr.kept_size != hdr.raw_size) {
+		hdr.flags |= CD_FLAG_CUT;
+		if (len >= MFLT_HDR_TOTAL_OFFSET + sizeof(uint32_t)) {
+			sys_put_le32(hdr.kept_size, &hdr.mflt_hdr[MFLT_HDR_TOTAL_OFFSET]);
+		}
+	}
+
+	/* Magic last, an interrupted save leaves no valid coredump */
+	out_program(offsetof(struct cd_hdr, seq), &hdr.seq,
+		    (sizeof(hdr) - offsetof(struct cd_hdr, seq)) / sizeof(uint32_t));
+	out_program(offsetof(struct cd_hdr, magic), &magic, 1);
+
+	enc.active = false;
+	return !enc.flash_err;
+}
+
+/* Slot location */
+
+static const struct flash_area *slot_area(int slot)
+{
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+	if (slot == FALLBACK_SLOT) {
+		return fallback_fa;
+	}
+#endif
+	return fa;
+}
+
+static uint32_t slot_offset(int slot)
+{
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+	if (slot == FALLBACK_SLOT) {
+		return 0;
+	}
+#endif
+	return slot * SLOT_SIZE;
+}
+
+static uint32_t slot_capacity(int slot)
+{
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+	if (slot == FALLBACK_SLOT) {
+		return FALLBACK_SIZE - DATA_OFFSET;
+	}
+#endif
+	return DATA_CAPACITY;
+}
+
+/* Decompressor, thread context */
+
+static bool dec_fetch(uint8_t *b)
+{
+	if (dec.in_pos >= slots.hdr.stored_size) {
+		return false;
+	}
+
+	if (dec.in_pos - dec.cache_pos >= dec.cache_len) {
+		uint32_t len = MIN(sizeof(dec.cache), slots.hdr.stored_size - dec.in_pos);
+
+		if (flash_area_read(slot_area(slots.visible),
+				    slot_offset(slots.visible) + DATA_OFFSET + dec.in_pos, dec.cache,
+				    len)) {
+			return false;
+		}
+
+		dec.cache_pos = dec.in_pos;
+		dec.cache_len = len;
+	}
+
+	*b = dec.cache[dec.in_pos - dec.cache_pos];
+	dec.in_pos++;
+
+	return true;
+}
+
+static bool dec_byte(uint8_t *out)
+{
+	uint8_t b;
+
+	while (dec.lit_left == 0 && dec.match_left == 0) {
+		uint8_t token;
+		uint8_t next;
+		uint32_t len;
+
+		if (!dec_fetch(&token)) {
+			return false;
+		}
+
+		if (token < 0x80) {
+			dec.lit_left = token + 1;
+			continue;
+		}
+
+		if (!dec_fetch(&next)) {
+			return false;
+		}
+
+		dec.dist = (((token & 0x07) << 8) | next) + 1;
+		len = (token >> 3) & 0x0f;
+		if (len == 15) {
+			if (!dec_fetch(&next)) {
+				return false;
+			}
+			len += next;
+		}
+
+		if (dec.dist > dec.raw_pos) {
+			return false;
+		}
+
+		dec.match_left = len + LZ_MIN_MATCH;
+	}
+
+	if (dec.lit_left > 0) {
+		if (!dec_fetch(&b)) {
+			return false;
+		}
+		dec.lit_left--;
+	} else {
+		b = ring[(dec.raw_pos - dec.dist) & LZ_RING_MASK];
+		dec.match_left--;
+	}
+
+	ring[dec.raw_pos & LZ_RING_MASK] = b;
+	dec.raw_pos++;
+	*out = b;
+
+	return true;
+}
+
+/* Slots, thread context with slots_lock held */
+
+static bool hdr_valid(const struct cd_hdr *hdr, int slot)
+{
+	return hdr->magic == CD_MAGIC && hdr->version == CD_VERSION && hdr->mflt_hdr_len > 0 &&
+	       hdr->mflt_hdr_len <= MFLT_HDR_MAX && hdr->stored_size <= slot_capacity(slot);
+}
+
+static void slots_scan(void)
+{
+	struct cd_hdr hdr;
+	struct cd_hdr oldest_hdr = {0};
+	int oldest = -1;
+	int newest = -1;
+	int free_slot = -1;
+	uint32_t newest_seq = 0;
+	uint32_t retained = 0;
+	uint32_t dirty = 0;
+
+	for (int slot = 0; slot < SLOT_TOTAL; slot++) {
+		int err;
+
+		if (!slot_area(slot)) {
+			continue;
+		}
+
+		err = flash_area_read(slot_area(slot), slot_offset(slot), &hdr, sizeof(hdr));
+		if (err) {
+			LOG_ERR("Coredump slot %d not readable: %d", slot, err);
+			continue;
+		}
+
+		if (hdr_valid(&hdr, slot)) {
+			retained++;
+			if (oldest < 0 || hdr.seq < oldest_hdr.seq) {
+				oldest = slot;
+				oldest_hdr = hdr;
+			}
+			if (newest < 0 || hdr.seq > newest_seq) {
+				newest = slot;
+				newest_seq = hdr.seq;
+			}
+		} else if (slot >= SLOT_COUNT) {
+			/* The fallback slot is overwritten */
+		} else if (!MFLT_COREDUMP_FLASH_PRE_ERASED ||
+			   (hdr.slot_state == CD_SLOT_READY && hdr.magic == UINT32_MAX)) {
+			if (free_slot < 0) {
+				free_slot = slot;
+			}
+		} else {
+			/* Uploaded, or a save that did not complete */
+			dirty |= BIT(slot);
+		}
+	}
+
+	if (oldest != slots.visible || (oldest >= 0 && oldest_hdr.seq != slots.hdr.seq)) {
+		dec.ready = false;
+	}
+
+	if (oldest >= 0) {
+		slots.hdr = oldest_hdr;
+	}
+	slots.visible = oldest;
+	slots.newest = newest;
+	/* The internal flash slot is overwritten */
+	slots.free_slot = MFLT_COREDUMP_FLASH_PRE_ERASED ? free_slot : 0;
+	slots.next_seq = MAX(slots.next_seq, newest_seq + 1);
+	slots.retained = retained;
+	slots.dirty = dirty;
+
+	if (dirty) {
+		k_work_schedule(&erase_work, K_NO_WAIT);
+	}
+}
+
+static void erase_work_fn(struct k_work *work)
+{
+	static int slot = -1;
+	static uint32_t offset;
+	uint32_t ready = CD_SLOT_READY;
+	int err;
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&slots_lock, K_FOREVER);
+
+	if (slot < 0) {
+		if (slots.dirty == 0) {
+			k_mutex_unlock(&slots_lock);
+			return;
+		}
+		slot = u32_count_trailing_zeros(slots.dirty);
+		offset = 0;
+	}
+
+	/* A sector at a time, the flash stays usable for others */
+	err = flash_area_erase(fa, slot_offset(slot) + offset, MFLT_COREDUMP_FLASH_SECTOR_SIZE);
+	if (err) {
+		LOG_ERR("Coredump slot %d erase failed: %d", slot, err);
+		slot = -1;
+		k_mutex_unlock(&slots_lock);
+		return;
+	}
+
+	offset += MFLT_COREDUMP_FLASH_SECTOR_SIZE;
+	if (offset < SLOT_SIZE) {
+		k_work_schedule(&erase_work, ERASE_PAUSE);
+		k_mutex_unlock(&slots_lock);
+		return;
+	}
+
+	err = flash_area_write(fa, slot_offset(slot), &ready, sizeof(ready));
+	if (err) {
+		LOG_ERR("Coredump slot %d not marked erased: %d", slot, err);
+	} else {
+		LOG_DBG("Coredump slot %d erased", slot);
+	}
+
+	slot = -1;
+	slots_scan();
+
+	k_mutex_unlock(&slots_lock);
+}
+
+/* Picks the slot of a new save and prepares its flash */
+static bool save_begin(void)
+{
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+	/* The SPI NOR driver was in the middle of a command, leave the external flash alone */
+	if (!mflt_coredump_flash_ext_idle()) {
+		if (!fallback_fa) {
+			return false;
+		}
+
+		enc.fallback = true;
+		enc.slot_offset = slot_offset(FALLBACK_SLOT);
+		enc.capacity = slot_capacity(FALLBACK_SLOT);
+
+		return mflt_coredump_flash_int_begin(enc.slot_offset);
+	}
+#endif
+
+	/* Without a free slot the retained coredumps are kept */
+	if (slots.free_slot < 0) {
+		return false;
+	}
+
+	enc.slot_offset = slot_offset(slots.free_slot);
+	enc.capacity = slot_capacity(slots.free_slot);
+
+#ifdef CONFIG_MFLT_COREDUMP_LZ_EXTERNAL
+	return mflt_coredump_flash_ext_begin(enc.slot_offset);
+#else
+	return mflt_coredump_flash_int_begin(enc.slot_offset);
+#endif
+}
+
+/* Memfault coredump storage port */
+
+void memfault_platform_coredump_storage_get_info(sMfltCoredumpStorageInfo *info)
+{
+	*info = (sMfltCoredumpStorageInfo){
+		.size = CONFIG_MFLT_COREDUMP_LZ_VIRTUAL_SIZE,
+		.sector_size = MFLT_COREDUMP_FLASH_SECTOR_SIZE,
+	};
+}
+
+bool memfault_platform_coredump_storage_erase(uint32_t offset, size_t erase_size)
+{
+	uint32_t taken = 0;
+
+	if (offset + erase_size > CONFIG_MFLT_COREDUMP_LZ_VIRTUAL_SIZE) {
+		return false;
+	}
+
+	if (offset != 0) {
+		/* Slots are erased ahead or as the compressed stream reaches them */
+		return true;
+	}
+
+	/* A new save */
+	memset(&enc, 0, sizeof(enc));
+	dec.ready = false;
+
+	enc.start_cycles = k_cycle_get_32();
+
+	if (!save_begin()) {
+		return false;
+	}
+
+	out_program(offsetof(struct cd_hdr, slot_state), &taken, 1);
+	enc.active = !enc.flash_err;
+
+	return enc.active;
+}
+
+bool memfault_platform_coredump_storage_write(uint32_t offset, const void *data, size_t data_len)
+{
+	if (!enc.active || offset + data_len > CONFIG_MFLT_COREDUMP_LZ_VIRTUAL_SIZE) {
+		return false;
+	}
+
+	/* The SDK writes its header last, at offset 0 */
+	if (offset == 0) {
+		return (enc.body_start == 0) ? true : finish(data, data_len);
+	}
+
+	if (enc.body_start == 0) {
+		enc.body_start = offset;
+	}
+
+	/* The stream only compresses sequential writes */
+	if (offset != enc.body_start + enc.raw_pos) {
+		return false;
+	}
+
+	body_write(data, data_len);
+
+	return true;
+}
+
+bool memfault_platform_coredump_storage_read(uint32_t offset, void *data, size_t read_len)
+{
+	const struct cd_hdr *hdr = &slots.hdr;
+	uint8_t *out = data;
+	bool ok = true;
+
+	if (offset + read_len > CONFIG_MFLT_COREDUMP_LZ_VIRTUAL_SIZE) {
+		return false;
+	}
+
+	if (slots.visible < 0) {
+		/* Reads like erased storage, no coredump */
+		memset(data, 0xff, read_len);
+		return true;
+	}
+
+	/* The header is cached, also read while saving */
+	for (; read_len > 0 && offset < hdr->mflt_hdr_len; offset++, read_len--) {
+		*out++ = hdr->mflt_hdr[offset];
+	}
+
+	if (read_len == 0) {
+		return true;
+	}
+
+	offset -= hdr->mflt_hdr_len;
+
+	k_mutex_lock(&slots_lock, K_FOREVER);
+
+	if (!dec.ready || offset < dec.raw_pos) {
+		memset(&dec, 0, sizeof(dec));
+		dec.ready = true;
+	}
+
+	while (dec.raw_pos < offset + read_len) {
+		uint32_t pos = dec.raw_pos;
+		uint8_t b;
+
+		if (!dec_byte(&b)) {
+			dec.ready = false;
+			ok = false;
+			break;
+		}
+
+		if (pos >= offset) {
+			out[pos - offset] = b;
+		}
+	}
+
+	k_mutex_unlock(&slots_lock);
+
+	return ok;
+}
+
+void memfault_platform_coredump_storage_clear(void)
+{
+	uint32_t uploaded = 0;
+	int err;
+
+	k_mutex_lock(&slots_lock, K_FOREVER);
+
+	if (slots.visible >= 0) {
+		/* Programming the magic word again only clears bits */
+		err = flash_area_write(slot_area(slots.visible),
+				       slot_offset(slots.visible) + offsetof(struct cd_hdr, magic),
+				       &uploaded, sizeof(uploaded));
+		if (err) {
+			LOG_ERR("Coredump slot %d not cleared: %d", slots.visible, err);
+		}
+
+		/* The next retained coredump becomes visible */
+		slots_scan();
+	}
+
+	k_mutex_unlock(&slots_lock);
+}
+
+void mflt_coredump_lz_collect(void)
+{
+	bool unexpected = false;
+
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_coredump_retained_count, slots.retained);
+
+	if (boot_dump_checked) {
+		return;
+	}
+
+	boot_dump_checked = true;
+
+	/* Only a coredump of the previous boot, older ones were reported before */
+	if (!boot_dump_found ||
+	    memfault_reboot_tracking_get_unexpected_reboot_occurred(&unexpected) != 0 ||
+	    !unexpected) {
+		return;
+	}
+
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_coredump_raw_bytes, boot_dump.raw_size);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_coredump_stored_bytes, boot_dump.stored_size);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_coredump_save_ms, boot_dump.save_ms);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_coredump_cut_bytes,
+				     boot_dump.raw_size - boot_dump.kept_size);
+}
+
+static int coredump_lz_init(void)
+{
+	int err = flash_area_open(PART_ID, &fa);
+
+	if (err) {
+		LOG_ERR("Coredump partition not available: %d", err);
+		return err;
+	}
+
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+	err = flash_area_open(FALLBACK_ID, &fallback_fa);
+	if (err) {
+		LOG_WRN("Coredump fallback partition not available: %d", err);
+		fallback_fa = NULL;
+	}
+#endif
+
+	k_mutex_lock(&slots_lock, K_FOREVER);
+
+	slots_scan();
+
+	if (slots.newest >= 0 &&
+	    flash_area_read(slot_area(slots.newest), slot_offset(slots.newest), &boot_dump,
+			    sizeof(boot_dump)) == 0) {
+		boot_dump_found = true;
+	}
+
+#ifdef MFLT_COREDUMP_FALLBACK_PARTITION
+	if (slots.newest == FALLBACK_SLOT) {
+		LOG_WRN("Newest coredump saved to internal flash, external flash was busy");
+	}
+#endif
+
+	k_mutex_unlock(&slots_lock);
+
+	if (!boot_dump_found) {
+		return 0;
+	}
+
+	LOG_INF("%u coredump(s) retained, newest %u bytes stored in %u (%u%%), saved in %u ms",
+		slots.retained, boot_dump.raw_size, boot_dump.stored_size,
+		boot_dump.stored_size * 100 / MAX(boot_dump.raw_size, 1), boot_dump.save_ms);
+
+	if (boot_dump.flags & CD_FLAG_CUT) {
+		LOG_WRN("Coredump cut to %u bytes, raise the slot size or drop regions",
+			boot_dump.kept_size);
+	}
+
+	return 0;
+}
+
+SYS_INIT(coredump_lz_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
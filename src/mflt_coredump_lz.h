@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Publish the coredump storage metrics
+ *
+ * The number of retained coredumps is reported every heartbeat, the size of
+ * the newest coredump once, in the first heartbeat after a crash.
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void mflt_coredump_lz_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,558 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Dictionary log capture for Memfault.
+ *
+ * A log backend that keeps records in Zephyr's dictionary format instead of
+ * rendered text: the format string is stored as its address in the image and
+ * the arguments as a cbprintf package, so a record is typically a fraction
+ * of its text and no formatting runs on the device. Records are kept in a
+ * RAM ring, the oldest are overwritten when it is full. A collection freezes
+ * the records for upload as a CDR; until it is uploaded new records may only
+ * use the free part of the ring. With CONFIG_MFLT_LOG_FILTER repeated and
+ * over-rate messages are filtered before they take space in the ring.
+ *
+ * The ring is interleaved with time marks, at most one per second, so a
+ * collection can be limited to the records of a time window. With
+ * CONFIG_MFLT_DICT_LOG_RETAIN the ring is not initialized at boot and the
+ * records of the previous boot, up to a fault, are kept if the ring is
+ * found intact.
+ *
+ * The blob is expanded on the host with script/mflt_dict_log_decoder.py and
+ * the log_dictionary.json database generated from the ELF at build time.
+ */
+
+#include "mflt_dict_log.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_backend.h>
+#include <zephyr/logging/log_output.h>
+#include <zephyr/logging/log_output_dict.h>
+#include <memfault/components.h>
+#include <memfault/metrics/metrics.h>
+
+#include "mflt_cdr_budget.h"
+
+#ifdef CONFIG_MFLT_LOG_FILTER
+#include "mflt_log_filter.h"
+#endif
+
+/* Not used in the backend callbacks, a record there would log itself */
+LOG_MODULE_REGISTER(mflt_dict_log, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define BLOB_MAGIC 0x4c44464d /* "MFDL" */
+#define BLOB_VERSION 3
+#define RING_MAGIC 0x52474c44 /* "DLGR" */
+
+/* Start of the CDR blob, followed by records of a 16-bit tag and, for
+ * messages, a dictionary log message as written by
+ * log_dict_output_msg_process()
+ */
+struct blob_hdr {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t reserved[3];
+	/* Records lost since the previous collection */
+	uint32_t dropped;
+	/* Uptime at the collection, to place the record timestamps */
+	uint32_t uptime_ms;
+	/* Messages rate limited since the previous collection */
+	uint32_t limited;
+} __packed;
+
+typedef uint16_t rec_tag_t;
+
+/* Message of the given length */
+#define REC_LEN_MASK 0x7fff
+/* Repeats of the previous message, no payload */
+#define REC_REPEAT 0x8000
+#define REC_REPEAT_MASK 0x3fff
+/* Uptime in ms of the following records, 32-bit payload */
+#define REC_TIME 0xc000
+/* The device booted, no payload */
+#define REC_BOOT 0xc001
+
+#define REC_META_MASK 0xc000
+#define TIME_MARK_INTERVAL_MS 1000
+
+BUILD_ASSERT(CONFIG_MFLT_DICT_LOG_MAX_RECORD_SIZE <= REC_LEN_MASK);
+
+/* Totals of the elapsed heartbeat interval */
+struct dict_log_stats {
+	uint32_t records;
+	uint32_t bytes;
+	uint32_t dropped;
+};
+
+static struct k_spinlock lock;
+static struct dict_log_stats stats;
+
+struct dict_ring {
+	uint32_t magic;
+	size_t tail;
+	size_t used;
+	uint8_t buf[CONFIG_MFLT_DICT_LOG_RAM_SIZE];
+};
+
+#ifdef CONFIG_MFLT_DICT_LOG_RETAIN
+static __noinit struct dict_ring ring;
+#else
+static struct dict_ring ring;
+#endif
+
+/* Oldest bytes of the ring frozen for the CDR, 0 if none */
+static size_t frozen_len;
+static struct blob_hdr frozen_hdr;
+static const char *frozen_reason;
+static uint32_t dropped_since_collection;
+static uint32_t limited_since_collection;
+
+/* Record being written by the log thread */
+static uint8_t rec_buf[CONFIG_MFLT_DICT_LOG_MAX_RECORD_SIZE];
+static size_t rec_len;
+static bool rec_overflow;
+static bool time_marked;
+static uint32_t time_mark_ms;
+
+static int rec_out(uint8_t *data, size_t length, void *ctx)
+{
+	ARG_UNUSED(ctx);
+
+	if (rec_len + length > sizeof(rec_buf)) {
+		rec_overflow = true;
+	} else {
+		memcpy(&rec_buf[rec_len], data, length);
+		rec_len += length;
+	}
+
+	return length;
+}
+
+static uint8_t output_buf[32];
+LOG_OUTPUT_DEFINE(dict_output, rec_out, output_buf, sizeof(output_buf));
+
+static size_t ring_pos(size_t off)
+{
+	return (ring.tail + off) % sizeof(ring.buf);
+}
+
+static void ring_write(size_t pos, const void *data, size_t len)
+{
+	size_t first = MIN(len, sizeof(ring.buf) - pos);
+
+	memcpy(&ring.buf[pos], data, first);
+	memcpy(ring.buf, (const uint8_t *)data + first, len - first);
+}
+
+static void ring_read(size_t pos, void *buf, size_t len)
+{
+	size_t first = MIN(len, sizeof(ring.buf) - pos);
+
+	memcpy(buf, &ring.buf[pos], first);
+	memcpy((uint8_t *)buf + first, ring.buf, len - first);
+}
+
+static size_t rec_size(rec_tag_t tag)
+{
+	if (tag == REC_TIME) {
+		return sizeof(tag) + sizeof(uint32_t);
+	}
+
+	if (tag & REC_META_MASK) {
+		return sizeof(tag);
+	}
+
+	return sizeof(tag) + tag;
+}
+
+static void record_drop(uint32_t cnt)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	stats.dropped += cnt;
+	dropped_since_collection += cnt;
+
+	k_spin_unlock(&lock, key);
+}
+
+#ifdef CONFIG_MFLT_LOG_FILTER
+static void record_limited(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	limited_since_collection++;
+
+	k_spin_unlock(&lock, key);
+}
+#endif
+
+/* Append a record, data is the payload of a message or a time mark */
+static bool record_commit(rec_tag_t tag, const void *data)
+{
+	size_t need = rec_size(tag);
+	rec_tag_t old;
+	k_spinlock_key_t key;
+
+	if (need > sizeof(ring.buf)) {
+		record_drop(1);
+		return false;
+	}
+
+	key = k_spin_lock(&lock);
+
+	while (sizeof(ring.buf) - ring.used < need) {
+		if (frozen_len > 0) {
+			/* The oldest records wait for the upload */
+			stats.dropped++;
+			dropped_since_collection++;
+			k_spin_unlock(&lock, key);
+			return false;
+		}
+
+		ring_read(ring.tail, &old, sizeof(old));
+		ring.tail = ring_pos(rec_size(old));
+		ring.used -= rec_size(old);
+	}
+
+	ring_write(ring_pos(ring.used), &tag, sizeof(tag));
+	if (need > sizeof(tag)) {
+		ring_write(ring_pos(ring.used + sizeof(tag)), data, need - sizeof(tag));
+	}
+	ring.used += need;
+
+	if (!(tag & REC_META_MASK)) {
+		stats.records++;
+	}
+	stats.bytes += need;
+
+	k_spin_unlock(&lock, key);
+	return true;
+}
+
+static void time_mark(void)
+{
+	uint32_t now = k_uptime_get_32();
+
+	if (time_marked && now - time_mark_ms < TIME_MARK_INTERVAL_MS) {
+		return;
+	}
+
+	time_marked = record_commit(REC_TIME, &now);
+	time_mark_ms = now;
+}
+
+static void process(const struct log_backend *const backend, union log_msg_generic *msg)
+{
+	uint8_t level = log_msg_get_level(&msg->log);
+	uint32_t repeats = 0;
+
+	ARG_UNUSED(backend);
+
+	/* Raw strings (printk) carry no level and are left to the text backends */
+	if (level == LOG_LEVEL_NONE || level > CONFIG_MFLT_DICT_LOG_LEVEL) {
+		return;
+	}
+
+#ifdef CONFIG_MFLT_LOG_FILTER
+	switch (mflt_log_filter_check(&msg->log, &repeats)) {
+	case MFLT_LOG_FILTER_PASS:
+		break;
+	case MFLT_LOG_FILTER_REPEAT:
+		return;
+	case MFLT_LOG_FILTER_LIMITED:
+		record_limited();
+		return;
+	}
+#endif
+
+	rec_len = 0;
+	rec_overflow = false;
+
+	log_dict_output_msg_process(&dict_output, &msg->log, 0);
+	log_output_flush(&dict_output);
+
+	if (repeats > 0) {
+		record_commit(REC_REPEAT | MIN(repeats, REC_REPEAT_MASK), NULL);
+	}
+
+	if (rec_overflow) {
+		record_drop(1);
+		return;
+	}
+
+	time_mark();
+	record_commit(rec_len, rec_buf);
+}
+
+static void dropped(const struct log_backend *const backend, uint32_t cnt)
+{
+	ARG_UNUSED(backend);
+
+	record_drop(cnt);
+}
+
+static void panic(const struct log_backend *const backend)
+{
+	/* Records are already in RAM, nothing to flush */
+	ARG_UNUSED(backend);
+}
+
+/* A retained ring is only used if every record is where its tag says */
+static bool ring_intact(void)
+{
+	size_t off = 0;
+	rec_tag_t tag;
+
+	if (ring.magic != RING_MAGIC || ring.tail >= sizeof(ring.buf) ||
+	    ring.used > sizeof(ring.buf)) {
+		return false;
+	}
+
+	while (off < ring.used) {
+		if (ring.used - off < sizeof(tag)) {
+			return false;
+		}
+
+		ring_read(ring_pos(off), &tag, sizeof(tag));
+		if ((tag & REC_META_MASK) == REC_META_MASK && tag != REC_TIME && tag != REC_BOOT) {
+			return false;
+		}
+
+		off += rec_size(tag);
+	}
+
+	return off == ring.used;
+}
+
+static bool has_cdr_cb(sMemfaultCdrMetadata *metadata);
+static bool read_data_cb(uint32_t offset, void *buf, size_t buf_len);
+static void mark_cdr_read_cb(void);
+
+static const char *const mimetypes[] = {MEMFAULT_CDR_BINARY};
+
+static const sMemfaultCdrSourceImpl dict_log_cdr_source = {
+	.has_cdr_cb = has_cdr_cb,
+	.read_data_cb = read_data_cb,
+	.mark_cdr_read_cb = mark_cdr_read_cb,
+};
+
+static void init(const struct log_backend *const backend)
+{
+	ARG_UNUSED(backend);
+
+	if (ring_intact()) {
+		record_commit(REC_BOOT, NULL);
+	} else {
+		ring.magic = RING_MAGIC;
+		ring.tail = 0;
+		ring.used = 0;
+	}
+
+	if (!memfault_cdr_register_source(&dict_log_cdr_source)) {
+		LOG_ERR("Failed to register dictionary log CDR source");
+	}
+}
+
+static const struct log_backend_api mflt_dict_log_api = {
+	.process = process,
+	.dropped = dropped,
+	.panic = panic,
+	.init = init,
+};
+
+LOG_BACKEND_DEFINE(mflt_dict_log_backend, mflt_dict_log_api, true);
+
+static bool has_cdr_cb(sMemfaultCdrMetadata *metadata)
+{
+	if (frozen_len == 0) {
+		return false;
+	}
+
+	*metadata = (sMemfaultCdrMetadata){
+		.start_time.type = kMemfaultCurrentTimeType_Unknown,
+		.mimetypes = (const char **)mimetypes,
+		.num_mimetypes = ARRAY_SIZE(mimetypes),
+		.data_size_bytes = sizeof(frozen_hdr) + frozen_len,
+		.collection_reason = frozen_reason,
+	};
+
+	return true;
+}
+
+static bool read_data_cb(uint32_t offset, void *buf, size_t buf_len)
+{
+	uint8_t *out = buf;
+	size_t len;
+
+	if (offset + buf_len > sizeof(frozen_hdr) + frozen_len) {
+		return false;
+	}
+
+	if (offset < sizeof(frozen_hdr)) {
+		len = MIN(buf_len, sizeof(frozen_hdr) - offset);
+		memcpy(out, (const uint8_t *)&frozen_hdr + offset, len);
+		out += len;
+		offset += len;
+		buf_len -= len;
+	}
+
+	/* The frozen records are neither moved nor overwritten until marked read */
+	if (buf_len > 0) {
+		ring_read(ring_pos(offset - sizeof(frozen_hdr)), out, buf_len);
+	}
+
+	return true;
+}
+
+static void mark_cdr_read_cb(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	ring.tail = ring_pos(frozen_len);
+	ring.used -= frozen_len;
+	frozen_len = 0;
+
+	k_spin_unlock(&lock, key);
+
+	LOG_DBG("Dictionary log records uploaded");
+}
+
+/* Offset of the first record of this boot logged at or after since_ms.
+ * Records in front of the first time mark are older than it.
+ */
+static size_t window_start(uint32_t since_ms)
+{
+	size_t start = since_ms ? ring.used : 0;
+	size_t off = 0;
+	rec_tag_t tag;
+	uint32_t t;
+
+	while (since_ms && off < ring.used) {
+		ring_read(ring_pos(off), &tag, sizeof(tag));
+
+		if (tag == REC_BOOT) {
+			start = ring.used;
+		} else if (tag == REC_TIME) {
+			ring_read(ring_pos(off + sizeof(tag)), &t, sizeof(t));
+			if (t < since_ms) {
+				start = ring.used;
+			} else if (start == ring.used) {
+				start = off;
+			}
+		}
+
+		off += rec_size(tag);
+	}
+
+	return start;
+}
+
+int mflt_dict_log_freeze(uint32_t since_ms, const char *reason)
+{
+	k_spinlock_key_t key;
+	size_t start;
+	int err = 0;
+
+#ifdef CONFIG_MFLT_LOG_FILTER
+	/* Repeats of the last message would otherwise only be recorded in front
+	 * of the next one, after the frozen records
+	 */
+	if (frozen_len == 0) {
+		uint32_t repeats = mflt_log_filter_flush();
+
+		if (repeats > 0) {
+			record_commit(REC_REPEAT | MIN(repeats, REC_REPEAT_MASK), NULL);
+		}
+	}
+#endif
+
+	key = k_spin_lock(&lock);
+
+	if (frozen_len > 0) {
+		err = -EBUSY;
+		goto unlock;
+	}
+
+	/* Records before the window are not uploaded, make room for new ones */
+	start = window_start(since_ms);
+	ring.tail = ring_pos(start);
+	ring.used -= start;
+
+	if (ring.used == 0) {
+		err = -ENODATA;
+		goto unlock;
+	}
+
+	frozen_len = ring.used;
+	frozen_reason = reason;
+	frozen_hdr = (struct blob_hdr){
+		.magic = BLOB_MAGIC,
+		.version = BLOB_VERSION,
+		.dropped = dropped_since_collection,
+		.uptime_ms = k_uptime_get_32(),
+		.limited = limited_since_collection,
+	};
+	dropped_since_collection = 0;
+	limited_since_collection = 0;
+
+unlock:
+	k_spin_unlock(&lock, key);
+
+	if (!err) {
+		LOG_INF("Dictionary log collected (%s): %zu bytes", reason, frozen_len);
+	}
+
+	return err;
+}
+
+int mflt_dict_log_trigger_collection(void)
+{
+	static int64_t last_collection;
+	int64_t now = k_uptime_get();
+	int err;
+
+	if (last_collection != 0 &&
+	    now - last_collection < CONFIG_MFLT_DICT_LOG_EXPORT_INTERVAL_SEC * MSEC_PER_SEC) {
+		return -EAGAIN;
+	}
+
+	err = mflt_cdr_budget_take("dict_log");
+	if (err) {
+		return err;
+	}
+
+	err = mflt_dict_log_freeze(0, "dict_log");
+	if (err) {
+		mflt_cdr_budget_give_back();
+	} else {
+		last_collection = now;
+	}
+
+	return err;
+}
+
+void mflt_dict_log_collect(void)
+{
+	struct dict_log_stats s;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	s = stats;
+	stats = (struct dict_log_stats){0};
+
+	k_spin_unlock(&lock, key);
+
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_dict_log_count, s.records);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_dict_log_drop_count, s.dropped);
+	if (s.records > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(mflt_dict_log_avg_bytes, s.bytes / s.records);
+	}
+
+#ifdef CONFIG_MFLT_LOG_FILTER
+	mflt_log_filter_collect();
+#endif
+}
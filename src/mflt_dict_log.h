@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Freeze the records of a time window for upload as a CDR.
+ *
+ * Records of this boot logged before since_ms are discarded. With
+ * since_ms 0 all records are kept, including those retained from the
+ * previous boot. Not rate limited, and the caller takes from the CDR budget.
+ *
+ * @param since_ms Start of the window in uptime milliseconds, 0 for all records.
+ * @param reason CDR collection reason, a string constant.
+ *
+ * @return 0 on success, -EBUSY if the previous collection is not uploaded
+ *         yet, -ENODATA if there are no records in the window
+ */
+int mflt_dict_log_freeze(uint32_t since_ms, const char *reason);
+
+/**
+ * @brief Freeze the captured dictionary log records for upload as a CDR.
+ *
+ * Records captured after the call go to the free part of the buffer and are
+ * part of the next collection. At most one collection per
+ * CONFIG_MFLT_DICT_LOG_EXPORT_INTERVAL_SEC is made, and only if the shared
+ * CDR budget allows it.
+ *
+ * @return 0 on success, -EBUSY if the previous collection is not uploaded
+ *         yet, -EAGAIN if the interval has not elapsed or the CDR budget is
+ *         spent, -ENODATA if there is nothing to upload
+ */
+int mflt_dict_log_trigger_collection(void);
+
+/**
+ * @brief Publish the dictionary log capture statistics of the elapsed heartbeat interval
+ *
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void mflt_dict_log_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
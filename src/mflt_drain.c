@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Prioritized packetizer drain. At every message boundary the packetizer is
+ * restricted to the most important data source class that has data, so after
+ * an outage the coredump goes out before the backlog of heartbeats and logs.
+ * Switching sources aborts a message in progress, so the class is never
+ * switched in the middle of one.
+ *
+ * Both upload transports drain through here, so the per session statistics
+ * are kept here as well and published once per heartbeat.
+ */
+
+#include "mflt_drain.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <memfault/core/data_packetizer.h>
+#include <memfault/core/event_storage.h>
+#include <memfault/metrics/metrics.h>
+#include <memfault/panics/coredump.h>
+
+#include "boot_timeline.h"
+
+LOG_MODULE_REGISTER(mflt_drain, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+/* Most important first. Trace events and heartbeats share the event storage
+ * and cannot be told apart by the packetizer.
+ */
+static const uint32_t class_masks[] = {
+	kMfltDataSourceMask_Coredump,
+	kMfltDataSourceMask_Event,
+	kMfltDataSourceMask_Cdr | kMfltDataSourceMask_Log,
+};
+
+/* Totals of the sessions ended in the current heartbeat interval */
+struct upload_stats {
+	uint32_t sessions;
+	uint32_t bytes;
+	uint32_t chunks;
+	uint32_t retries;
+	uint32_t setups;
+	uint32_t setup_ms;
+	uint32_t duration_ms;
+};
+
+static struct k_spinlock lock;
+static struct upload_stats stats;
+
+/* Owned by the draining context */
+static size_t session_bytes;
+static uint32_t session_chunks;
+static int64_t session_start;
+static uint32_t session_setup_ms;
+static bool session_retried;
+
+static bool message_in_progress(void)
+{
+	const sPacketizerConfig cfg = {
+		.enable_multi_packet_chunk = false,
+	};
+	sPacketizerMetadata metadata;
+
+	return memfault_packetizer_begin(&cfg, &metadata) && metadata.send_in_progress;
+}
+
+/* Restrict the packetizer to the most important class with data */
+static bool class_select(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(class_masks); i++) {
+		memfault_packetizer_set_active_sources(class_masks[i]);
+		if (memfault_packetizer_data_available()) {
+			LOG_DBG("Draining class %zu", i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void session_reset(uint32_t setup_ms)
+{
+	session_bytes = 0;
+	session_chunks = 0;
+	session_setup_ms = setup_ms;
+	session_retried = false;
+	/* The session includes the connection setup */
+	session_start = k_uptime_get() - setup_ms;
+}
+
+void mflt_drain_session_begin(uint32_t setup_ms)
+{
+	session_reset(setup_ms);
+}
+
+bool mflt_drain_get_chunk(void *buf, size_t *len)
+{
+	const sPacketizerConfig cfg = {
+		.enable_multi_packet_chunk = false,
+	};
+	sPacketizerMetadata metadata;
+
+	if (CONFIG_MFLT_UPLOAD_SESSION_BUDGET_BYTES > 0 &&
+	    session_bytes >= CONFIG_MFLT_UPLOAD_SESSION_BUDGET_BYTES) {
+		LOG_INF("Session budget of %d bytes spent", CONFIG_MFLT_UPLOAD_SESSION_BUDGET_BYTES);
+		return false;
+	}
+
+	if (!message_in_progress() && !class_select()) {
+		return false;
+	}
+
+	if (!memfault_packetizer_begin(&cfg, &metadata) ||
+	    memfault_packetizer_get_next(buf, len) != kMemfaultPacketizerStatus_EndOfChunk) {
+		return false;
+	}
+
+	session_bytes += *len;
+	session_chunks++;
+	return true;
+}
+
+void mflt_drain_chunk_failed(void)
+{
+	memfault_packetizer_abort();
+	mflt_drain_record_retry();
+}
+
+void mflt_drain_record_retry(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	stats.retries++;
+	k_spin_unlock(&lock, key);
+
+	session_retried = true;
+}
+
+void mflt_drain_session_end(void)
+{
+	uint32_t duration_ms = (uint32_t)(k_uptime_get() - session_start);
+	k_spinlock_key_t key;
+
+	if (!message_in_progress()) {
+		memfault_packetizer_set_active_sources(kMfltDataSourceMask_All);
+	}
+
+	key = k_spin_lock(&lock);
+	stats.sessions++;
+	stats.bytes += session_bytes;
+	stats.chunks += session_chunks;
+	stats.duration_ms += duration_ms;
+	if (session_setup_ms > 0) {
+		stats.setups++;
+		stats.setup_ms += session_setup_ms;
+	}
+	k_spin_unlock(&lock, key);
+
+	LOG_INF("Upload session: %zu bytes in %u chunks, %u ms (setup %u ms)", session_bytes,
+		session_chunks, duration_ms, session_setup_ms);
+
+	if (session_chunks > 0 && !session_retried) {
+		boot_timeline_mark(BOOT_PHASE_FIRST_UPLOAD);
+	}
+
+	/* Chunks read without a new session are not counted twice */
+	session_reset(0);
+}
+
+/* Data waiting in Memfault storage. Logs and CDRs do not report their size. */
+static uint32_t backlog_bytes(void)
+{
+	size_t coredump_size = 0;
+
+	if (!memfault_coredump_has_valid_coredump(&coredump_size)) {
+		coredump_size = 0;
+	}
+
+	return memfault_event_storage_bytes_used() + coredump_size;
+}
+
+void mflt_drain_collect(void)
+{
+	struct upload_stats interval;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	interval = stats;
+	memset(&stats, 0, sizeof(stats));
+	k_spin_unlock(&lock, key);
+
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_upload_bytes, interval.bytes);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_upload_chunk_count, interval.chunks);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_upload_retry_count, interval.retries);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_upload_duration_ms, interval.duration_ms);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_upload_backlog_bytes, backlog_bytes());
+
+	/* Leave timing metrics unset for intervals without an upload */
+	if (interval.setups > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(mflt_upload_setup_avg_ms,
+					     interval.setup_ms / interval.setups);
+	}
+
+	if (interval.duration_ms > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(
+			mflt_upload_throughput_bps,
+			(uint32_t)((uint64_t)interval.bytes * 8 * MSEC_PER_SEC / interval.duration_ms));
+	}
+
+	LOG_INF("Upload interval - sessions: %u, bytes: %u, chunks: %u, retries: %u, "
+		"duration: %u ms",
+		interval.sessions, interval.bytes, interval.chunks, interval.retries,
+		interval.duration_ms);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start an upload session.
+ *
+ * Resets the session byte budget, CONFIG_MFLT_UPLOAD_SESSION_BUDGET_BYTES.
+ *
+ * @param setup_ms Time spent connecting to the upload endpoint, 0 if the
+ *                 transport reuses an open connection.
+ */
+void mflt_drain_session_begin(uint32_t setup_ms);
+
+/**
+ * @brief Read the next chunk of Memfault data in priority order.
+ *
+ * Coredumps are drained first, then events (trace events and heartbeats),
+ * then CDRs and logs. The class is only switched between messages, so a
+ * message cut short by the budget is continued by the next session.
+ *
+ * @param buf Destination buffer.
+ * @param len In: size of @p buf. Out: chunk length.
+ * @return true if a chunk was read, false if there is no data left or the
+ *         session budget is spent.
+ */
+bool mflt_drain_get_chunk(void *buf, size_t *len);
+
+/**
+ * @brief Abort the message of the last chunk after it failed to send.
+ *
+ * The message is sent again from its start by a later session.
+ */
+void mflt_drain_chunk_failed(void);
+
+/**
+ * @brief Count a failed transfer that is retried later.
+ */
+void mflt_drain_record_retry(void);
+
+/**
+ * @brief End the upload session.
+ *
+ * Call once per session, after the transport confirmed delivery of the last
+ * chunk. Re-enables all data sources for other packetizer users unless a
+ * message is still in progress, and resets the session counters.
+ */
+void mflt_drain_session_end(void);
+
+/**
+ * @brief Publish the upload statistics of the elapsed heartbeat interval
+ *
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void mflt_drain_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Non-volatile Memfault event storage on the mflt_event_storage partition.
+ *
+ * The RAM event storage of the Memfault SDK becomes a write-back buffer:
+ * events are moved to a flash ring once it is filled past
+ * CONFIG_MFLT_EVENT_STORAGE_FLUSH_THRESHOLD_PERCENT or
+ * CONFIG_MFLT_EVENT_STORAGE_FLUSH_DELAY_SEC after the first unflushed event,
+ * and the packetizer reads events straight from flash. Heartbeats and trace
+ * events survive reboots and offline periods up to the partition size; when
+ * it is full the oldest events are dropped. The ring erases every sector
+ * once per pass, which spreads the wear over the whole partition.
+ */
+
+#include "mflt_event_storage.h"
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <memfault/core/event_storage.h>
+#include <memfault/core/platform/nonvolatile_event_storage.h>
+#include <memfault/metrics/metrics.h>
+
+#include "flash_ring.h"
+
+LOG_MODULE_REGISTER(mflt_event_storage, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+static struct flash_ring ring;
+static bool ring_ready;
+
+/* Totals of the elapsed heartbeat interval */
+struct nv_stats {
+	uint32_t event_bytes;
+	uint32_t drained_bytes;
+	uint32_t read_us;
+};
+
+static struct k_spinlock lock;
+static struct nv_stats stats;
+
+/* Ring counters at the last heartbeat */
+static uint32_t last_programmed;
+static uint32_t last_erases;
+static uint32_t last_dropped;
+
+/* Length of the event the packetizer is reading */
+static size_t head_len;
+
+static void persist_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(persist_work, persist_work_fn);
+
+static void stats_add(uint32_t *counter, uint32_t value)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	*counter += value;
+	k_spin_unlock(&lock, key);
+}
+
+static bool nv_enabled(void)
+{
+	return ring_ready;
+}
+
+static bool nv_has_event(size_t *event_size)
+{
+	uint32_t start = k_cycle_get_32();
+	bool found = (flash_ring_head(&ring, &head_len) == 0);
+
+	stats_add(&stats.read_us, k_cyc_to_us_floor32(k_cycle_get_32() - start));
+
+	if (found) {
+		*event_size = head_len;
+	}
+
+	return found;
+}
+
+static bool nv_read(uint32_t offset, void *buf, size_t buf_len)
+{
+	uint32_t start = k_cycle_get_32();
+	int err = flash_ring_read(&ring, offset, buf, buf_len);
+
+	stats_add(&stats.read_us, k_cyc_to_us_floor32(k_cycle_get_32() - start));
+
+	if (err) {
+		LOG_ERR("Failed to read event: %d", err);
+		return false;
+	}
+
+	return true;
+}
+
+static void nv_consume(void)
+{
+	if (flash_ring_consume(&ring) == 0) {
+		stats_add(&stats.drained_bytes, head_len);
+	}
+}
+
+static int event_source(void *ctx, size_t off, void *buf, size_t len)
+{
+	MemfaultEventReadCallback reader = *(MemfaultEventReadCallback *)ctx;
+
+	return reader(off, buf, len) ? 0 : -EIO;
+}
+
+static bool nv_write(MemfaultEventReadCallback reader, size_t total_size)
+{
+	int err = flash_ring_append_stream(&ring, total_size, event_source, &reader);
+
+	if (err) {
+		/* The event stays in RAM and is retried on the next flush */
+		LOG_ERR("Failed to store %zu byte event: %d", total_size, err);
+		return false;
+	}
+
+	stats_add(&stats.event_bytes, total_size);
+	return true;
+}
+
+/* Overrides the default of the Memfault SDK, which keeps events in RAM only */
+const sMemfaultNonVolatileEventStorageImpl g_memfault_platform_nv_event_storage_impl = {
+	.enabled = nv_enabled,
+	.has_event = nv_has_event,
+	.read = nv_read,
+	.consume = nv_consume,
+	.write = nv_write,
+};
+
+static void persist_work_fn(struct k_work *work)
+{
+	int count;
+
+	ARG_UNUSED(work);
+
+	count = memfault_event_storage_persist();
+	if (count > 0) {
+		LOG_DBG("Moved %d event(s) to flash, %u stored", count, flash_ring_count(&ring));
+	}
+}
+
+void memfault_event_storage_request_persist_callback(const sMemfaultEventStorageInfo *storage_info)
+{
+	size_t size = storage_info->bytes_used + storage_info->bytes_free;
+
+	if (!ring_ready) {
+		return;
+	}
+
+	if (storage_info->bytes_used * 100 >= size * CONFIG_MFLT_EVENT_STORAGE_FLUSH_THRESHOLD_PERCENT) {
+		(void)k_work_reschedule(&persist_work, K_NO_WAIT);
+	} else {
+		/* No-op if already scheduled, the delay counts from the first event */
+		(void)k_work_schedule(&persist_work,
+				      K_SECONDS(CONFIG_MFLT_EVENT_STORAGE_FLUSH_DELAY_SEC));
+	}
+}
+
+void mflt_event_storage_collect(void)
+{
+	struct nv_stats interval;
+	uint32_t programmed;
+	uint32_t erases;
+	uint32_t dropped;
+	k_spinlock_key_t key;
+
+	if (!ring_ready) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	interval = stats;
+	stats = (struct nv_stats){0};
+	k_spin_unlock(&lock, key);
+
+	programmed = flash_ring_bytes_programmed(&ring) - last_programmed;
+	erases = flash_ring_erase_count(&ring) - last_erases;
+	dropped = flash_ring_dropped(&ring) - last_dropped;
+	last_programmed += programmed;
+	last_erases += erases;
+	last_dropped += dropped;
+
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_nv_event_count, flash_ring_count(&ring));
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_nv_event_drop_count, dropped);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_nv_erase_count, erases);
+
+	/* Flash bytes programmed per event byte, leave unset without writes */
+	if (interval.event_bytes > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(
+			mflt_nv_write_amp_permille,
+			(uint32_t)((uint64_t)programmed * 1000 / interval.event_bytes));
+	}
+
+	if (interval.read_us > 0 && interval.drained_bytes > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(
+			mflt_nv_drain_bps,
+			(uint32_t)((uint64_t)interval.drained_bytes * 8 * USEC_PER_SEC /
+				   interval.read_us));
+	}
+
+	LOG_INF("Flash event storage - stored: %u, written: %u B, programmed: %u B, "
+		"erases: %u, drained: %u B, dropped: %u",
+		flash_ring_count(&ring), interval.event_bytes, programmed, erases,
+		interval.drained_bytes, dropped);
+}
+
+/* Runs before the Memfault SDK initializes, so events captured at boot
+ * already go to flash
+ */
+static int event_storage_init(void)
+{
+	int err;
+
+	err = flash_ring_init(&ring, FIXED_PARTITION_ID(mflt_event_storage));
+	if (err) {
+		LOG_ERR("Flash event storage unavailable, err %d, keeping events in RAM", err);
+		return 0;
+	}
+
+	if (flash_ring_count(&ring) > 0) {
+		LOG_INF("%u event(s) stored before reboot", flash_ring_count(&ring));
+	}
+
+	last_programmed = flash_ring_bytes_programmed(&ring);
+	last_erases = flash_ring_erase_count(&ring);
+	ring_ready = true;
+
+	return 0;
+}
+
+SYS_INIT(event_storage_init, APPLICATION, CONFIG_MFLT_EVENT_STORAGE_INIT_PRIORITY);
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Publish the flash event storage statistics of the elapsed heartbeat interval
+ *
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void mflt_event_storage_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Log flight recorder.
+ *
+ * Logs stay in the capture buffers and are not part of the periodic
+ * uploads. An incident (trace event, connectivity loss, metric threshold,
+ * reboot after a fault) opens a window: CONFIG_MFLT_FLIGHT_REC_POST_SEC
+ * later the dictionary log records from CONFIG_MFLT_FLIGHT_REC_PRE_SEC
+ * before the incident and the Memfault text log buffer are frozen and an
+ * upload is requested. In steady state no logs are uploaded at all.
+ *
+ * The dictionary log records are a CDR and only frozen if the CDR budget
+ * shared with the nRF70 FW stats allows it, otherwise only the text log is
+ * uploaded.
+ *
+ * After a fault the window covers all retained records of the previous
+ * boot (CONFIG_MFLT_DICT_LOG_RETAIN) up to the end of the post window.
+ *
+ * Trace events are only seen when captured with MFLT_TRACE_EVENT() or
+ * MFLT_TRACE_EVENT_WITH_LOG(), plain MEMFAULT_TRACE_EVENT*() calls do not
+ * open a window.
+ */
+
+#include "mflt_flight_rec.h"
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <memfault/core/log.h>
+#include <memfault/core/reboot_tracking.h>
+#include <memfault/metrics/metrics.h>
+
+#include "mflt_upload_sched.h"
+#include "net_events.h"
+
+#ifdef CONFIG_MFLT_DICT_LOG
+#include "mflt_cdr_budget.h"
+#include "mflt_dict_log.h"
+#endif
+
+LOG_MODULE_REGISTER(mflt_flight_rec, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+/* Also the CDR collection reasons */
+static const char *const trigger_names[] = {
+	[MFLT_FLIGHT_REC_TRACE_EVENT] = "flight_rec_trace_event",
+	[MFLT_FLIGHT_REC_CONN_LOST] = "flight_rec_conn_lost",
+	[MFLT_FLIGHT_REC_THRESHOLD] = "flight_rec_threshold",
+	[MFLT_FLIGHT_REC_FAULT] = "flight_rec_fault",
+};
+
+BUILD_ASSERT(ARRAY_SIZE(trigger_names) == MFLT_FLIGHT_REC_TRIGGER_COUNT);
+
+/* Totals of the elapsed heartbeat interval */
+struct flight_rec_stats {
+	uint32_t triggers;
+	uint32_t captures;
+};
+
+static struct k_spinlock lock;
+static struct flight_rec_stats stats;
+
+/* Window state */
+static bool window_open;
+static enum mflt_flight_rec_trigger window_trigger;
+static uint32_t window_start_ms;
+static int64_t holdoff_until;
+
+static void capture_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(capture_work, capture_work_fn);
+
+static void capture_work_fn(struct k_work *work)
+{
+	enum mflt_flight_rec_trigger trigger;
+	uint32_t since_ms;
+	k_spinlock_key_t key;
+
+	ARG_UNUSED(work);
+
+	key = k_spin_lock(&lock);
+	trigger = window_trigger;
+	since_ms = window_start_ms;
+	k_spin_unlock(&lock, key);
+
+	LOG_INF("Flight recorder window closed (%s)", trigger_names[trigger]);
+
+#ifdef CONFIG_MFLT_DICT_LOG
+	int err = mflt_cdr_budget_take(trigger_names[trigger]);
+
+	if (!err) {
+		err = mflt_dict_log_freeze(since_ms, trigger_names[trigger]);
+		if (err) {
+			LOG_WRN("Dictionary log window not collected: %d", err);
+			mflt_cdr_budget_give_back();
+		}
+	}
+#else
+	ARG_UNUSED(since_ms);
+#endif
+
+#ifdef CONFIG_MEMFAULT_LOGGING_ENABLE
+	/* The text buffer is uploaded whole, it is not a CDR */
+	memfault_log_trigger_collection();
+#endif
+
+	key = k_spin_lock(&lock);
+	window_open = false;
+	holdoff_until = k_uptime_get() + CONFIG_MFLT_FLIGHT_REC_HOLDOFF_SEC * MSEC_PER_SEC;
+	stats.captures++;
+	k_spin_unlock(&lock, key);
+
+	mflt_upload_sched_request(MFLT_UPLOAD_TRIGGER_INCIDENT, false);
+}
+
+void mflt_flight_rec_trigger(enum mflt_flight_rec_trigger trigger)
+{
+	const uint32_t pre_ms = CONFIG_MFLT_FLIGHT_REC_PRE_SEC * MSEC_PER_SEC;
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key;
+
+	if (trigger >= MFLT_FLIGHT_REC_TRIGGER_COUNT) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+
+	stats.triggers++;
+
+	if (window_open || now < holdoff_until) {
+		k_spin_unlock(&lock, key);
+		return;
+	}
+
+	window_open = true;
+	window_trigger = trigger;
+
+	/* 0 includes the records retained from the previous boot, 1 starts at this boot */
+	if (trigger == MFLT_FLIGHT_REC_FAULT) {
+		window_start_ms = 0;
+	} else {
+		window_start_ms = MAX((uint32_t)now, pre_ms + 1) - pre_ms;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	LOG_INF("Flight recorder triggered (%s)", trigger_names[trigger]);
+	k_work_schedule(&capture_work, K_SECONDS(CONFIG_MFLT_FLIGHT_REC_POST_SEC));
+}
+
+void mflt_flight_rec_collect(void)
+{
+	struct flight_rec_stats s;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	s = stats;
+	stats = (struct flight_rec_stats){0};
+
+	k_spin_unlock(&lock, key);
+
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_flight_rec_trigger_count, s.triggers);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_flight_rec_capture_count, s.captures);
+}
+
+static void on_network_change(bool connected)
+{
+	/* Upload the logs around the loss once reconnected */
+	if (!connected) {
+		mflt_flight_rec_trigger(MFLT_FLIGHT_REC_CONN_LOST);
+	}
+}
+
+NET_EVENTS_SUB_DEFINE(flight_rec_sub, on_network_change);
+
+static int flight_rec_init(void)
+{
+	bool unexpected = false;
+
+	net_events_subscribe(&flight_rec_sub);
+
+	if (memfault_reboot_tracking_get_unexpected_reboot_occurred(&unexpected) == 0 &&
+	    unexpected) {
+		mflt_flight_rec_trigger(MFLT_FLIGHT_REC_FAULT);
+	}
+
+	return 0;
+}
+
+SYS_INIT(flight_rec_init, APPLICATION, CONFIG_MFLT_FLIGHT_REC_INIT_PRIORITY);
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <memfault/core/trace_event.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Incidents that make the flight recorder upload its logs. */
+enum mflt_flight_rec_trigger {
+	MFLT_FLIGHT_REC_TRACE_EVENT,
+	MFLT_FLIGHT_REC_CONN_LOST,
+	MFLT_FLIGHT_REC_THRESHOLD,
+	MFLT_FLIGHT_REC_FAULT,
+	MFLT_FLIGHT_REC_TRIGGER_COUNT,
+};
+
+/**
+ * @brief Report an incident.
+ *
+ * CONFIG_MFLT_FLIGHT_REC_POST_SEC later the logs of the window from
+ * CONFIG_MFLT_FLIGHT_REC_PRE_SEC before the first incident are frozen and
+ * uploaded. Incidents while a window is open or within
+ * CONFIG_MFLT_FLIGHT_REC_HOLDOFF_SEC after it are only counted.
+ *
+ * May be called from any context.
+ *
+ * @param trigger What happened.
+ */
+void mflt_flight_rec_trigger(enum mflt_flight_rec_trigger trigger);
+
+/**
+ * @brief Capture a trace event and report it as an incident.
+ *
+ * The Memfault SDK has no hook for captured trace events, so only trace
+ * events captured through these macros open a window. Without
+ * CONFIG_MFLT_FLIGHT_REC they only capture the event.
+ */
+#ifdef CONFIG_MFLT_FLIGHT_REC
+#define MFLT_TRACE_EVENT(reason)                                                                   \
+	do {                                                                                       \
+		MEMFAULT_TRACE_EVENT(reason);                                                      \
+		mflt_flight_rec_trigger(MFLT_FLIGHT_REC_TRACE_EVENT);                              \
+	} while (0)
+
+#define MFLT_TRACE_EVENT_WITH_LOG(reason, ...)                                                     \
+	do {                                                                                       \
+		MEMFAULT_TRACE_EVENT_WITH_LOG(reason, __VA_ARGS__);                                \
+		mflt_flight_rec_trigger(MFLT_FLIGHT_REC_TRACE_EVENT);                              \
+	} while (0)
+#else
+#define MFLT_TRACE_EVENT(reason)               MEMFAULT_TRACE_EVENT(reason)
+#define MFLT_TRACE_EVENT_WITH_LOG(reason, ...) MEMFAULT_TRACE_EVENT_WITH_LOG(reason, __VA_ARGS__)
+#endif
+
+/**
+ * @brief Publish the flight recorder statistics of the elapsed heartbeat interval
+ *
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void mflt_flight_rec_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
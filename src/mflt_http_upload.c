@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * HTTPS transport for Memfault chunks.
+ *
+ * memfault_zephyr_port_post_data() resolves, connects and completes a TLS
+ * handshake for every upload, then posts one chunk per request. Here the
+ * socket opened by the Memfault port is kept between sessions and the
+ * request is written directly: several chunks per request as
+ * multipart/mixed, with the header and body in one send so a request fits a
+ * single TLS record and a whole number of TCP segments.
+ */
+
+#include "mflt_http_upload.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/socket.h>
+#include <memfault/core/platform/device_info.h>
+#include <memfault/http/http_client.h>
+#include <memfault/http/utils.h>
+#include <memfault/metrics/connectivity.h>
+#include <memfault/ports/zephyr/http.h>
+
+#include "mflt_drain.h"
+
+LOG_MODULE_REGISTER(mflt_http_upload, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define BOUNDARY "mflt-3f9c1e7a5b2d4860-chunk"
+#define PART_HEADER_FMT                                                                            \
+	"--" BOUNDARY "\r\nContent-Type: application/octet-stream\r\nContent-Length: %zu\r\n\r\n"
+#define PART_HEADER_MAX 128
+#define PART_TRAILER "\r\n"
+#define CLOSE_DELIMITER "--" BOUNDARY "--\r\n"
+
+/* Room for the request line and headers in front of the body */
+#define REQ_HEADER_MAX 256
+
+/* Chunks smaller than this are not worth a part of their own */
+#define MIN_CHUNK_LEN 128
+
+/* Upper estimates of the TLS record and TCP/IPv4 header sizes */
+#define TLS_RECORD_OVERHEAD 29
+#define TCP_IP_OVERHEAD 40
+
+#define RESPONSE_TIMEOUT_SEC 10
+
+/* All state is owned by the upload workqueue */
+static uint8_t req_buf[REQ_HEADER_MAX + CONFIG_MFLT_UPLOAD_REQUEST_SIZE];
+static uint8_t *const body = &req_buf[REQ_HEADER_MAX];
+static uint8_t chunk_buf[CONFIG_MFLT_UPLOAD_CHUNK_SIZE];
+
+/* Parts drained but not yet accepted by the server */
+static size_t body_len;
+static size_t body_limit = CONFIG_MFLT_UPLOAD_REQUEST_SIZE;
+
+static sMemfaultHttpContext ctx;
+static bool connected;
+
+/* Keep the built-in memfault_sync_success metrics that
+ * memfault_zephyr_port_post_data() would record
+ */
+static void sync_result(int err)
+{
+#ifdef CONFIG_MEMFAULT_METRICS_MEMFAULT_SYNC_SUCCESS
+	if (err) {
+		memfault_metrics_connectivity_record_memfault_sync_failure();
+	} else {
+		memfault_metrics_connectivity_record_memfault_sync_success();
+	}
+#else
+	ARG_UNUSED(err);
+#endif
+}
+
+/* Largest body that keeps the request within one TLS record and ends on a
+ * TCP segment boundary of the interface MTU
+ */
+static size_t request_limit(void)
+{
+	struct net_if *iface = net_if_get_default();
+	size_t limit = CONFIG_MFLT_UPLOAD_REQUEST_SIZE;
+	size_t segment;
+	size_t wire;
+
+#ifdef CONFIG_MBEDTLS_SSL_OUT_CONTENT_LEN
+	limit = MIN(limit, CONFIG_MBEDTLS_SSL_OUT_CONTENT_LEN - REQ_HEADER_MAX);
+#endif
+
+	if (iface && net_if_get_mtu(iface) > TCP_IP_OVERHEAD + REQ_HEADER_MAX) {
+		segment = net_if_get_mtu(iface) - TCP_IP_OVERHEAD;
+		wire = REQ_HEADER_MAX + limit + TLS_RECORD_OVERHEAD;
+		if (wire > segment) {
+			limit -= wire % segment;
+		}
+	}
+
+	LOG_DBG("Request body limit %zu bytes", limit);
+	return limit;
+}
+
+static int connection_open(void)
+{
+	struct zsock_timeval timeout = {
+		.tv_sec = RESPONSE_TIMEOUT_SEC,
+	};
+	int err;
+
+	err = memfault_zephyr_port_http_open_socket(&ctx);
+	if (err) {
+		return err;
+	}
+
+	(void)zsock_setsockopt(ctx.sock_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	connected = true;
+	body_limit = request_limit();
+	return 0;
+}
+
+/* Append drained chunks to the pending body while another one fits */
+static void body_fill(void)
+{
+	const size_t overhead = PART_HEADER_MAX + strlen(PART_TRAILER) + strlen(CLOSE_DELIMITER);
+	size_t len;
+	int hdr_len;
+
+	while (body_len + overhead + MIN_CHUNK_LEN <= body_limit) {
+		len = MIN(sizeof(chunk_buf), body_limit - body_len - overhead);
+		if (!mflt_drain_get_chunk(chunk_buf, &len)) {
+			return;
+		}
+
+		hdr_len = snprintk((char *)&body[body_len], PART_HEADER_MAX, PART_HEADER_FMT, len);
+		body_len += hdr_len;
+		memcpy(&body[body_len], chunk_buf, len);
+		body_len += len;
+		memcpy(&body[body_len], PART_TRAILER, strlen(PART_TRAILER));
+		body_len += strlen(PART_TRAILER);
+	}
+}
+
+static int send_all(const uint8_t *data, size_t len)
+{
+	ssize_t sent;
+
+	while (len > 0) {
+		sent = zsock_send(ctx.sock_fd, data, len, 0);
+		if (sent < 0) {
+			return -errno;
+		}
+
+		data += sent;
+		len -= sent;
+	}
+
+	return 0;
+}
+
+static int response_read(void)
+{
+	sMemfaultHttpResponseContext rsp = {0};
+	uint8_t buf[64];
+	ssize_t len;
+
+	do {
+		len = zsock_recv(ctx.sock_fd, buf, sizeof(buf), 0);
+		if (len < 0) {
+			return -errno;
+		}
+
+		if (len == 0) {
+			return -ECONNRESET;
+		}
+	} while (!memfault_http_parse_response(&rsp, buf, len));
+
+	if (rsp.parse_error) {
+		return -EBADMSG;
+	}
+
+	if (rsp.http_status_code < 200 || rsp.http_status_code >= 300) {
+		LOG_ERR("Chunks endpoint returned HTTP %d", rsp.http_status_code);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int request_send(void)
+{
+	sMemfaultDeviceInfo info;
+	char header[REQ_HEADER_MAX];
+	size_t len = body_len;
+	int hdr_len;
+	int err;
+
+	memfault_platform_get_device_info(&info);
+
+	memcpy(&body[len], CLOSE_DELIMITER, strlen(CLOSE_DELIMITER));
+	len += strlen(CLOSE_DELIMITER);
+
+	hdr_len = snprintk(header, sizeof(header),
+			   "POST /api/v0/chunks/%s HTTP/1.1\r\n"
+			   "Host: %s\r\n"
+			   "Memfault-Project-Key: %s\r\n"
+			   "Content-Type: multipart/mixed; boundary=" BOUNDARY "\r\n"
+			   "Content-Length: %zu\r\n"
+			   "\r\n",
+			   info.device_serial, MEMFAULT_HTTP_GET_CHUNKS_API_HOST(),
+			   g_mflt_http_client_config.api_key, len);
+	if ((hdr_len < 0) || (hdr_len >= sizeof(header))) {
+		return -ENOMEM;
+	}
+
+	/* Header right in front of the body, the request goes out in one send */
+	memcpy(body - hdr_len, header, hdr_len);
+
+	err = send_all(body - hdr_len, hdr_len + len);
+	if (!err) {
+		err = response_read();
+	}
+
+	if (!err) {
+		LOG_DBG("Posted %zu byte request", len);
+		body_len = 0;
+	}
+
+	return err;
+}
+
+void mflt_http_upload_init(void)
+{
+	/* Only defined when CONFIG_MFLT_UPLOAD_CHUNKS_HOST is set */
+#ifdef CONFIG_MFLT_UPLOAD_CHUNKS_PORT
+	g_mflt_http_client_config.chunks_api.host = CONFIG_MFLT_UPLOAD_CHUNKS_HOST;
+	g_mflt_http_client_config.chunks_api.port = CONFIG_MFLT_UPLOAD_CHUNKS_PORT;
+	g_mflt_http_client_config.disable_tls = IS_ENABLED(CONFIG_MFLT_UPLOAD_CHUNKS_NO_TLS);
+
+	LOG_WRN("Memfault chunks endpoint overridden: %s:%d", CONFIG_MFLT_UPLOAD_CHUNKS_HOST,
+		CONFIG_MFLT_UPLOAD_CHUNKS_PORT);
+#endif
+}
+
+int mflt_http_upload_session(void)
+{
+	int64_t start = k_uptime_get();
+	uint32_t setup_ms = 0;
+	/* Only a connection reused from an earlier session is replaced */
+	bool reconnected = !connected;
+	int err = 0;
+
+	if (!connected) {
+		err = connection_open();
+		if (err) {
+			LOG_ERR("Failed to connect to Memfault: %d", err);
+			mflt_drain_record_retry();
+			sync_result(err);
+			return err;
+		}
+
+		setup_ms = (uint32_t)(k_uptime_get() - start);
+	}
+
+	mflt_drain_session_begin(setup_ms);
+
+	while (true) {
+		body_fill();
+		if (body_len == 0) {
+			break;
+		}
+
+		err = request_send();
+		if (err && !reconnected) {
+			/* The server may have closed the idle connection */
+			LOG_INF("Warm connection failed (%d), reconnecting", err);
+			mflt_http_upload_close();
+			reconnected = true;
+
+			err = connection_open();
+			if (!err) {
+				err = request_send();
+			}
+		}
+
+		if (err) {
+			/* The body is kept for the next session */
+			LOG_ERR("Failed to post chunks: %d", err);
+			mflt_drain_record_retry();
+			mflt_http_upload_close();
+			break;
+		}
+	}
+
+	mflt_drain_session_end();
+
+	if (!IS_ENABLED(CONFIG_MFLT_UPLOAD_WARM_CONNECTION)) {
+		mflt_http_upload_close();
+	}
+
+	sync_result(err);
+	return err;
+}
+
+void mflt_http_upload_close(void)
+{
+	if (!connected) {
+		return;
+	}
+
+	memfault_zephyr_port_http_close_socket(&ctx);
+	connected = false;
+	LOG_DBG("Connection to Memfault closed");
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Apply the chunks endpoint override, CONFIG_MFLT_UPLOAD_CHUNKS_HOST.
+ */
+void mflt_http_upload_init(void);
+
+/**
+ * @brief Upload one drain session to the Memfault chunks endpoint.
+ *
+ * Chunks are sent several per request as multipart/mixed. With
+ * CONFIG_MFLT_UPLOAD_WARM_CONNECTION the connection stays open after the
+ * session and is reused by the next one. A stale connection is replaced
+ * once per session. A request that still fails is kept and sent first by
+ * the next session, so no data read from the packetizer is lost.
+ *
+ * Must only be called from the upload workqueue.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int mflt_http_upload_session(void);
+
+/**
+ * @brief Close the connection kept open between sessions.
+ *
+ * Must only be called from the upload workqueue.
+ */
+void mflt_http_upload_close(void);
+
+#ifdef __cplusplus
+}
+#endif
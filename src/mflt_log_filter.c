@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Deduplication and rate limiting of captured log messages.
+ *
+ * A message with the same source, level and cbprintf package (format string
+ * and arguments) as the previous captured one is counted rather than
+ * captured, and the count is recorded in front of the next different
+ * message, or when the records are frozen for collection. Each call site, identified by its format string, spends a token
+ * per captured message from a bucket that refills at a fixed rate, so a
+ * message logged in a loop cannot push the rest of the history out of the
+ * capture buffer. Call sites share a small table, the least recently
+ * logged one is replaced by a new one.
+ */
+
+#include "mflt_log_filter.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/cbprintf.h>
+#include <zephyr/sys/crc.h>
+#include <memfault/metrics/metrics.h>
+
+/* Tokens are counted in 1/60000, a call site earns RATE_PER_MIN per ms */
+#define TOKEN 60000U
+#define BUCKET_SIZE ((uint32_t)CONFIG_MFLT_LOG_FILTER_BURST * TOKEN)
+
+BUILD_ASSERT(CONFIG_MFLT_LOG_FILTER_BURST <= UINT32_MAX / TOKEN);
+
+struct call_site {
+	const void *key;
+	uint32_t tokens;
+	uint32_t last_ms;
+};
+
+/* Totals of the elapsed heartbeat interval */
+struct filter_stats {
+	uint32_t repeats;
+	uint32_t limited;
+};
+
+static struct k_spinlock lock;
+static struct filter_stats stats;
+
+/* Owned by the log processing context */
+static struct call_site sites[CONFIG_MFLT_LOG_FILTER_SITES];
+
+/* Previous captured message, also flushed at collections, under lock */
+static uint32_t last_hash;
+static bool have_last;
+static uint32_t last_repeats;
+
+static void stats_add(uint32_t *counter)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	(*counter)++;
+
+	k_spin_unlock(&lock, key);
+}
+
+static uint32_t msg_hash(struct log_msg *msg)
+{
+	const void *source = log_msg_get_source(msg);
+	uint8_t level = log_msg_get_level(msg);
+	uint32_t hash;
+	uint8_t *data;
+	size_t len;
+
+	hash = crc32_ieee_update(0, (const uint8_t *)&source, sizeof(source));
+	hash = crc32_ieee_update(hash, &level, sizeof(level));
+
+	data = log_msg_get_package(msg, &len);
+	hash = crc32_ieee_update(hash, data, len);
+
+	data = log_msg_get_data(msg, &len);
+	return crc32_ieee_update(hash, data, len);
+}
+
+/* Format string of the message, its source for hexdumps without one */
+static const void *msg_site(struct log_msg *msg)
+{
+	const char *fmt = NULL;
+	uint8_t *package;
+	size_t len;
+
+	/* A cbprintf package starts with its header, followed by the format string pointer */
+	package = log_msg_get_package(msg, &len);
+	if (len >= sizeof(union cbprintf_package_hdr) + sizeof(fmt)) {
+		memcpy(&fmt, &package[sizeof(union cbprintf_package_hdr)], sizeof(fmt));
+	}
+
+	return fmt ? (const void *)fmt : log_msg_get_source(msg);
+}
+
+static bool site_take(const void *key)
+{
+	uint32_t now = k_uptime_get_32();
+	struct call_site *site = &sites[0];
+	uint64_t tokens;
+
+	/* Sites are never freed, the unused ones are at the end */
+	for (size_t i = 0; i < ARRAY_SIZE(sites); i++) {
+		if (sites[i].key == key || sites[i].key == NULL) {
+			site = &sites[i];
+			break;
+		}
+
+		/* Otherwise replace the least recently logged call site */
+		if ((now - sites[i].last_ms) > (now - site->last_ms)) {
+			site = &sites[i];
+		}
+	}
+
+	if (site->key != key) {
+		site->key = key;
+		site->tokens = BUCKET_SIZE;
+	} else {
+		tokens = site->tokens +
+			 (uint64_t)(now - site->last_ms) * CONFIG_MFLT_LOG_FILTER_RATE_PER_MIN;
+		site->tokens = MIN(tokens, BUCKET_SIZE);
+	}
+
+	site->last_ms = now;
+
+	if (site->tokens < TOKEN) {
+		return false;
+	}
+
+	site->tokens -= TOKEN;
+	return true;
+}
+
+enum mflt_log_filter_verdict mflt_log_filter_check(struct log_msg *msg, uint32_t *repeats)
+{
+	uint32_t hash = msg_hash(msg);
+	k_spinlock_key_t key;
+	bool repeat;
+
+	*repeats = 0;
+
+	key = k_spin_lock(&lock);
+	repeat = have_last && hash == last_hash;
+	if (repeat) {
+		last_repeats++;
+		stats.repeats++;
+	}
+	k_spin_unlock(&lock, key);
+
+	if (repeat) {
+		return MFLT_LOG_FILTER_REPEAT;
+	}
+
+	if (log_msg_get_level(msg) != LOG_LEVEL_ERR && !site_take(msg_site(msg))) {
+		stats_add(&stats.limited);
+		return MFLT_LOG_FILTER_LIMITED;
+	}
+
+	key = k_spin_lock(&lock);
+	*repeats = last_repeats;
+	last_repeats = 0;
+	last_hash = hash;
+	have_last = true;
+	k_spin_unlock(&lock, key);
+
+	return MFLT_LOG_FILTER_PASS;
+}
+
+uint32_t mflt_log_filter_flush(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	uint32_t repeats = last_repeats;
+
+	last_repeats = 0;
+	have_last = false;
+
+	k_spin_unlock(&lock, key);
+
+	return repeats;
+}
+
+void mflt_log_filter_collect(void)
+{
+	struct filter_stats s;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	s = stats;
+	stats = (struct filter_stats){0};
+
+	k_spin_unlock(&lock, key);
+
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_log_repeat_count, s.repeats);
+	MEMFAULT_METRIC_SET_UNSIGNED(mflt_log_limited_count, s.limited);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/logging/log_msg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum mflt_log_filter_verdict {
+	/* Capture the message */
+	MFLT_LOG_FILTER_PASS,
+	/* Same call site and arguments as the previous message */
+	MFLT_LOG_FILTER_REPEAT,
+	/* Call site over its rate */
+	MFLT_LOG_FILTER_LIMITED,
+};
+
+/**
+ * @brief Decide whether a log message is captured.
+ *
+ * Repeats of the previous message are counted instead of captured. Every
+ * call site (format string) has a token bucket of
+ * CONFIG_MFLT_LOG_FILTER_BURST messages refilled at
+ * CONFIG_MFLT_LOG_FILTER_RATE_PER_MIN; errors are never rate limited.
+ *
+ * Must only be called from the log processing context.
+ *
+ * @param msg Log message about to be captured.
+ * @param repeats Set for MFLT_LOG_FILTER_PASS: repeats of the previous
+ *                message suppressed since it was captured, to be recorded
+ *                before this message.
+ *
+ * @return Verdict for the message
+ */
+enum mflt_log_filter_verdict mflt_log_filter_check(struct log_msg *msg, uint32_t *repeats);
+
+/**
+ * @brief Take the repeats of the previous message that are not recorded yet.
+ *
+ * Called before the captured records are frozen for collection, so the
+ * repeats go out with the message they belong to. The next occurrence of
+ * the message is captured again. Callable from any thread.
+ *
+ * @return Repeats to be recorded now, 0 if none.
+ */
+uint32_t mflt_log_filter_flush(void);
+
+/**
+ * @brief Publish the suppressed message counts of the elapsed heartbeat interval
+ */
+void mflt_log_filter_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
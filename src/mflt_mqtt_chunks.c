@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Memfault chunk transport over the MQTT broker connection.
+ *
+ * Each chunk is read into one of CONFIG_MFLT_MQTT_CHUNKS_WINDOW slots and
+ * published without a copy. A slot is only released on PUBACK, so at most
+ * that many chunks are outstanding and the rest of the data stays in Memfault
+ * storage until the broker catches up. A chunk the MQTT client gave up on is
+ * submitted again from its slot ahead of the chunks read after it, so nothing
+ * read from the packetizer is lost or reordered across disconnects.
+ *
+ * An upload session ends once the packetizer has no more data and the last
+ * chunk was acknowledged, so its statistics cover delivered chunks only.
+ */
+
+#include "mflt_mqtt_chunks.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <hw_id.h>
+
+#include "mflt_drain.h"
+#include "mqtt_client.h"
+
+LOG_MODULE_REGISTER(mflt_mqtt_chunks, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define CHUNKS_TOPIC_SUFFIX "chunks"
+
+struct chunk_slot {
+	struct app_mqtt_msg msg;
+	/* Set from the packetizer read until the PUBACK */
+	atomic_t busy;
+	uint8_t buf[CONFIG_MFLT_MQTT_CHUNKS_SIZE];
+};
+
+static struct chunk_slot slots[CONFIG_MFLT_MQTT_CHUNKS_WINDOW];
+/* Set from mflt_mqtt_chunks_post() until the session is ended */
+static atomic_t session_open;
+
+static char topic[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE + sizeof(CHUNKS_TOPIC_SUFFIX)];
+static size_t topic_len;
+
+static void drain_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(drain_work, drain_work_fn);
+
+static void chunk_published(struct app_mqtt_msg *msg, int result)
+{
+	struct chunk_slot *slot = CONTAINER_OF(msg, struct chunk_slot, msg);
+
+	if (result) {
+		LOG_WRN("Chunk not acknowledged (%d), resubmitting", result);
+		mflt_drain_record_retry();
+		if (app_mqtt_client_republish_msg(msg) == 0) {
+			return;
+		}
+	}
+
+	atomic_clear(&slot->busy);
+
+	/* A window slot is free, continue with the next chunk */
+	(void)k_work_reschedule(&drain_work, K_NO_WAIT);
+}
+
+static struct chunk_slot *slot_claim(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(slots); i++) {
+		if (atomic_cas(&slots[i].busy, 0, 1)) {
+			return &slots[i];
+		}
+	}
+
+	return NULL;
+}
+
+static bool slots_idle(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(slots); i++) {
+		if (atomic_get(&slots[i].busy)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void drain_work_fn(struct k_work *work)
+{
+	struct chunk_slot *slot;
+	size_t len;
+	int err;
+
+	ARG_UNUSED(work);
+
+	while (true) {
+		slot = slot_claim();
+		if (!slot) {
+			/* Window full, resumed from chunk_published() */
+			return;
+		}
+
+		len = sizeof(slot->buf);
+		if (!mflt_drain_get_chunk(slot->buf, &len)) {
+			atomic_clear(&slot->busy);
+			break;
+		}
+
+		slot->msg = (struct app_mqtt_msg){
+			.topic = topic,
+			.topic_len = topic_len,
+			.payload = slot->buf,
+			.payload_len = len,
+			.cb = chunk_published,
+		};
+
+		err = app_mqtt_client_publish_msg(&slot->msg);
+		if (err) {
+			/* Only fails on invalid arguments, the message is sent again later */
+			LOG_ERR("Failed to submit chunk: %d", err);
+			mflt_drain_chunk_failed();
+			atomic_clear(&slot->busy);
+			break;
+		}
+
+		LOG_DBG("Submitted %zu byte chunk", len);
+	}
+
+	/* Chunks still in flight end the session from their PUBACK */
+	if (slots_idle() && atomic_cas(&session_open, 1, 0)) {
+		mflt_drain_session_end();
+	}
+}
+
+int mflt_mqtt_chunks_init(void)
+{
+	char hw_id[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE];
+	int len;
+	int err;
+
+	err = hw_id_get(hw_id, sizeof(hw_id));
+	if (err) {
+		LOG_ERR("Failed to get device ID: %d", err);
+		return err;
+	}
+
+	len = snprintk(topic, sizeof(topic), "Memfault/%s/%s", hw_id, CHUNKS_TOPIC_SUFFIX);
+	if ((len < 0) || (len >= sizeof(topic))) {
+		LOG_ERR("Chunks topic buffer too small");
+		return -ENOMEM;
+	}
+
+	topic_len = len;
+
+	LOG_INF("Memfault chunks topic: %s", topic);
+	return 0;
+}
+
+void mflt_mqtt_chunks_post(void)
+{
+	if (topic_len == 0) {
+		LOG_WRN("Memfault chunks transport not initialized");
+		return;
+	}
+
+	/* Chunks go over the open broker connection, no setup. A session still
+	 * waiting for PUBACKs is continued.
+	 */
+	if (atomic_cas(&session_open, 0, 1)) {
+		mflt_drain_session_begin(0);
+	}
+	(void)k_work_reschedule(&drain_work, K_NO_WAIT);
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start draining Memfault data over the MQTT connection.
+ *
+ * Chunks from the Memfault packetizer are published to
+ * Memfault/<device ID>/chunks whenever mflt_mqtt_chunks_post() is called, until
+ * the packetizer is empty. A bridge forwards them to the Memfault chunks API,
+ * see script/mqtt_chunk_bridge.py.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int mflt_mqtt_chunks_init(void);
+
+/**
+ * @brief Drain the data captured so far, in place of memfault_zephyr_port_post_data().
+ */
+void mflt_mqtt_chunks_post(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -32,6 +32,8 @@
 #include "memfault/components.h"
 #include "memfault/core/data_packetizer.h"
 
+#include "mflt_cdr_budget.h"
+
 /* External reference to the global nRF70 driver context (same as wifi_util.c) */
 extern struct nrf_wifi_drv_priv_zep rpu_drv_priv_zep;
 
@@ -224,8 +226,14 @@ int mflt_nrf70_fw_stats_cdr_collect(void)
 {
 	int err;
 
+	/* Overwriting pending data does not add a CDR, failing to collect frees it */
 	if (s_cdr_data_ready) {
 		LOG_WRN("Previous CDR data not yet uploaded, overwriting");
+	} else {
+		err = mflt_cdr_budget_take(s_nrf70_fw_stats_metadata.collection_reason);
+		if (err) {
+			return err;
+		}
 	}
 
 	/* Reset state */
@@ -237,11 +245,13 @@ int mflt_nrf70_fw_stats_cdr_collect(void)
 	err = collect_nrf70_fw_stats();
 	if (err) {
 		LOG_ERR("Failed to collect nRF70 FW stats: %d", err);
+		mflt_cdr_budget_give_back();
 		return err;
 	}
 
 	if (s_nrf70_fw_stats_blob_size == 0) {
 		LOG_WRN("No nRF70 FW stats collected");
+		mflt_cdr_budget_give_back();
 		return -ENODATA;
 	}
 
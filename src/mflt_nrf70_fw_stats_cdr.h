@@ -41,9 +41,11 @@ int mflt_nrf70_fw_stats_cdr_init(void);
  * 
  * Note: Memfault limits CDR uploads to 1 per device per 24 hours.
  * Enable Developer Mode in Memfault dashboard for higher limits
- * during development.
+ * during development. The collection takes from the CDR budget
+ * shared with the other CDR sources (CONFIG_MFLT_CDR_BUDGET_COUNT).
  * 
  * @return 0 on success
+ * @return -EAGAIN if the CDR budget of the period is spent
  * @return -ENODEV if no network interface found
  * @return -ENOTSUP if vendor stats not supported
  * @return -ENODATA if no stats available
@@ -11,6 +11,8 @@
 #include <zephyr/sys/atomic.h>
 #include <memfault/nrfconnect_port/fota.h>
 
+#include "net_events.h"
+
 LOG_MODULE_REGISTER(mflt_ota_triggers, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
 
 #ifndef OTA_CHECK_INTERVAL
@@ -75,6 +77,24 @@ static void schedule_ota_check(const char *context)
 #endif
 }
 
+static void on_network_change(bool connected)
+{
+	if (!connected) {
+		return;
+	}
+
+	atomic_or(&mflt_ota_triggers_flags, MFLT_OTA_TRIGGERS_CONNECT_FLAG);
+
+	if (k_sem_count_get(&mflt_ota_triggers_sem) == 0) {
+		k_sem_give(&mflt_ota_triggers_sem);
+		LOG_INF("Memfault OTA check scheduled for network connect");
+	} else {
+		LOG_DBG("Memfault OTA check already pending");
+	}
+}
+
+NET_EVENTS_SUB_DEFINE(ota_triggers_sub, on_network_change);
+
 static void mflt_ota_triggers_thread(void *p1, void *p2, void *p3)
 {
 	ARG_UNUSED(p1);
@@ -82,6 +102,7 @@ static void mflt_ota_triggers_thread(void *p1, void *p2, void *p3)
 	ARG_UNUSED(p3);
 
 	LOG_INF("Memfault OTA trigger thread started");
+	net_events_subscribe(&ota_triggers_sub);
 
 	while (true) {
 		int ret = k_sem_take(&mflt_ota_triggers_sem, OTA_CHECK_INTERVAL);
@@ -113,15 +134,3 @@ void mflt_ota_triggers_notify_button(void)
 		LOG_DBG("Memfault OTA check already pending");
 	}
 }
-
-void mflt_ota_triggers_notify_connected(void)
-{
-	atomic_or(&mflt_ota_triggers_flags, MFLT_OTA_TRIGGERS_CONNECT_FLAG);
-
-	if (k_sem_count_get(&mflt_ota_triggers_sem) == 0) {
-		k_sem_give(&mflt_ota_triggers_sem);
-		LOG_INF("Memfault OTA check scheduled for network connect");
-	} else {
-		LOG_DBG("Memfault OTA check already pending");
-	}
-}
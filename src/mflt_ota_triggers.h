@@ -16,14 +16,10 @@ extern "C" {
  * @brief Notify the OTA trigger thread that a manual check should be performed.
  *
  * Typically invoked from the button handler when the user presses button 2.
+ * A check is also made on every network connect and every 60 minutes.
  */
 void mflt_ota_triggers_notify_button(void);
 
-/**
- * @brief Notify the OTA trigger thread that network connectivity is available.
- */
-void mflt_ota_triggers_notify_connected(void);
-
 #ifdef __cplusplus
 }
 #endif
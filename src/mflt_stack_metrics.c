@@ -4,12 +4,13 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <zephyr/init.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <memfault/metrics/metrics.h>
 
 #include <memfault_ncs_metrics.h>
-#include "mflt_stack_metrics.h"
+#include "net_events.h"
 
 LOG_MODULE_REGISTER(mflt_stack_metrics, CONFIG_MEMFAULT_NCS_LOG_LEVEL);
 
@@ -23,7 +24,6 @@ static struct memfault_ncs_metrics_thread stack_metrics_threads[] = {
 	{.thread_name = "nrf70_intr_wq", .key = MEMFAULT_METRICS_KEY(ncs_wifi_intr_unused_stack)},
 	{.thread_name = "nrf70_bh_wq", .key = MEMFAULT_METRICS_KEY(ncs_wifi_bh_unused_stack)},
 	/* Network threads */
-	{.thread_name = "mflt_http", .key = MEMFAULT_METRICS_KEY(ncs_mflt_http_unused_stack)},
 	{.thread_name = "conn_mgr_monitor",
 	 .key = MEMFAULT_METRICS_KEY(ncs_conn_mgr_monitor_unused_stack)},
 	{.thread_name = "net_socket_service",
@@ -35,15 +35,25 @@ static struct memfault_ncs_metrics_thread stack_metrics_threads[] = {
 	/* Application threads */
 	{.thread_name = "https_client_tid", .key = MEMFAULT_METRICS_KEY(https_client_unused_stack)},
 	{.thread_name = "mqtt_client_tid", .key = MEMFAULT_METRICS_KEY(mqtt_client_unused_stack)},
+	{.thread_name = "mflt_upload", .key = MEMFAULT_METRICS_KEY(mflt_upload_unused_stack)},
+	{.thread_name = "net_events", .key = MEMFAULT_METRICS_KEY(net_events_unused_stack)},
+	{.thread_name = "diag_exec", .key = MEMFAULT_METRICS_KEY(diag_exec_unused_stack)},
 	/* System threads */
 	{.thread_name = "shell_uart", .key = MEMFAULT_METRICS_KEY(ncs_shell_uart_unused_stack)},
 	{.thread_name = "logging", .key = MEMFAULT_METRICS_KEY(ncs_logging_unused_stack)},
 	{.thread_name = "main", .key = MEMFAULT_METRICS_KEY(ncs_main_unused_stack)}};
 
-void mflt_stack_metrics_init(void)
+/* The Wi-Fi and network threads all exist once connected for the first time */
+static void on_network_change(bool connected)
 {
+	static bool added;
 	int err;
 
+	if (!connected || added) {
+		return;
+	}
+	added = true;
+
 	LOG_INF("Initializing stack metrics monitoring for %zu threads",
 		ARRAY_SIZE(stack_metrics_threads));
 
@@ -58,4 +68,14 @@ void mflt_stack_metrics_init(void)
 		}
 	}
 }
+
+NET_EVENTS_SUB_DEFINE(stack_metrics_sub, on_network_change);
+
+static int stack_metrics_init(void)
+{
+	net_events_subscribe(&stack_metrics_sub);
+	return 0;
+}
+
+SYS_INIT(stack_metrics_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
 #endif
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Central scheduler for Memfault uploads.
+ *
+ * Replaces CONFIG_MEMFAULT_HTTP_PERIODIC_UPLOAD and the direct uploads from
+ * the application. A single delayable work item on a dedicated queue performs
+ * every upload, so uploads never overlap, and scheduling it without
+ * rescheduling merges requests into one upload per coalescing window. The
+ * periodic upload starts at a random phase after connecting so a fleet that
+ * reconnects together does not upload together. Each upload is one drain
+ * session of mflt_drain, which sends the most valuable data first within the
+ * session budget. Over HTTPS the connection is kept open between periodic
+ * uploads until CONFIG_MFLT_UPLOAD_IDLE_TIMEOUT_SEC passes without one.
+ */
+
+#include "mflt_upload_sched.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/net_mgmt.h>
+#include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/random/random.h>
+#include <zephyr/sys/atomic.h>
+#include <memfault/core/data_packetizer.h>
+#include <memfault/core/log.h>
+#include <memfault/metrics/metrics.h>
+
+#include "net_events.h"
+
+#ifdef CONFIG_MFLT_MQTT_CHUNKS
+#include "mflt_mqtt_chunks.h"
+#else
+#include "mflt_http_upload.h"
+#endif
+
+#if defined(CONFIG_MFLT_DICT_LOG) && !defined(CONFIG_MFLT_FLIGHT_REC)
+#include "mflt_dict_log.h"
+#endif
+
+LOG_MODULE_REGISTER(mflt_upload_sched, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+BUILD_ASSERT(!IS_ENABLED(CONFIG_MEMFAULT_HTTP_PERIODIC_UPLOAD),
+	     "The upload scheduler replaces CONFIG_MEMFAULT_HTTP_PERIODIC_UPLOAD");
+
+static const char *const trigger_names[] = {
+	[MFLT_UPLOAD_TRIGGER_PERIODIC] = "periodic",
+	[MFLT_UPLOAD_TRIGGER_CONNECT] = "connect",
+	[MFLT_UPLOAD_TRIGGER_BUTTON] = "button",
+	[MFLT_UPLOAD_TRIGGER_INCIDENT] = "incident",
+	[MFLT_UPLOAD_TRIGGER_COMMAND] = "command",
+};
+
+BUILD_ASSERT(ARRAY_SIZE(trigger_names) == MFLT_UPLOAD_TRIGGER_COUNT);
+
+static K_THREAD_STACK_DEFINE(upload_wq_stack, CONFIG_MFLT_UPLOAD_STACK_SIZE);
+static struct k_work_q upload_wq;
+
+static void upload_work_fn(struct k_work *work);
+static void periodic_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(upload_work, upload_work_fn);
+static K_WORK_DELAYABLE_DEFINE(periodic_work, periodic_work_fn);
+
+#ifndef CONFIG_MFLT_MQTT_CHUNKS
+static void idle_work_fn(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	mflt_http_upload_close();
+}
+
+static K_WORK_DELAYABLE_DEFINE(idle_work, idle_work_fn);
+#endif
+
+static struct k_spinlock lock;
+/* Triggers of the pending upload, one bit each, 0 if none is pending */
+static uint32_t pending_triggers;
+static bool pending_urgent;
+
+static atomic_t connected;
+/* Owned by the upload workqueue */
+static int64_t deferred_since;
+
+static bool link_is_good(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct wifi_iface_status status = {0};
+
+	if (!iface || net_mgmt(NET_REQUEST_WIFI_IFACE_STATUS, iface, &status, sizeof(status)) ||
+	    status.state != WIFI_STATE_COMPLETED) {
+		/* Unknown link quality does not hold uploads back */
+		return true;
+	}
+
+	if (status.rssi < CONFIG_MFLT_UPLOAD_MIN_RSSI) {
+		LOG_DBG("RSSI %d dBm below %d dBm", status.rssi, CONFIG_MFLT_UPLOAD_MIN_RSSI);
+		return false;
+	}
+
+	/* Not every driver reports the TX rate */
+	if (status.current_phy_tx_rate > 0.0f &&
+	    status.current_phy_tx_rate < CONFIG_MFLT_UPLOAD_MIN_TX_RATE_MBPS) {
+		LOG_DBG("TX rate %.1f Mbps below %d Mbps", (double)status.current_phy_tx_rate,
+			CONFIG_MFLT_UPLOAD_MIN_TX_RATE_MBPS);
+		return false;
+	}
+
+	return true;
+}
+
+static void upload_run(uint32_t triggers)
+{
+	char names[48] = "";
+	size_t len = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(trigger_names); i++) {
+		if (triggers & BIT(i)) {
+			len += snprintk(&names[len], sizeof(names) - len, "%s%s", len ? "+" : "",
+					trigger_names[i]);
+		}
+	}
+
+	if (!memfault_packetizer_data_available()) {
+		LOG_DBG("No data to upload (%s)", names);
+		return;
+	}
+
+	LOG_INF("Uploading Memfault data (%s)", names);
+	MEMFAULT_METRIC_ADD(mflt_upload_count, 1);
+
+#ifdef CONFIG_MFLT_MQTT_CHUNKS
+	mflt_mqtt_chunks_post();
+#else
+	(void)mflt_http_upload_session();
+
+	if (IS_ENABLED(CONFIG_MFLT_UPLOAD_WARM_CONNECTION)) {
+		(void)k_work_reschedule_for_queue(&upload_wq, &idle_work,
+						  K_SECONDS(CONFIG_MFLT_UPLOAD_IDLE_TIMEOUT_SEC));
+	}
+#endif
+}
+
+static void upload_work_fn(struct k_work *work)
+{
+	k_spinlock_key_t key;
+	uint32_t triggers;
+	bool urgent;
+	int64_t now = k_uptime_get();
+
+	ARG_UNUSED(work);
+
+	if (!atomic_get(&connected)) {
+		/* Kept pending until the next connection */
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	urgent = pending_urgent;
+	k_spin_unlock(&lock, key);
+
+	if (!urgent && !link_is_good()) {
+		if (deferred_since == 0) {
+			deferred_since = now;
+			MEMFAULT_METRIC_ADD(mflt_upload_deferred_count, 1);
+		}
+
+		if (now - deferred_since < CONFIG_MFLT_UPLOAD_MAX_DEFER_SEC * MSEC_PER_SEC) {
+			LOG_INF("Poor link, deferring upload");
+			(void)k_work_reschedule_for_queue(
+				&upload_wq, &upload_work,
+				K_SECONDS(CONFIG_MFLT_UPLOAD_LINK_RECHECK_SEC));
+			return;
+		}
+
+		LOG_WRN("Link still poor after %d s, uploading anyway",
+			CONFIG_MFLT_UPLOAD_MAX_DEFER_SEC);
+	}
+
+	deferred_since = 0;
+
+	/* Requests from here on start a new coalescing window */
+	key = k_spin_lock(&lock);
+	triggers = pending_triggers;
+	pending_triggers = 0;
+	pending_urgent = false;
+	k_spin_unlock(&lock, key);
+
+	if (triggers) {
+		upload_run(triggers);
+	}
+}
+
+static void periodic_work_fn(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+#ifdef CONFIG_MFLT_UPLOAD_LOGS
+	/* Freeze the log buffer so it is part of the upload */
+	memfault_log_trigger_collection();
+#endif
+
+#if defined(CONFIG_MFLT_DICT_LOG) && !defined(CONFIG_MFLT_FLIGHT_REC)
+	/* Rate limited, most periods only the text logs go out */
+	(void)mflt_dict_log_trigger_collection();
+#endif
+
+	mflt_upload_sched_request(MFLT_UPLOAD_TRIGGER_PERIODIC, false);
+
+	(void)k_work_reschedule_for_queue(&upload_wq, &periodic_work,
+					  K_SECONDS(CONFIG_MFLT_UPLOAD_INTERVAL_SEC));
+}
+
+static void notify_connected(void)
+{
+	uint32_t phase_ms = sys_rand32_get() % (CONFIG_MFLT_UPLOAD_INTERVAL_SEC * MSEC_PER_SEC);
+	k_spinlock_key_t key;
+	bool pending;
+
+	atomic_set(&connected, 1);
+
+	LOG_DBG("First periodic upload in %u ms", phase_ms);
+	(void)k_work_reschedule_for_queue(&upload_wq, &periodic_work, K_MSEC(phase_ms));
+
+	/* Flush the backlog of requests made while offline */
+	key = k_spin_lock(&lock);
+	pending = (pending_triggers != 0);
+	k_spin_unlock(&lock, key);
+
+	if (pending) {
+		(void)k_work_schedule_for_queue(&upload_wq, &upload_work,
+						K_MSEC(CONFIG_MFLT_UPLOAD_COALESCE_MS));
+	}
+}
+
+static void notify_disconnected(void)
+{
+	atomic_set(&connected, 0);
+
+	(void)k_work_cancel_delayable(&periodic_work);
+	(void)k_work_cancel_delayable(&upload_work);
+
+#ifndef CONFIG_MFLT_MQTT_CHUNKS
+	/* The socket is owned by the upload workqueue, close it from there */
+	(void)k_work_reschedule_for_queue(&upload_wq, &idle_work, K_NO_WAIT);
+#endif
+}
+
+static void on_network_change(bool up)
+{
+	if (up) {
+		notify_connected();
+	} else {
+		/* Pending requests wait for the next connection */
+		notify_disconnected();
+	}
+}
+
+NET_EVENTS_SUB_DEFINE(upload_sched_sub, on_network_change);
+
+void mflt_upload_sched_init(void)
+{
+	struct k_work_queue_config cfg = {
+		.name = "mflt_upload",
+	};
+
+	k_work_queue_start(&upload_wq, upload_wq_stack, K_THREAD_STACK_SIZEOF(upload_wq_stack),
+			   K_LOWEST_APPLICATION_THREAD_PRIO, &cfg);
+
+#ifndef CONFIG_MFLT_MQTT_CHUNKS
+	mflt_http_upload_init();
+#endif
+
+	net_events_subscribe(&upload_sched_sub);
+}
+
+void mflt_upload_sched_request(enum mflt_upload_trigger trigger, bool urgent)
+{
+	k_spinlock_key_t key;
+	bool coalesced;
+
+	if (trigger >= MFLT_UPLOAD_TRIGGER_COUNT) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	coalesced = (pending_triggers != 0);
+	pending_triggers |= BIT(trigger);
+	pending_urgent |= urgent;
+	k_spin_unlock(&lock, key);
+
+	if (coalesced) {
+		LOG_DBG("Upload request (%s) merged with pending upload", trigger_names[trigger]);
+		MEMFAULT_METRIC_ADD(mflt_upload_coalesced_count, 1);
+	}
+
+	if (!atomic_get(&connected)) {
+		return;
+	}
+
+	if (urgent) {
+		(void)k_work_reschedule_for_queue(&upload_wq, &upload_work, K_NO_WAIT);
+	} else {
+		/* No-op if already scheduled, the window counts from the first request */
+		(void)k_work_schedule_for_queue(&upload_wq, &upload_work,
+						K_MSEC(CONFIG_MFLT_UPLOAD_COALESCE_MS));
+	}
+}
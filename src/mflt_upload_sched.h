@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Reasons an upload was requested, reported in the log of each upload. */
+enum mflt_upload_trigger {
+	MFLT_UPLOAD_TRIGGER_PERIODIC,
+	MFLT_UPLOAD_TRIGGER_CONNECT,
+	MFLT_UPLOAD_TRIGGER_BUTTON,
+	MFLT_UPLOAD_TRIGGER_INCIDENT,
+	MFLT_UPLOAD_TRIGGER_COMMAND,
+	MFLT_UPLOAD_TRIGGER_COUNT,
+};
+
+/**
+ * @brief Start the upload workqueue.
+ *
+ * All Memfault uploads run one at a time on this queue, over HTTPS or, with
+ * CONFIG_MFLT_MQTT_CHUNKS, over the MQTT connection. Periodic uploads run
+ * while network connectivity is up.
+ */
+void mflt_upload_sched_init(void);
+
+/**
+ * @brief Request an upload of the data captured so far.
+ *
+ * Requests made within CONFIG_MFLT_UPLOAD_COALESCE_MS of the first pending one
+ * share a single upload. Non-urgent uploads wait while the Wi-Fi link is
+ * poor, for at most CONFIG_MFLT_UPLOAD_MAX_DEFER_SEC. Urgent requests are
+ * started at once regardless of link quality.
+ *
+ * @param trigger What asked for the upload.
+ * @param urgent True if the user is waiting for the data.
+ */
+void mflt_upload_sched_request(enum mflt_upload_trigger trigger, bool urgent);
+
+#ifdef __cplusplus
+}
+#endif
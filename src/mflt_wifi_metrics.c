@@ -4,6 +4,10 @@
 
 #include "mflt_wifi_metrics.h"
 
+#ifdef CONFIG_MFLT_FLIGHT_REC
+#include "mflt_flight_rec.h"
+#endif
+
 #include <memfault/metrics/metrics.h>
 
 #include <zephyr/logging/log.h>
@@ -77,6 +81,16 @@ void mflt_wifi_metrics_collect(void)
 	/* Numeric metrics */
 	MEMFAULT_METRIC_SET_UNSIGNED(wifi_primary_channel, status.channel);
 	MEMFAULT_METRIC_SET_SIGNED(wifi_sta_rssi, status.rssi);
+
+#ifdef CONFIG_MFLT_FLIGHT_REC
+	/* Capture the logs when the signal falls below the threshold */
+	static bool rssi_low;
+
+	if (!rssi_low && status.rssi < CONFIG_MFLT_FLIGHT_REC_RSSI_THRESHOLD) {
+		mflt_flight_rec_trigger(MFLT_FLIGHT_REC_THRESHOLD);
+	}
+	rssi_low = status.rssi < CONFIG_MFLT_FLIGHT_REC_RSSI_THRESHOLD;
+#endif
 	MEMFAULT_METRIC_SET_UNSIGNED(wifi_beacon_interval, status.beacon_interval);
 	MEMFAULT_METRIC_SET_UNSIGNED(wifi_dtim_interval, status.dtim_period);
 	MEMFAULT_METRIC_SET_UNSIGNED(wifi_twt_capable, status.twt_capable);
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Batching of small telemetry records into one MQTT publish.
+ *
+ * Two batch buffers are used: one is filled while the other one is owned by
+ * the MQTT client until its PUBACK. Records are encoded straight into the
+ * buffer being filled, and the buffer is handed to the client without a copy.
+ * If both buffers are busy, new records are dropped and counted.
+ */
+
+#include "mqtt_batch.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <hw_id.h>
+#include <memfault/metrics/metrics.h>
+
+#include "mqtt_client.h"
+
+LOG_MODULE_REGISTER(mqtt_batch, CONFIG_MQTT_CLIENT_LOG_LEVEL);
+
+#define CBOR_MAJOR_UINT	 0
+#define CBOR_MAJOR_NINT	 1
+#define CBOR_MAJOR_BYTES 2
+#define CBOR_MAJOR_TEXT	 3
+#define CBOR_MAJOR_ARRAY 4
+
+#define CBOR_ARRAY_INDEF 0x9f
+#define CBOR_BREAK	 0xff
+
+/* Longest head: initial byte and a 64-bit argument */
+#define CBOR_HEAD_MAX_LEN 9
+
+/* Indefinite array start, batch start uptime and the break byte */
+#define BATCH_OVERHEAD (1 + CBOR_HEAD_MAX_LEN + 1)
+
+struct batch_buf {
+	struct app_mqtt_msg msg;
+	/* Set while the buffer is owned by the MQTT client */
+	atomic_t busy;
+	uint32_t records;
+	size_t len;
+	int64_t started_ms;
+	uint8_t data[CONFIG_MQTT_BATCH_MAX_BYTES];
+};
+
+static struct batch_buf bufs[2];
+/* Buffer being filled, NULL until a record is added */
+static struct batch_buf *fill;
+static K_MUTEX_DEFINE(batch_lock);
+
+static char topic[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE + sizeof(CONFIG_MQTT_BATCH_TOPIC)];
+static size_t topic_len;
+
+static void flush_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_fn);
+
+/* Encode a CBOR head, or only compute its length if out is NULL */
+static size_t cbor_head(uint8_t *out, uint8_t major, uint64_t val)
+{
+	size_t len;
+	uint8_t info;
+
+	if (val < 24) {
+		info = val;
+		len = 0;
+	} else if (val <= UINT8_MAX) {
+		info = 24;
+		len = 1;
+	} else if (val <= UINT16_MAX) {
+		info = 25;
+		len = 2;
+	} else if (val <= UINT32_MAX) {
+		info = 26;
+		len = 4;
+	} else {
+		info = 27;
+		len = 8;
+	}
+
+	if (out) {
+		out[0] = (major << 5) | info;
+		for (size_t i = 0; i < len; i++) {
+			out[len - i] = val >> (8 * i);
+		}
+	}
+
+	return 1 + len;
+}
+
+static size_t cbor_int(uint8_t *out, int64_t value)
+{
+	if (value < 0) {
+		/* -1 - value cannot overflow for any negative int64_t */
+		return cbor_head(out, CBOR_MAJOR_NINT, (uint64_t)(-1 - value));
+	}
+
+	return cbor_head(out, CBOR_MAJOR_UINT, value);
+}
+
+static void publish_done(struct app_mqtt_msg *msg, int result)
+{
+	struct batch_buf *buf = CONTAINER_OF(msg, struct batch_buf, msg);
+
+	if (result) {
+		LOG_WRN("Batch of %u record(s) not delivered: %d", buf->records, result);
+		MEMFAULT_METRIC_ADD(mqtt_batch_drop_count, buf->records);
+	}
+
+	atomic_clear(&buf->busy);
+}
+
+/* Close the batch being filled and hand it to the MQTT client, batch_lock held */
+static void batch_publish(void)
+{
+	struct batch_buf *buf = fill;
+	int err;
+
+	fill = NULL;
+	(void)k_work_cancel_delayable(&flush_work);
+
+	buf->data[buf->len++] = CBOR_BREAK;
+
+	buf->msg = (struct app_mqtt_msg){
+		.topic = topic,
+		.topic_len = topic_len,
+		.payload = buf->data,
+		.payload_len = buf->len,
+		.cb = publish_done,
+	};
+
+	LOG_DBG("Publishing batch of %u record(s), %zu bytes", buf->records, buf->len);
+
+	err = app_mqtt_client_publish_msg(&buf->msg);
+	if (err) {
+		LOG_WRN("Failed to publish batch: %d", err);
+		MEMFAULT_METRIC_ADD(mqtt_batch_drop_count, buf->records);
+		atomic_clear(&buf->busy);
+		return;
+	}
+
+	MEMFAULT_METRIC_ADD(mqtt_batch_publish_count, 1);
+}
+
+/* Start a new batch in a free buffer, batch_lock held */
+static int batch_open(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(bufs); i++) {
+		if (atomic_cas(&bufs[i].busy, 0, 1)) {
+			fill = &bufs[i];
+			break;
+		}
+	}
+
+	if (!fill) {
+		return -ENOBUFS;
+	}
+
+	fill->started_ms = k_uptime_get();
+	fill->records = 0;
+	fill->len = 0;
+	fill->data[fill->len++] = CBOR_ARRAY_INDEF;
+	fill->len += cbor_head(&fill->data[fill->len], CBOR_MAJOR_UINT, fill->started_ms);
+
+	/* Deadline counts from the first record, later records do not extend it */
+	(void)k_work_schedule(&flush_work, K_MSEC(CONFIG_MQTT_BATCH_MAX_DELAY_MS));
+	return 0;
+}
+
+static int batch_add(const char *name, uint8_t major, int64_t value, const void *data,
+		     size_t len)
+{
+	size_t name_len;
+	size_t value_len;
+	size_t rec_len;
+	uint32_t offset_ms;
+	uint8_t *out;
+	int err = 0;
+
+	if (!name) {
+		return -EINVAL;
+	}
+
+	name_len = strlen(name);
+	value_len = (major == CBOR_MAJOR_BYTES) ? cbor_head(NULL, major, len) + len
+						: cbor_int(NULL, value);
+
+	/* The offset head is at most 5 bytes, batches never span 49 days */
+	rec_len = 1 + 5 + cbor_head(NULL, CBOR_MAJOR_TEXT, name_len) + name_len + value_len;
+	if (rec_len + BATCH_OVERHEAD > CONFIG_MQTT_BATCH_MAX_BYTES) {
+		return -EMSGSIZE;
+	}
+
+	k_mutex_lock(&batch_lock, K_FOREVER);
+
+	if (fill && fill->len + rec_len + 1 > sizeof(fill->data)) {
+		batch_publish();
+	}
+
+	if (!fill) {
+		err = batch_open();
+		if (err) {
+			MEMFAULT_METRIC_ADD(mqtt_batch_drop_count, 1);
+			goto unlock;
+		}
+	}
+
+	offset_ms = k_uptime_get() - fill->started_ms;
+	out = &fill->data[fill->len];
+
+	out += cbor_head(out, CBOR_MAJOR_ARRAY, 3);
+	out += cbor_head(out, CBOR_MAJOR_UINT, offset_ms);
+	out += cbor_head(out, CBOR_MAJOR_TEXT, name_len);
+	memcpy(out, name, name_len);
+	out += name_len;
+	if (major == CBOR_MAJOR_BYTES) {
+		out += cbor_head(out, CBOR_MAJOR_BYTES, len);
+		memcpy(out, data, len);
+		out += len;
+	} else {
+		out += cbor_int(out, value);
+	}
+
+	fill->len = out - fill->data;
+	fill->records++;
+
+unlock:
+	k_mutex_unlock(&batch_lock);
+	return err;
+}
+
+static void flush_work_fn(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	mqtt_batch_flush();
+}
+
+int mqtt_batch_init(void)
+{
+	char hw_id[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE];
+	int len;
+	int err;
+
+	err = hw_id_get(hw_id, sizeof(hw_id));
+	if (err) {
+		LOG_ERR("Failed to get device ID: %d", err);
+		return err;
+	}
+
+	len = snprintk(topic, sizeof(topic), "Memfault/%s/%s", hw_id, CONFIG_MQTT_BATCH_TOPIC);
+	if ((len < 0) || (len >= sizeof(topic))) {
+		LOG_ERR("Batch topic buffer too small");
+		return -ENOMEM;
+	}
+
+	topic_len = len;
+
+	LOG_INF("Batch topic: %s", topic);
+	return 0;
+}
+
+int mqtt_batch_add_int(const char *name, int64_t value)
+{
+	return batch_add(name, CBOR_MAJOR_UINT, value, NULL, 0);
+}
+
+int mqtt_batch_add_bytes(const char *name, const void *data, size_t len)
+{
+	if (!data && len > 0) {
+		return -EINVAL;
+	}
+
+	return batch_add(name, CBOR_MAJOR_BYTES, 0, data, len);
+}
+
+void mqtt_batch_flush(void)
+{
+	k_mutex_lock(&batch_lock, K_FOREVER);
+
+	if (fill) {
+		batch_publish();
+	}
+
+	k_mutex_unlock(&batch_lock);
+}
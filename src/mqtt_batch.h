@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef MQTT_BATCH_H_
+#define MQTT_BATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Telemetry batching stage in front of the MQTT client
+ *
+ * Records are CBOR encoded into a batch as they are added. A batch is
+ * published as a single message, one indefinite-length CBOR array, when it
+ * reaches CONFIG_MQTT_BATCH_MAX_BYTES or CONFIG_MQTT_BATCH_MAX_DELAY_MS after
+ * its first record, whichever comes first. The first element of the array is
+ * the uptime in milliseconds when the batch was started, every further
+ * element is one record: [offset ms from the batch start, name, value].
+ *
+ * script/mqtt_cbor_batch_decoder.py decodes the published batches.
+ */
+
+/**
+ * @brief Initialize the batching stage
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int mqtt_batch_init(void);
+
+/**
+ * @brief Add a record with an integer value
+ *
+ * @return 0 on success, -ENOBUFS if both batch buffers are busy
+ */
+int mqtt_batch_add_int(const char *name, int64_t value);
+
+/**
+ * @brief Add a record with a byte string value
+ *
+ * @return 0 on success, -EMSGSIZE if the record can never fit a batch,
+ *         -ENOBUFS if both batch buffers are busy
+ */
+int mqtt_batch_add_bytes(const char *name, const void *data, size_t len);
+
+/**
+ * @brief Publish the current batch now
+ */
+void mqtt_batch_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_BATCH_H_ */
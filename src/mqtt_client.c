@@ -8,10 +8,19 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/slist.h>
 #include <net/mqtt_helper.h>
 #include <hw_id.h>
 #include <memfault/metrics/metrics.h>
 
+#include "diag_exec.h"
+#include "mqtt_batch.h"
+#include "mqtt_echo_monitor.h"
+#include "mqtt_keepalive.h"
+#include "mqtt_pub_queue.h"
+#include "net_events.h"
+#include "net_policy.h"
+
 LOG_MODULE_REGISTER(mqtt_client, CONFIG_MQTT_CLIENT_LOG_LEVEL);
 
 /* MQTT client states - prefixed to avoid conflict with mqtt_helper.h */
@@ -21,18 +30,156 @@ enum app_mqtt_client_state {
 	APP_MQTT_STATE_CONNECTED,
 };
 
+/* Events handled by the client thread, posted from callbacks, timers and the API */
+enum app_mqtt_event {
+	APP_MQTT_EVT_NET_UP,
+	APP_MQTT_EVT_NET_DOWN,
+	APP_MQTT_EVT_CONNACK,
+	APP_MQTT_EVT_DISCONNECT,
+	APP_MQTT_EVT_CONNECT_TIMEOUT,
+	APP_MQTT_EVT_RETRY,
+	APP_MQTT_EVT_PUBLISH_TIMER,
+	APP_MQTT_EVT_PUBLISH_REQ,
+	APP_MQTT_EVT_KEEPALIVE,
+	APP_MQTT_EVT_KEEPALIVE_ACK,
+	APP_MQTT_EVT_KEEPALIVE_TIMEOUT,
+};
+
 /* State variables */
 static enum app_mqtt_client_state current_state = APP_MQTT_STATE_DISCONNECTED;
 static bool mqtt_client_running = false;
+/* Owned by the client thread */
 static bool network_ready = false;
-static uint32_t message_count;
 static uint32_t mqtt_echo_total;
 static uint32_t mqtt_echo_failures;
-static K_SEM_DEFINE(mqtt_thread_sem, 0, 1);
+
+static atomic_t pending_events;
+/* Latest network state reported by the application */
+static atomic_t network_up;
+static struct k_poll_signal event_signal = K_POLL_SIGNAL_INITIALIZER(event_signal);
+
+static void timer_expiry_post(struct k_timer *timer);
+static K_TIMER_DEFINE(connect_timer, timer_expiry_post, NULL);
+static K_TIMER_DEFINE(retry_timer, timer_expiry_post, NULL);
+static K_TIMER_DEFINE(publish_timer, timer_expiry_post, NULL);
+
+/* Connection attempt timeout, reconnect spacing and broker failure isolation */
+static struct net_rtt_estimator connect_rtt;
+static struct net_backoff reconnect_backoff;
+static struct net_breaker connect_breaker;
+static int64_t connect_started_at;
+
+/* Topics of string publishes, stored as the first byte of queued publishes */
+enum pub_topic_id {
+	PUB_TOPIC_DEFAULT,
+	PUB_TOPIC_CMD_RESULT,
+};
+
+static int string_publish(uint8_t topic_id, const char *payload);
+
+#if defined(CONFIG_MQTT_PUB_QUEUE)
+/* Paces replay of queued publishes after reconnecting, one per period */
+static K_TIMER_DEFINE(replay_timer, timer_expiry_post, NULL);
+/* Oldest queued publish, sent through the in-flight window. It stays queued
+ * until its PUBACK, so it survives a lost connection or a reboot.
+ */
+static uint8_t replay_buf[CONFIG_MQTT_PUB_QUEUE_MAX_PAYLOAD];
+static struct app_mqtt_msg replay_msg;
+static int64_t replay_age_ms;
+static atomic_t replay_busy;
+
+#define REPLAY_PERIOD K_MSEC(MSEC_PER_SEC / CONFIG_MQTT_PUB_QUEUE_REPLAY_RATE)
+#else
+/* String publishes handed to the client thread. A slot is free again on
+ * PUBACK, or when the publish is given up on.
+ */
+#define STRING_MSG_COUNT   4
+#define STRING_MSG_MAX_LEN 64
+
+struct string_msg {
+	struct app_mqtt_msg msg;
+	uint8_t payload[STRING_MSG_MAX_LEN];
+};
+
+static struct string_msg string_msgs[STRING_MSG_COUNT];
+static ATOMIC_DEFINE(string_msgs_used, STRING_MSG_COUNT);
+#endif
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+/* Idle time before the next keepalive probe, restarted on any broker traffic */
+static K_TIMER_DEFINE(keepalive_timer, timer_expiry_post, NULL);
+/* PUBACK deadline of the outstanding probe */
+static K_TIMER_DEFINE(keepalive_probe_timer, timer_expiry_post, NULL);
+/* Message ID of the outstanding probe, 0 if none */
+static atomic_t keepalive_probe_id;
+
+#define KEEPALIVE_TOPIC_SUFFIX "keepalive"
+#endif
+
+#if defined(CONFIG_MQTT_CLIENT_COMMANDS)
+#define CMD_TOPIC_SUFFIX	"cmd"
+#define CMD_RESULT_TOPIC_SUFFIX "cmd/result"
+#endif
+
+/* Binary publishes, submitted -> pending -> in flight until PUBACK. Messages are
+ * owned by the caller and linked in place, nothing is copied.
+ */
+static sys_slist_t msg_pending = SYS_SLIST_STATIC_INIT(&msg_pending);
+static sys_slist_t msg_inflight = SYS_SLIST_STATIC_INIT(&msg_inflight);
+static size_t msg_inflight_count;
+static K_MUTEX_DEFINE(msg_lock);
 
 /* Client ID and topic buffers */
 static char client_id[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE];
 static char pub_topic[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE + sizeof(CONFIG_MQTT_CLIENT_PUBLISH_TOPIC)];
+static size_t pub_topic_len;
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+static char keepalive_topic[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE + sizeof(KEEPALIVE_TOPIC_SUFFIX)];
+static size_t keepalive_topic_len;
+#endif
+#if defined(CONFIG_MQTT_CLIENT_COMMANDS)
+static char cmd_topic[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE + sizeof(CMD_TOPIC_SUFFIX)];
+static size_t cmd_topic_len;
+static char cmd_result_topic[CONFIG_MQTT_CLIENT_ID_BUFFER_SIZE + sizeof(CMD_RESULT_TOPIC_SUFFIX)];
+static size_t cmd_result_topic_len;
+#endif
+
+static void event_post(enum app_mqtt_event event)
+{
+	atomic_set_bit(&pending_events, event);
+	k_poll_signal_raise(&event_signal, 0);
+}
+
+static void timer_expiry_post(struct k_timer *timer)
+{
+	if (timer == &connect_timer) {
+		event_post(APP_MQTT_EVT_CONNECT_TIMEOUT);
+	} else if (timer == &retry_timer) {
+		event_post(APP_MQTT_EVT_RETRY);
+	} else if (timer == &publish_timer) {
+		event_post(APP_MQTT_EVT_PUBLISH_TIMER);
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+	} else if (timer == &keepalive_timer) {
+		event_post(APP_MQTT_EVT_KEEPALIVE);
+	} else if (timer == &keepalive_probe_timer) {
+		event_post(APP_MQTT_EVT_KEEPALIVE_TIMEOUT);
+#endif
+	} else {
+		event_post(APP_MQTT_EVT_PUBLISH_REQ);
+	}
+}
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+/* Any traffic keeps the path alive, the next probe is due one interval later */
+static void keepalive_activity(void)
+{
+	k_timer_start(&keepalive_timer, K_SECONDS(mqtt_keepalive_interval_sec()), K_NO_WAIT);
+}
+#else
+static inline void keepalive_activity(void)
+{
+}
+#endif
 
 /* MQTT helper callbacks */
 static void on_mqtt_connack(enum mqtt_conn_return_code return_code, bool session_present)
@@ -42,6 +189,7 @@ static void on_mqtt_connack(enum mqtt_conn_return_code return_code, bool session
 	if (return_code != MQTT_CONNECTION_ACCEPTED) {
 		LOG_ERR("MQTT broker rejected connection, return code: %d", return_code);
 		current_state = APP_MQTT_STATE_DISCONNECTED;
+		event_post(APP_MQTT_EVT_CONNACK);
 		return;
 	}
 
@@ -52,17 +200,27 @@ static void on_mqtt_connack(enum mqtt_conn_return_code return_code, bool session
 	LOG_INF("TLS: Yes");
 
 	current_state = APP_MQTT_STATE_CONNECTED;
+	event_post(APP_MQTT_EVT_CONNACK);
 
-	/* Subscribe to the publish topic for echo test */
+	/* Subscribe to the publish topic for echo test, and to commands */
 	if (pub_topic[0] != '\0') {
-		struct mqtt_topic sub_topic = {
-			.topic.utf8 = pub_topic,
-			.topic.size = strlen(pub_topic),
-			.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+		struct mqtt_topic sub_topics[] = {
+			{
+				.topic.utf8 = pub_topic,
+				.topic.size = pub_topic_len,
+				.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+			},
+#if defined(CONFIG_MQTT_CLIENT_COMMANDS)
+			{
+				.topic.utf8 = cmd_topic,
+				.topic.size = cmd_topic_len,
+				.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+			},
+#endif
 		};
 		struct mqtt_subscription_list sub_list = {
-			.list = &sub_topic,
-			.list_count = 1,
+			.list = sub_topics,
+			.list_count = ARRAY_SIZE(sub_topics),
 			.message_id = mqtt_helper_msg_id_get(),
 		};
 		int err = mqtt_helper_subscribe(&sub_list);
@@ -74,24 +232,69 @@ static void on_mqtt_connack(enum mqtt_conn_return_code return_code, bool session
 	}
 }
 
+#if defined(CONFIG_MQTT_CLIENT_COMMANDS)
+/* Runs on the diagnostic executor workqueue, the result is handed to the
+ * client thread. With CONFIG_MQTT_PUB_QUEUE it is queued while the broker is
+ * unreachable and published after reconnecting.
+ */
+static void cmd_report(enum diag_action action, int result)
+{
+	char payload[32];
+	int err;
+
+	snprintk(payload, sizeof(payload), "%s %d", diag_exec_action_name(action), result);
+
+	err = string_publish(PUB_TOPIC_CMD_RESULT, payload);
+	if (err) {
+		LOG_WRN("Result of %s not published: %d", diag_exec_action_name(action), err);
+	}
+}
+
+static void cmd_received(const char *payload, size_t len)
+{
+	int action = diag_exec_action_parse(payload, len);
+	int err;
+
+	if (action < 0) {
+		LOG_WRN("Unknown command: %.*s", (int)len, payload);
+		return;
+	}
+
+	err = diag_exec_submit(action, DIAG_SOURCE_REMOTE);
+	if (err && err != -EALREADY) {
+		LOG_WRN("Command %s not queued: %d", diag_exec_action_name(action), err);
+	}
+}
+#endif
+
 static void on_mqtt_disconnect(int result)
 {
 	LOG_INF("Disconnected from MQTT broker, result: %d", result);
 	current_state = APP_MQTT_STATE_DISCONNECTED;
 
-	/* If network is still ready, this was an unexpected disconnect
-	 * (e.g., NAT timeout, broker kicked us). Signal for reconnection.
-	 */
-	if (network_ready) {
-		LOG_WRN("Unexpected disconnect, will attempt reconnection");
-	}
+	/* Reconnection, if the network is still up, is decided by the client thread */
+	event_post(APP_MQTT_EVT_DISCONNECT);
 }
 
 static void on_mqtt_publish(struct mqtt_helper_buf topic, struct mqtt_helper_buf payload)
 {
+	keepalive_activity();
+
 	LOG_INF("Received payload: %.*s on topic: %.*s", payload.size, payload.ptr, topic.size,
 		topic.ptr);
 
+#if defined(CONFIG_MQTT_CLIENT_COMMANDS)
+	if (topic.size == cmd_topic_len && memcmp(topic.ptr, cmd_topic, topic.size) == 0) {
+		cmd_received((const char *)payload.ptr, payload.size);
+		return;
+	}
+#endif
+
+	/* Only echoes of our own topic are probes */
+	if (topic.size == pub_topic_len && memcmp(topic.ptr, pub_topic, topic.size) == 0) {
+		mqtt_echo_monitor_received(payload.ptr, payload.size);
+	}
+
 	/* Update MQTT echo metrics - message received back successfully */
 	mqtt_echo_total++;
 	MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_total_count, mqtt_echo_total);
@@ -99,8 +302,53 @@ static void on_mqtt_publish(struct mqtt_helper_buf topic, struct mqtt_helper_buf
 		mqtt_echo_total, mqtt_echo_failures);
 }
 
+static void on_mqtt_puback(uint16_t message_id, int result)
+{
+	struct app_mqtt_msg *msg;
+	struct app_mqtt_msg *tmp;
+	struct app_mqtt_msg *acked = NULL;
+	sys_snode_t *prev = NULL;
+
+	keepalive_activity();
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+	if (message_id == atomic_get(&keepalive_probe_id)) {
+		event_post(APP_MQTT_EVT_KEEPALIVE_ACK);
+		return;
+	}
+#endif
+
+	k_mutex_lock(&msg_lock, K_FOREVER);
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&msg_inflight, msg, tmp, node) {
+		if (msg->message_id == message_id) {
+			sys_slist_remove(&msg_inflight, prev, &msg->node);
+			msg_inflight_count--;
+			acked = msg;
+			break;
+		}
+		prev = &msg->node;
+	}
+	k_mutex_unlock(&msg_lock);
+
+	/* Echo probes are not tracked */
+	if (!acked) {
+		return;
+	}
+
+	LOG_DBG("PUBACK for message_id %u, result %d", message_id, result);
+
+	if (acked->cb) {
+		acked->cb(acked, result);
+	}
+
+	/* A window slot is free */
+	event_post(APP_MQTT_EVT_PUBLISH_REQ);
+}
+
 static void on_mqtt_suback(uint16_t message_id, int result)
 {
+	keepalive_activity();
+
 	if (result == 0) {
 		LOG_INF("Subscription successful, message_id: %d", message_id);
 	} else {
@@ -119,7 +367,41 @@ static int setup_topics(void)
 		return -EMSGSIZE;
 	}
 
+	pub_topic_len = len;
+
 	LOG_INF("Publish topic: %s", pub_topic);
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+	len = snprintk(keepalive_topic, sizeof(keepalive_topic), "Memfault/%s/%s", client_id,
+		       KEEPALIVE_TOPIC_SUFFIX);
+	if ((len < 0) || (len >= sizeof(keepalive_topic))) {
+		LOG_ERR("Keepalive topic buffer too small");
+		return -EMSGSIZE;
+	}
+
+	keepalive_topic_len = len;
+#endif
+
+#if defined(CONFIG_MQTT_CLIENT_COMMANDS)
+	len = snprintk(cmd_topic, sizeof(cmd_topic), "Memfault/%s/%s", client_id,
+		       CMD_TOPIC_SUFFIX);
+	if ((len < 0) || (len >= sizeof(cmd_topic))) {
+		LOG_ERR("Command topic buffer too small");
+		return -EMSGSIZE;
+	}
+
+	cmd_topic_len = len;
+
+	len = snprintk(cmd_result_topic, sizeof(cmd_result_topic), "Memfault/%s/%s", client_id,
+		       CMD_RESULT_TOPIC_SUFFIX);
+	if ((len < 0) || (len >= sizeof(cmd_result_topic))) {
+		LOG_ERR("Command result topic buffer too small");
+		return -EMSGSIZE;
+	}
+
+	cmd_result_topic_len = len;
+#endif
+
 	return 0;
 }
 
@@ -177,44 +459,467 @@ static int app_mqtt_connect(void)
 static int mqtt_publish_message(void)
 {
 	int err;
-	char payload[128];
+	int len;
+	char payload[32];
 
 	if (current_state != APP_MQTT_STATE_CONNECTED) {
 		LOG_WRN("Not connected to MQTT broker, skipping publish");
 		return -ENOTCONN;
 	}
 
-	message_count++;
-	snprintk(payload, sizeof(payload), "%u", message_count);
+	/* Sequence number and send time, matched when the echo comes back */
+	len = mqtt_echo_monitor_probe(payload, sizeof(payload));
+	if (len < 0) {
+		return len;
+	}
 
 	struct mqtt_publish_param param = {
 		.message.payload.data = payload,
-		.message.payload.len = strlen(payload),
+		.message.payload.len = len,
 		.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
 		.message_id = mqtt_helper_msg_id_get(),
 		.message.topic.topic.utf8 = pub_topic,
-		.message.topic.topic.size = strlen(pub_topic),
+		.message.topic.topic.size = pub_topic_len,
 	};
 
 	err = mqtt_helper_publish(&param);
 	if (err) {
 		LOG_WRN("Failed to publish message: %d", err);
+		mqtt_echo_monitor_cancel();
 		/* Update failure metric */
 		mqtt_echo_failures++;
 		MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_fail_count, mqtt_echo_failures);
 		return err;
 	}
 
+	keepalive_activity();
+
 	LOG_INF("Published message: \"%s\" on topic: \"%s\"", payload, pub_topic);
 	return 0;
 }
 
+static const char *pub_topic_get(uint8_t topic_id, size_t *len)
+{
+	switch (topic_id) {
+	case PUB_TOPIC_DEFAULT:
+		*len = pub_topic_len;
+		return pub_topic;
+#if defined(CONFIG_MQTT_CLIENT_COMMANDS)
+	case PUB_TOPIC_CMD_RESULT:
+		*len = cmd_result_topic_len;
+		return cmd_result_topic;
+#endif
+	default:
+		return NULL;
+	}
+}
+
+static int msg_send(struct app_mqtt_msg *msg)
+{
+	struct mqtt_publish_param param = {
+		.message.topic.topic.utf8 = msg->topic ? msg->topic : pub_topic,
+		.message.topic.topic.size = msg->topic ? msg->topic_len : pub_topic_len,
+		.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+		.message.payload.data = (uint8_t *)msg->payload,
+		.message.payload.len = msg->payload_len,
+		.message_id = msg->message_id,
+		.dup_flag = (msg->retransmits > 0),
+	};
+	int err;
+
+	err = mqtt_helper_publish(&param);
+	if (err == 0) {
+		keepalive_activity();
+	}
+
+	return err;
+}
+
+/* Fill the in-flight window from the pending list, without waiting for PUBACKs */
+static void msg_pump(void)
+{
+	struct app_mqtt_msg *msg;
+	sys_snode_t *node;
+	int err;
+
+	k_mutex_lock(&msg_lock, K_FOREVER);
+
+	while (current_state == APP_MQTT_STATE_CONNECTED &&
+	       msg_inflight_count < CONFIG_MQTT_CLIENT_INFLIGHT_MAX &&
+	       (node = sys_slist_peek_head(&msg_pending)) != NULL) {
+		msg = CONTAINER_OF(node, struct app_mqtt_msg, node);
+
+		if (msg->message_id == 0) {
+			msg->message_id = mqtt_helper_msg_id_get();
+		}
+
+		err = msg_send(msg);
+		if (err) {
+			/* Left at the head of the list, retried on the next event */
+			LOG_WRN("Failed to publish message_id %u: %d", msg->message_id, err);
+			break;
+		}
+
+		(void)sys_slist_get(&msg_pending);
+		sys_slist_append(&msg_inflight, &msg->node);
+		msg_inflight_count++;
+	}
+
+	k_mutex_unlock(&msg_lock);
+}
+
+/* After reconnecting, unacknowledged messages are sent again ahead of new ones.
+ * Messages given up on are reported newest first, so callbacks that resubmit
+ * them with app_mqtt_client_republish_msg() restore the original order.
+ */
+static void msg_requeue_inflight(void)
+{
+	sys_slist_t requeued = SYS_SLIST_STATIC_INIT(&requeued);
+	sys_slist_t failed = SYS_SLIST_STATIC_INIT(&failed);
+	struct app_mqtt_msg *msg;
+	sys_snode_t *node;
+
+	k_mutex_lock(&msg_lock, K_FOREVER);
+
+	while ((node = sys_slist_get(&msg_inflight)) != NULL) {
+		msg = CONTAINER_OF(node, struct app_mqtt_msg, node);
+
+		if (msg->retransmits >= CONFIG_MQTT_CLIENT_PUBLISH_MAX_RETRANSMITS) {
+			sys_slist_prepend(&failed, node);
+		} else {
+			msg->retransmits++;
+			sys_slist_append(&requeued, node);
+		}
+	}
+	msg_inflight_count = 0;
+
+	while ((node = sys_slist_get(&msg_pending)) != NULL) {
+		sys_slist_append(&requeued, node);
+	}
+	msg_pending = requeued;
+
+	k_mutex_unlock(&msg_lock);
+
+	while ((node = sys_slist_get(&failed)) != NULL) {
+		msg = CONTAINER_OF(node, struct app_mqtt_msg, node);
+		LOG_WRN("Giving up on message_id %u after %u retransmits", msg->message_id,
+			msg->retransmits);
+		if (msg->cb) {
+			msg->cb(msg, -ETIMEDOUT);
+		}
+	}
+}
+
+#if defined(CONFIG_MQTT_PUB_QUEUE)
+/* Runs on PUBACK, or when the replayed publish was given up on */
+static void replay_done(struct app_mqtt_msg *msg, int result)
+{
+	ARG_UNUSED(msg);
+
+	if (result == 0) {
+		mqtt_pub_queue_pop();
+		if (replay_age_ms >= 0) {
+			MEMFAULT_METRIC_SET_UNSIGNED(mqtt_queue_replay_latency_ms,
+						     (uint32_t)replay_age_ms);
+		}
+		if (mqtt_pub_queue_depth() == 0) {
+			LOG_INF("Publish queue drained");
+		}
+	} else {
+		/* Still queued, peeked again after reconnecting */
+		LOG_WRN("Queued publish not acknowledged: %d", result);
+	}
+
+	atomic_clear(&replay_busy);
+
+	/* Rate limited so a long backlog does not starve live traffic */
+	k_timer_start(&replay_timer, REPLAY_PERIOD, K_NO_WAIT);
+}
+
+static void replay_next(void)
+{
+	const char *topic;
+	size_t topic_len;
+	int len;
+
+	if (atomic_get(&replay_busy)) {
+		return;
+	}
+
+	len = mqtt_pub_queue_peek(replay_buf, sizeof(replay_buf), &replay_age_ms);
+	if (len == -ENODATA) {
+		return;
+	}
+
+	if (len == -EAGAIN) {
+		/* Queue skipped a foreign record, try again on the next period */
+		k_timer_start(&replay_timer, REPLAY_PERIOD, K_NO_WAIT);
+		return;
+	}
+
+	if (len < 1) {
+		LOG_WRN("Skipping unreadable queued publish, err %d", len);
+		mqtt_pub_queue_pop();
+		k_timer_start(&replay_timer, REPLAY_PERIOD, K_NO_WAIT);
+		return;
+	}
+
+	/* First byte is the topic */
+	topic = pub_topic_get(replay_buf[0], &topic_len);
+	if (!topic) {
+		LOG_WRN("Skipping queued publish for unknown topic %u", replay_buf[0]);
+		mqtt_pub_queue_pop();
+		k_timer_start(&replay_timer, REPLAY_PERIOD, K_NO_WAIT);
+		return;
+	}
+
+	replay_msg.topic = topic;
+	replay_msg.topic_len = topic_len;
+	replay_msg.payload = &replay_buf[1];
+	replay_msg.payload_len = len - 1;
+	replay_msg.cb = replay_done;
+
+	atomic_set(&replay_busy, 1);
+	(void)app_mqtt_client_publish_msg(&replay_msg);
+}
+#endif
+
+static void schedule_retry(uint32_t delay_ms)
+{
+	LOG_INF("Retrying MQTT connection in %u ms", delay_ms);
+	k_timer_start(&retry_timer, K_MSEC(delay_ms), K_NO_WAIT);
+}
+
+static void connect_failed(void)
+{
+	if (net_breaker_failure(&connect_breaker)) {
+		LOG_WRN("Broker unreachable, pausing connection attempts");
+		schedule_retry(net_breaker_remaining_ms(&connect_breaker));
+	} else {
+		schedule_retry(net_backoff_next_ms(&reconnect_backoff));
+	}
+}
+
+static void connect_start(void)
+{
+	uint32_t timeout_ms = net_rtt_timeout_ms(&connect_rtt);
+	int64_t elapsed;
+	int err;
+
+	if (!network_ready || current_state != APP_MQTT_STATE_DISCONNECTED) {
+		return;
+	}
+
+	if (!net_breaker_allow(&connect_breaker)) {
+		schedule_retry(net_breaker_remaining_ms(&connect_breaker));
+		return;
+	}
+
+	connect_started_at = k_uptime_get();
+
+	/* Resolves and performs the TCP/TLS handshake, then sends CONNECT */
+	err = app_mqtt_connect();
+	if (err) {
+		connect_failed();
+		return;
+	}
+
+	/* CONNACK is awaited as an event, bounded by the adaptive connect timeout */
+	elapsed = k_uptime_get() - connect_started_at;
+	k_timer_start(&connect_timer, K_MSEC(elapsed < timeout_ms ? timeout_ms - elapsed : 0),
+		      K_NO_WAIT);
+}
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+static bool keepalive_probe_outstanding(void)
+{
+	return atomic_get(&keepalive_probe_id) != 0;
+}
+
+static void keepalive_stop(void)
+{
+	k_timer_stop(&keepalive_timer);
+	k_timer_stop(&keepalive_probe_timer);
+	atomic_clear(&keepalive_probe_id);
+}
+
+/* The connection was idle for a full interval, check that it survived */
+static void keepalive_probe_send(void)
+{
+	struct mqtt_publish_param param = {
+		.message.topic.topic.utf8 = keepalive_topic,
+		.message.topic.topic.size = keepalive_topic_len,
+		.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+	};
+	int err;
+
+	if (current_state != APP_MQTT_STATE_CONNECTED || keepalive_probe_outstanding()) {
+		return;
+	}
+
+	/* Empty QoS 1 publish on a topic nobody subscribes to, only the PUBACK matters */
+	param.message_id = mqtt_helper_msg_id_get();
+	atomic_set(&keepalive_probe_id, param.message_id);
+
+	err = mqtt_helper_publish(&param);
+	if (err) {
+		/* Socket already failed, the disconnect path takes over */
+		LOG_WRN("Failed to send keepalive probe: %d", err);
+		atomic_clear(&keepalive_probe_id);
+		return;
+	}
+
+	LOG_DBG("Keepalive probe after %u s idle", mqtt_keepalive_interval_sec());
+	k_timer_start(&keepalive_probe_timer,
+		      K_SECONDS(CONFIG_MQTT_CLIENT_KEEPALIVE_PROBE_TIMEOUT_SEC), K_NO_WAIT);
+}
+
+static void on_keepalive_ack_event(void)
+{
+	if (!keepalive_probe_outstanding()) {
+		return;
+	}
+
+	k_timer_stop(&keepalive_probe_timer);
+	atomic_clear(&keepalive_probe_id);
+	mqtt_keepalive_probe_acked();
+	keepalive_activity();
+}
+
+/* No PUBACK: the path dropped the idle connection without telling either end */
+static void on_keepalive_timeout_event(void)
+{
+	if (!keepalive_probe_outstanding() || current_state != APP_MQTT_STATE_CONNECTED) {
+		return;
+	}
+
+	keepalive_stop();
+	mqtt_keepalive_probe_lost();
+
+	k_timer_stop(&publish_timer);
+	(void)mqtt_helper_disconnect();
+	current_state = APP_MQTT_STATE_DISCONNECTED;
+	schedule_retry(net_backoff_next_ms(&reconnect_backoff));
+}
+#endif
+
+static void on_connack_event(void)
+{
+	k_timer_stop(&connect_timer);
+
+	if (current_state != APP_MQTT_STATE_CONNECTED) {
+		connect_failed();
+		return;
+	}
+
+	net_rtt_update(&connect_rtt, (uint32_t)(k_uptime_get() - connect_started_at));
+	net_backoff_reset(&reconnect_backoff);
+	net_breaker_success(&connect_breaker);
+
+	msg_requeue_inflight();
+	msg_pump();
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+	keepalive_stop();
+	mqtt_keepalive_network_select();
+	keepalive_activity();
+#endif
+
+	/* First probe right away, then on the publish interval */
+	k_timer_start(&publish_timer, K_NO_WAIT,
+		      K_SECONDS(CONFIG_MQTT_CLIENT_PUBLISH_INTERVAL_SEC));
+
+#if defined(CONFIG_MQTT_PUB_QUEUE)
+	if (mqtt_pub_queue_depth() > 0) {
+		LOG_INF("Replaying %u queued publish(es)", mqtt_pub_queue_depth());
+		k_timer_start(&replay_timer, REPLAY_PERIOD, K_NO_WAIT);
+	}
+#endif
+}
+
+static void on_disconnect_event(void)
+{
+	bool was_connecting = (k_timer_remaining_get(&connect_timer) > 0);
+
+	k_timer_stop(&connect_timer);
+	k_timer_stop(&publish_timer);
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+	/* Reset while a probe was outstanding, the idle interval was too long */
+	if (keepalive_probe_outstanding() && network_ready) {
+		mqtt_keepalive_probe_lost();
+	}
+	keepalive_stop();
+#endif
+
+	/* A rejected CONNACK already scheduled the retry */
+	if (!network_ready || current_state != APP_MQTT_STATE_DISCONNECTED ||
+	    k_timer_remaining_get(&retry_timer) > 0) {
+		return;
+	}
+
+	if (was_connecting) {
+		/* Connection closed before CONNACK */
+		connect_failed();
+		return;
+	}
+
+	/* Unexpected disconnect (e.g., NAT timeout, broker kicked us). Reconnect after a
+	 * jittered delay so devices do not reconnect in lockstep.
+	 */
+	LOG_WRN("Broker connection lost, will attempt reconnection");
+	schedule_retry(net_backoff_next_ms(&reconnect_backoff));
+}
+
+static void on_connect_timeout_event(void)
+{
+	if (current_state != APP_MQTT_STATE_CONNECTING) {
+		return;
+	}
+
+	LOG_WRN("No CONNACK within %u ms, aborting connection attempt",
+		net_rtt_timeout_ms(&connect_rtt));
+	net_rtt_timeout_backoff(&connect_rtt);
+	(void)mqtt_helper_disconnect();
+	current_state = APP_MQTT_STATE_DISCONNECTED;
+	connect_failed();
+}
+
+static void on_net_down_event(void)
+{
+	network_ready = false;
+
+	k_timer_stop(&connect_timer);
+	k_timer_stop(&retry_timer);
+	k_timer_stop(&publish_timer);
+#if defined(CONFIG_MQTT_PUB_QUEUE)
+	k_timer_stop(&replay_timer);
+#endif
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+	keepalive_stop();
+#endif
+
+	/* Disconnect from broker if connected or connecting */
+	if (current_state != APP_MQTT_STATE_DISCONNECTED) {
+		(void)mqtt_helper_disconnect();
+		current_state = APP_MQTT_STATE_DISCONNECTED;
+	}
+
+	/* A trial connect cut short says nothing about the broker, retry it once
+	 * the network is back
+	 */
+	net_breaker_abort(&connect_breaker);
+}
+
 static void mqtt_client_thread(void *arg1, void *arg2, void *arg3)
 {
 	ARG_UNUSED(arg1);
 	ARG_UNUSED(arg2);
 	ARG_UNUSED(arg3);
 
+	struct k_poll_event poll_evt =
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &event_signal);
+	atomic_val_t events;
 	int err;
 
 	LOG_INF("MQTT client thread started");
@@ -227,6 +932,7 @@ static void mqtt_client_thread(void *arg1, void *arg2, void *arg3)
 				.on_disconnect = on_mqtt_disconnect,
 				.on_publish = on_mqtt_publish,
 				.on_suback = on_mqtt_suback,
+				.on_puback = on_mqtt_puback,
 			},
 	};
 
@@ -237,118 +943,256 @@ static void mqtt_client_thread(void *arg1, void *arg2, void *arg3)
 	}
 
 	while (mqtt_client_running) {
-		/* Wait for network connection */
-		k_sem_take(&mqtt_thread_sem, K_FOREVER);
+		/* Sleep until something happens, no periodic wakeups */
+		(void)k_poll(&poll_evt, 1, K_FOREVER);
+		poll_evt.state = K_POLL_STATE_NOT_READY;
+		k_poll_signal_reset(&event_signal);
 
-		if (!mqtt_client_running) {
-			break;
+		events = atomic_clear(&pending_events);
+
+		/* Network down first, it invalidates everything else in this batch. Up is
+		 * only acted on if it is still the latest state.
+		 */
+		if (events & BIT(APP_MQTT_EVT_NET_DOWN)) {
+			LOG_INF("Network disconnected, stopping MQTT operations");
+			on_net_down_event();
+		}
+
+		if ((events & BIT(APP_MQTT_EVT_NET_UP)) && atomic_get(&network_up)) {
+			LOG_INF("Network ready, starting MQTT operations");
+			network_ready = true;
+			connect_start();
+		}
+
+		if (events & BIT(APP_MQTT_EVT_CONNACK)) {
+			on_connack_event();
+		}
+
+		if (events & BIT(APP_MQTT_EVT_DISCONNECT)) {
+			on_disconnect_event();
+		}
+
+		if (events & BIT(APP_MQTT_EVT_CONNECT_TIMEOUT)) {
+			on_connect_timeout_event();
+		}
+
+		if (events & BIT(APP_MQTT_EVT_RETRY)) {
+			connect_start();
 		}
 
-		network_ready = true;
-		LOG_INF("Network ready, starting MQTT operations");
-
-		/* Wait a few seconds for network stack to stabilize */
-		k_sleep(K_SECONDS(5));
-
-		/* Main MQTT operation loop - handles connect, publish, and reconnect */
-		while (mqtt_client_running && network_ready) {
-			/* Try to connect to MQTT broker if not connected */
-			while (mqtt_client_running && network_ready &&
-			       current_state != APP_MQTT_STATE_CONNECTED) {
-				err = app_mqtt_connect();
-				if (err == -EINPROGRESS) {
-					/* Connection in progress, wait briefly and check again */
-					k_sleep(K_MSEC(500));
-				} else if (err) {
-					LOG_INF("Retrying MQTT connection in %d seconds",
-						CONFIG_MQTT_CLIENT_RECONNECT_TIMEOUT_SEC);
-					k_sleep(K_SECONDS(CONFIG_MQTT_CLIENT_RECONNECT_TIMEOUT_SEC));
-				}
-			}
-
-			/* Publish messages periodically while connected */
-			while (mqtt_client_running && network_ready &&
-			       current_state == APP_MQTT_STATE_CONNECTED) {
-				mqtt_publish_message();
-				k_sleep(K_SECONDS(CONFIG_MQTT_CLIENT_PUBLISH_INTERVAL_SEC));
-			}
-
-			/* If we get here and network is still ready, broker disconnected us.
-			 * Wait briefly then reconnect.
-			 */
-			if (mqtt_client_running && network_ready &&
-			    current_state == APP_MQTT_STATE_DISCONNECTED) {
-				LOG_INF("Broker connection lost, reconnecting in %d seconds",
-					CONFIG_MQTT_CLIENT_RECONNECT_TIMEOUT_SEC);
-				k_sleep(K_SECONDS(CONFIG_MQTT_CLIENT_RECONNECT_TIMEOUT_SEC));
-			}
+		if ((events & BIT(APP_MQTT_EVT_PUBLISH_TIMER)) &&
+		    current_state == APP_MQTT_STATE_CONNECTED) {
+			mqtt_publish_message();
 		}
 
-		LOG_INF("Network disconnected or client stopped");
+		if (events & BIT(APP_MQTT_EVT_PUBLISH_REQ)) {
+			msg_pump();
+		}
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+		if (events & BIT(APP_MQTT_EVT_KEEPALIVE_ACK)) {
+			on_keepalive_ack_event();
+		}
+
+		if (events & BIT(APP_MQTT_EVT_KEEPALIVE_TIMEOUT)) {
+			on_keepalive_timeout_event();
+		}
+
+		if (events & BIT(APP_MQTT_EVT_KEEPALIVE)) {
+			keepalive_probe_send();
+		}
+#endif
+
+#if defined(CONFIG_MQTT_PUB_QUEUE)
+		if ((events & BIT(APP_MQTT_EVT_PUBLISH_REQ)) &&
+		    current_state == APP_MQTT_STATE_CONNECTED &&
+		    k_timer_remaining_get(&replay_timer) == 0) {
+			replay_next();
+		}
+#endif
 	}
 
 	LOG_INF("MQTT client thread exiting");
 }
 
 K_THREAD_DEFINE(mqtt_client_tid, CONFIG_MQTT_CLIENT_STACK_SIZE, mqtt_client_thread, NULL, NULL,
-		NULL, CONFIG_MQTT_CLIENT_THREAD_PRIORITY, 0, 0);
+		NULL, CONFIG_MQTT_CLIENT_THREAD_PRIORITY, 0, SYS_FOREVER_MS);
+
+static void on_network_change(bool connected)
+{
+	if (connected) {
+		LOG_INF("Network connected, notifying MQTT client");
+		atomic_set(&network_up, 1);
+		event_post(APP_MQTT_EVT_NET_UP);
+	} else {
+		LOG_INF("Network disconnected, stopping MQTT client");
+		atomic_set(&network_up, 0);
+		event_post(APP_MQTT_EVT_NET_DOWN);
+	}
+}
+
+NET_EVENTS_SUB_DEFINE(mqtt_client_sub, on_network_change);
 
 int app_mqtt_client_init(void)
 {
+#if defined(CONFIG_MQTT_PUB_QUEUE)
+	/* Falls back to a RAM-only queue if the flash partition is unusable */
+	(void)mqtt_pub_queue_init();
+#endif
+
+#if defined(CONFIG_MQTT_BATCH)
+	if (mqtt_batch_init()) {
+		LOG_WRN("Telemetry batching unavailable");
+	}
+#endif
+
+#if defined(CONFIG_MQTT_CLIENT_ADAPTIVE_KEEPALIVE)
+	/* Unknown networks start from the floor interval */
+	(void)mqtt_keepalive_init();
+#endif
+
+	net_rtt_init(&connect_rtt, CONFIG_MQTT_CLIENT_CONNECT_TIMEOUT_MAX_MS,
+		     CONFIG_MQTT_CLIENT_CONNECT_TIMEOUT_MIN_MS,
+		     CONFIG_MQTT_CLIENT_CONNECT_TIMEOUT_MAX_MS);
+	net_backoff_init(&reconnect_backoff, CONFIG_MQTT_CLIENT_RECONNECT_BASE_SEC * MSEC_PER_SEC,
+			 CONFIG_MQTT_CLIENT_RECONNECT_TIMEOUT_SEC * MSEC_PER_SEC);
+	net_breaker_init(&connect_breaker, CONFIG_MQTT_CLIENT_BREAKER_THRESHOLD,
+			 CONFIG_MQTT_CLIENT_BREAKER_OPEN_SEC * MSEC_PER_SEC);
+
+#if defined(CONFIG_MQTT_CLIENT_COMMANDS)
+	diag_exec_reporter_set(DIAG_SOURCE_REMOTE, cmd_report);
+#endif
+
 	LOG_INF("MQTT client initialized");
 	mqtt_client_running = true;
+	k_thread_start(mqtt_client_tid);
+	net_events_subscribe(&mqtt_client_sub);
 	return 0;
 }
 
-void app_mqtt_client_notify_connected(void)
+#if !defined(CONFIG_MQTT_PUB_QUEUE)
+static void string_msg_done(struct app_mqtt_msg *msg, int result)
 {
-	if (mqtt_client_running) {
-		LOG_INF("Network connected, notifying MQTT client");
-		network_ready = true;
-		k_sem_give(&mqtt_thread_sem);
+	struct string_msg *smsg = CONTAINER_OF(msg, struct string_msg, msg);
+
+	if (result) {
+		LOG_WRN("Publish \"%.*s\" not acknowledged: %d", (int)msg->payload_len,
+			(const char *)smsg->payload, result);
+	} else {
+		LOG_INF("Published message: \"%.*s\"", (int)msg->payload_len,
+			(const char *)smsg->payload);
 	}
+
+	atomic_clear_bit(string_msgs_used, smsg - string_msgs);
 }
+#endif
 
-void app_mqtt_client_notify_disconnected(void)
+/* Callable from any thread, only the client thread talks to the broker */
+static int string_publish(uint8_t topic_id, const char *payload)
 {
-	LOG_INF("Network disconnected, stopping MQTT client");
-	network_ready = false;
+	size_t len = strlen(payload);
 
-	/* Disconnect from broker if connected */
-	if (current_state == APP_MQTT_STATE_CONNECTED) {
-		mqtt_helper_disconnect();
-		current_state = APP_MQTT_STATE_DISCONNECTED;
+#if defined(CONFIG_MQTT_PUB_QUEUE)
+	uint8_t record[CONFIG_MQTT_PUB_QUEUE_MAX_PAYLOAD];
+	int err;
+
+	if (len + 1 > sizeof(record)) {
+		return -EMSGSIZE;
+	}
+
+	record[0] = topic_id;
+	memcpy(&record[1], payload, len);
+
+	/* Queued while connected too, so it is sent behind any backlog and kept
+	 * until its PUBACK
+	 */
+	err = mqtt_pub_queue_push(record, len + 1);
+	if (err) {
+		LOG_WRN("Failed to queue message: %d", err);
+		return err;
+	}
+
+	event_post(APP_MQTT_EVT_PUBLISH_REQ);
+	return 0;
+#else
+	struct string_msg *smsg = NULL;
+	size_t topic_len = 0;
+	const char *topic = NULL;
+
+	if (len > STRING_MSG_MAX_LEN) {
+		return -EMSGSIZE;
+	}
+
+	/* Command results follow a received command, the topics are set up by then */
+	if (topic_id != PUB_TOPIC_DEFAULT) {
+		topic = pub_topic_get(topic_id, &topic_len);
+		if (!topic || topic_len == 0) {
+			return -ENOENT;
+		}
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(string_msgs); i++) {
+		if (!atomic_test_and_set_bit(string_msgs_used, i)) {
+			smsg = &string_msgs[i];
+			break;
+		}
 	}
+
+	if (!smsg) {
+		LOG_WRN("No free publish slot");
+		return -ENOBUFS;
+	}
+
+	memcpy(smsg->payload, payload, len);
+	smsg->msg = (struct app_mqtt_msg){
+		.topic = topic,
+		.topic_len = topic_len,
+		.payload = smsg->payload,
+		.payload_len = len,
+		.cb = string_msg_done,
+	};
+
+	return app_mqtt_client_publish_msg(&smsg->msg);
+#endif
 }
 
 int app_mqtt_client_publish(const char *payload)
 {
-	int err;
-
-	if (current_state != APP_MQTT_STATE_CONNECTED) {
-		LOG_WRN("Not connected to MQTT broker");
-		return -ENOTCONN;
+	if (!payload) {
+		return -EINVAL;
 	}
 
-	if (!payload) {
+	return string_publish(PUB_TOPIC_DEFAULT, payload);
+}
+
+static int msg_submit(struct app_mqtt_msg *msg, bool first)
+{
+	if (!msg || (!msg->payload && msg->payload_len > 0) || (msg->topic && msg->topic_len == 0)) {
 		return -EINVAL;
 	}
 
-	struct mqtt_publish_param param = {
-		.message.payload.data = (uint8_t *)payload,
-		.message.payload.len = strlen(payload),
-		.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
-		.message_id = mqtt_helper_msg_id_get(),
-		.message.topic.topic.utf8 = pub_topic,
-		.message.topic.topic.size = strlen(pub_topic),
-	};
+	msg->message_id = 0;
+	msg->retransmits = 0;
 
-	err = mqtt_helper_publish(&param);
-	if (err) {
-		LOG_WRN("Failed to publish message: %d", err);
-		return err;
+	k_mutex_lock(&msg_lock, K_FOREVER);
+	if (first) {
+		sys_slist_prepend(&msg_pending, &msg->node);
+	} else {
+		sys_slist_append(&msg_pending, &msg->node);
 	}
+	k_mutex_unlock(&msg_lock);
 
-	LOG_INF("Published message: \"%s\" on topic: \"%s\"", payload, pub_topic);
+	/* Sent by the client thread once connected and a window slot is free */
+	event_post(APP_MQTT_EVT_PUBLISH_REQ);
 	return 0;
 }
+
+int app_mqtt_client_publish_msg(struct app_mqtt_msg *msg)
+{
+	return msg_submit(msg, false);
+}
+
+int app_mqtt_client_republish_msg(struct app_mqtt_msg *msg)
+{
+	return msg_submit(msg, true);
+}
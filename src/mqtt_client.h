@@ -7,37 +7,97 @@
 #ifndef MQTT_CLIENT_H_
 #define MQTT_CLIENT_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/slist.h>
+
+struct app_mqtt_msg;
+
 /**
- * @brief Initialize the MQTT client
+ * @brief Completion callback of a binary publish
  *
- * Initializes the MQTT helper library and sets up callbacks.
+ * Called from the MQTT client context once the broker acknowledged the message
+ * (PUBACK), or when it was given up on. The message and its buffers may be
+ * reused from here on.
  *
- * @return 0 on success, negative error code on failure
+ * @param msg Completed message
+ * @param result 0 on PUBACK, negative error code if the message was not delivered
  */
-int app_mqtt_client_init(void);
+typedef void (*app_mqtt_publish_cb_t)(struct app_mqtt_msg *msg, int result);
 
 /**
- * @brief Notify MQTT client that network connection is established
+ * @brief QoS 1 message for app_mqtt_client_publish_msg()
  *
- * This function should be called when the device successfully connects
- * to the network. It will trigger the MQTT client to connect to the broker.
+ * The message, topic and payload are owned by the caller and must stay valid
+ * and unmodified until the completion callback runs.
  */
-void app_mqtt_client_notify_connected(void);
+struct app_mqtt_msg {
+	/* Topic, or NULL for the configured publish topic */
+	const char *topic;
+	uint16_t topic_len;
+	const uint8_t *payload;
+	size_t payload_len;
+	app_mqtt_publish_cb_t cb;
+	void *user_data;
+
+	/* Private */
+	sys_snode_t node;
+	uint16_t message_id;
+	uint8_t retransmits;
+};
 
 /**
- * @brief Notify MQTT client that network connection is lost
+ * @brief Initialize the MQTT client
+ *
+ * Initializes the MQTT helper library and sets up callbacks. The client
+ * connects to the broker while network connectivity is up.
  *
- * This function should be called when the device loses network connectivity.
- * It will disconnect the MQTT client from the broker.
+ * @return 0 on success, negative error code on failure
  */
-void app_mqtt_client_notify_disconnected(void);
+int app_mqtt_client_init(void);
 
 /**
  * @brief Publish a message to the configured topic
  *
+ * Callable from any thread. The payload is copied and sent by the client
+ * thread, in order with the other string publishes.
+ *
+ * With CONFIG_MQTT_PUB_QUEUE, messages are queued and also kept while the
+ * broker connection is down, and replayed in order after reconnecting.
+ * Without it, a few messages of up to 64 bytes are held until the broker
+ * acknowledged them.
+ *
  * @param payload Null-terminated string to publish
- * @return 0 on success, negative error code on failure
+ * @return 0 on success (handed to the client thread), -EMSGSIZE if the
+ *         payload is too long, -ENOBUFS if no message can be held, other
+ *         negative error codes on failure
  */
 int app_mqtt_client_publish(const char *payload);
 
+/**
+ * @brief Publish a binary QoS 1 message without copying it
+ *
+ * Up to CONFIG_MQTT_CLIENT_INFLIGHT_MAX messages are sent ahead of their
+ * PUBACKs. Messages submitted while the broker is unreachable, or not yet
+ * acknowledged when the connection dropped, are sent after reconnecting, the
+ * latter with the DUP flag, up to CONFIG_MQTT_CLIENT_PUBLISH_MAX_RETRANSMITS
+ * times.
+ *
+ * @param msg Message to publish, see struct app_mqtt_msg for ownership rules
+ * @return 0 if the message was accepted, negative error code otherwise
+ */
+int app_mqtt_client_publish_msg(struct app_mqtt_msg *msg);
+
+/**
+ * @brief Submit a message again ahead of all messages not yet sent
+ *
+ * For resubmitting a message from its completion callback after it was given
+ * up on, so it is not overtaken by messages submitted after it. Messages given
+ * up on together are reported newest first for this.
+ *
+ * @param msg Message to publish, see struct app_mqtt_msg for ownership rules
+ * @return 0 if the message was accepted, negative error code otherwise
+ */
+int app_mqtt_client_republish_msg(struct app_mqtt_msg *msg);
+
 #endif /* MQTT_CLIENT_H_ */
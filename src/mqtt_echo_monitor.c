@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * End-to-end monitor for the MQTT echo test. Every probe carries a sequence
+ * number and its send time; echoes are matched against the probes in flight to
+ * measure broker path round-trip time, loss, reordering and duplicates. The
+ * statistics cover one Memfault heartbeat interval each.
+ */
+
+#include "mqtt_echo_monitor.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <memfault/metrics/metrics.h>
+
+LOG_MODULE_REGISTER(mqtt_echo_monitor, CONFIG_MQTT_CLIENT_LOG_LEVEL);
+
+/* Longest payload is "4294967295:4294967295" */
+#define PROBE_PAYLOAD_MAX_LEN 21
+
+/* Sequence numbers tracked behind the highest one received, for duplicate detection */
+#define RX_WINDOW_BITS 64
+
+struct echo_probe {
+	uint32_t seq;
+	uint32_t sent_ms;
+	bool in_flight;
+};
+
+struct echo_stats {
+	uint32_t sent;
+	uint32_t received;
+	uint32_t lost;
+	uint32_t reordered;
+	uint32_t duplicates;
+	uint32_t rtt_min_ms;
+	uint32_t rtt_max_ms;
+	uint64_t rtt_sum_ms;
+};
+
+static struct echo_probe probes[CONFIG_MQTT_CLIENT_ECHO_INFLIGHT_MAX];
+static uint32_t next_seq = 1;
+static uint32_t highest_rx_seq;
+/* Bit n set: highest_rx_seq - n was received */
+static uint64_t rx_window;
+static struct echo_stats stats;
+static struct k_spinlock lock;
+
+static void expire_lost(uint32_t now)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(probes); i++) {
+		if (probes[i].in_flight &&
+		    now - probes[i].sent_ms >= CONFIG_MQTT_CLIENT_ECHO_TIMEOUT_SEC * MSEC_PER_SEC) {
+			LOG_WRN("Echo %u lost", probes[i].seq);
+			probes[i].in_flight = false;
+			stats.lost++;
+		}
+	}
+}
+
+/* Record a received sequence number, @return true if it was seen before */
+static bool rx_window_mark(uint32_t seq)
+{
+	uint32_t diff;
+	bool seen;
+
+	if (seq > highest_rx_seq) {
+		diff = seq - highest_rx_seq;
+		rx_window = (diff >= RX_WINDOW_BITS) ? 0 : rx_window << diff;
+		rx_window |= 1;
+		highest_rx_seq = seq;
+		return false;
+	}
+
+	diff = highest_rx_seq - seq;
+	if (diff >= RX_WINDOW_BITS) {
+		/* Too old to tell */
+		return false;
+	}
+
+	seen = rx_window & BIT64(diff);
+	rx_window |= BIT64(diff);
+	return seen;
+}
+
+static bool probe_parse(const uint8_t *payload, size_t len, uint32_t *seq, uint32_t *sent_ms)
+{
+	char buf[PROBE_PAYLOAD_MAX_LEN + 1];
+	char *end;
+
+	if (len == 0 || len > PROBE_PAYLOAD_MAX_LEN) {
+		return false;
+	}
+
+	memcpy(buf, payload, len);
+	buf[len] = '\0';
+
+	*seq = strtoul(buf, &end, 10);
+	if (end == buf || *end != ':') {
+		return false;
+	}
+
+	*sent_ms = strtoul(end + 1, &end, 10);
+	return *end == '\0';
+}
+
+int mqtt_echo_monitor_probe(char *buf, size_t size)
+{
+	uint32_t now = k_uptime_get_32();
+	struct echo_probe *slot = NULL;
+	k_spinlock_key_t key;
+	uint32_t seq;
+	int len;
+
+	key = k_spin_lock(&lock);
+
+	expire_lost(now);
+
+	for (size_t i = 0; i < ARRAY_SIZE(probes); i++) {
+		if (!probes[i].in_flight) {
+			slot = &probes[i];
+			break;
+		}
+		/* Table full, give up on the oldest probe */
+		if (!slot || probes[i].seq < slot->seq) {
+			slot = &probes[i];
+		}
+	}
+
+	if (slot->in_flight) {
+		stats.lost++;
+	}
+
+	seq = next_seq++;
+	slot->seq = seq;
+	slot->sent_ms = now;
+	slot->in_flight = true;
+	stats.sent++;
+
+	k_spin_unlock(&lock, key);
+
+	len = snprintk(buf, size, "%u:%u", seq, now);
+	if (len < 0 || (size_t)len >= size) {
+		mqtt_echo_monitor_cancel();
+		return -ENOBUFS;
+	}
+
+	return len;
+}
+
+void mqtt_echo_monitor_cancel(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	for (size_t i = 0; i < ARRAY_SIZE(probes); i++) {
+		if (probes[i].in_flight && probes[i].seq == next_seq - 1) {
+			probes[i].in_flight = false;
+			stats.sent--;
+			break;
+		}
+	}
+
+	k_spin_unlock(&lock, key);
+}
+
+void mqtt_echo_monitor_received(const uint8_t *payload, size_t len)
+{
+	uint32_t now = k_uptime_get_32();
+	struct echo_probe *probe = NULL;
+	k_spinlock_key_t key;
+	uint32_t seq;
+	uint32_t sent_ms;
+	uint32_t rtt_ms;
+	bool reordered;
+
+	if (!probe_parse(payload, len, &seq, &sent_ms)) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+
+	for (size_t i = 0; i < ARRAY_SIZE(probes); i++) {
+		if (probes[i].in_flight && probes[i].seq == seq && probes[i].sent_ms == sent_ms) {
+			probe = &probes[i];
+			break;
+		}
+	}
+
+	reordered = (seq < highest_rx_seq);
+
+	if (rx_window_mark(seq) && !probe) {
+		stats.duplicates++;
+		k_spin_unlock(&lock, key);
+		LOG_WRN("Duplicate echo %u", seq);
+		return;
+	}
+
+	if (!probe) {
+		/* Already counted as lost, or sent before a reboot */
+		k_spin_unlock(&lock, key);
+		LOG_DBG("Late or unknown echo %u", seq);
+		return;
+	}
+
+	probe->in_flight = false;
+	rtt_ms = now - sent_ms;
+
+	if (stats.received == 0 || rtt_ms < stats.rtt_min_ms) {
+		stats.rtt_min_ms = rtt_ms;
+	}
+	stats.rtt_max_ms = MAX(stats.rtt_max_ms, rtt_ms);
+	stats.rtt_sum_ms += rtt_ms;
+	stats.received++;
+	if (reordered) {
+		stats.reordered++;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	LOG_INF("Echo %u RTT %u ms%s", seq, rtt_ms, reordered ? " (reordered)" : "");
+}
+
+void mqtt_echo_monitor_collect(void)
+{
+	struct echo_stats interval;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	expire_lost(k_uptime_get_32());
+	interval = stats;
+	memset(&stats, 0, sizeof(stats));
+	k_spin_unlock(&lock, key);
+
+	MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_sent_count, interval.sent);
+	MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_lost_count, interval.lost);
+	MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_reorder_count, interval.reordered);
+	MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_dup_count, interval.duplicates);
+
+	/* Leave RTT metrics unset for intervals without a sample */
+	if (interval.received > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_rtt_min_ms, interval.rtt_min_ms);
+		MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_rtt_max_ms, interval.rtt_max_ms);
+		MEMFAULT_METRIC_SET_UNSIGNED(mqtt_echo_rtt_avg_ms,
+					     (uint32_t)(interval.rtt_sum_ms / interval.received));
+	}
+
+	LOG_INF("MQTT echo interval - sent: %u, received: %u, lost: %u, reordered: %u, "
+		"duplicates: %u",
+		interval.sent, interval.received, interval.lost, interval.reordered,
+		interval.duplicates);
+}
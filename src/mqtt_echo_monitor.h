@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef MQTT_ECHO_MONITOR_H_
+#define MQTT_ECHO_MONITOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Build the payload of the next echo probe and track it as in flight
+ *
+ * The payload is "<seq>:<send uptime ms>". Call mqtt_echo_monitor_cancel()
+ * if the probe could not be published.
+ *
+ * @param buf Destination buffer
+ * @param size Size of @p buf
+ * @return Payload length on success, negative error code on failure
+ */
+int mqtt_echo_monitor_probe(char *buf, size_t size);
+
+/**
+ * @brief Forget the most recent probe after a local publish failure
+ */
+void mqtt_echo_monitor_cancel(void);
+
+/**
+ * @brief Match a received echo against the probes in flight
+ *
+ * Payloads that are not echo probes are ignored.
+ */
+void mqtt_echo_monitor_received(const uint8_t *payload, size_t len);
+
+/**
+ * @brief Publish the statistics of the elapsed heartbeat interval and restart them
+ *
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void mqtt_echo_monitor_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_ECHO_MONITOR_H_ */
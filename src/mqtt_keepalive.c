@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Per-network keepalive interval search. Each network entry holds the longest
+ * interval confirmed to survive (safe) and the shortest one seen to fail
+ * (unsafe). Probing climbs from safe towards unsafe, so a NAT timeout is
+ * found with a handful of reconnects and never probed again afterwards.
+ */
+
+#include "mqtt_keepalive.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/net_mgmt.h>
+#include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/settings/settings.h>
+#include <memfault/metrics/metrics.h>
+
+LOG_MODULE_REGISTER(mqtt_keepalive, CONFIG_MQTT_CLIENT_LOG_LEVEL);
+
+BUILD_ASSERT(CONFIG_MQTT_CLIENT_KEEPALIVE_CEILING_SEC < CONFIG_MQTT_KEEPALIVE,
+	     "CONFIG_MQTT_KEEPALIVE must exceed the adaptive keepalive ceiling");
+
+#define SETTINGS_SUBTREE "mqtt_ka"
+#define SETTINGS_KEY	 "nets"
+
+struct ka_net {
+	uint8_t bssid[WIFI_MAC_ADDR_LEN];
+	/* Longest interval confirmed, 0 if none yet */
+	uint16_t safe_sec;
+	/* Shortest interval that lost the connection, 0 if none yet */
+	uint16_t unsafe_sec;
+	/* Recency for replacement, 0 marks an unused entry */
+	uint32_t last_used;
+};
+
+static struct ka_net nets[CONFIG_MQTT_CLIENT_KEEPALIVE_NETWORKS];
+/* Used while the BSSID is unknown, never persisted */
+static struct ka_net unknown_net;
+static struct ka_net *net = &unknown_net;
+static uint32_t use_seq;
+
+static uint16_t probe_sec = CONFIG_MQTT_CLIENT_KEEPALIVE_FLOOR_SEC;
+static uint8_t confirmed;
+
+static int ka_settings_set(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	const char *next;
+	int rc;
+
+	if (!settings_name_steq(key, SETTINGS_KEY, &next) || next) {
+		return -ENOENT;
+	}
+
+	/* Discard a table stored with a different number of entries */
+	if (len != sizeof(nets)) {
+		return 0;
+	}
+
+	rc = read_cb(cb_arg, nets, sizeof(nets));
+	if (rc < 0) {
+		memset(nets, 0, sizeof(nets));
+		return rc;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(nets); i++) {
+		use_seq = MAX(use_seq, nets[i].last_used);
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(mqtt_ka, SETTINGS_SUBTREE, NULL, ka_settings_set, NULL, NULL);
+
+static void save(void)
+{
+	int err;
+
+	if (net == &unknown_net) {
+		return;
+	}
+
+	err = settings_save_one(SETTINGS_SUBTREE "/" SETTINGS_KEY, nets, sizeof(nets));
+	if (err) {
+		LOG_WRN("Failed to persist keepalive table: %d", err);
+	}
+}
+
+static void probe_set(uint16_t sec)
+{
+	probe_sec = sec;
+	confirmed = 0;
+	MEMFAULT_METRIC_SET_UNSIGNED(mqtt_keepalive_interval_sec, probe_sec);
+}
+
+/* Next interval to try above the confirmed one */
+static uint16_t next_interval(void)
+{
+	uint16_t safe = net->safe_sec;
+
+	if (net->unsafe_sec) {
+		if (net->unsafe_sec - safe <= CONFIG_MQTT_CLIENT_KEEPALIVE_RESOLUTION_SEC) {
+			return safe;
+		}
+		return safe + (net->unsafe_sec - safe) / 2;
+	}
+
+	return MIN(safe * 2, CONFIG_MQTT_CLIENT_KEEPALIVE_CEILING_SEC);
+}
+
+static struct ka_net *net_lookup(const uint8_t *bssid)
+{
+	struct ka_net *oldest = &nets[0];
+
+	for (size_t i = 0; i < ARRAY_SIZE(nets); i++) {
+		if (nets[i].last_used && memcmp(nets[i].bssid, bssid, WIFI_MAC_ADDR_LEN) == 0) {
+			return &nets[i];
+		}
+		if (nets[i].last_used < oldest->last_used) {
+			oldest = &nets[i];
+		}
+	}
+
+	memset(oldest, 0, sizeof(*oldest));
+	memcpy(oldest->bssid, bssid, WIFI_MAC_ADDR_LEN);
+	return oldest;
+}
+
+int mqtt_keepalive_init(void)
+{
+	int err;
+
+	err = settings_subsys_init();
+	if (err) {
+		LOG_ERR("Settings init failed: %d", err);
+		return err;
+	}
+
+	return settings_load_subtree(SETTINGS_SUBTREE);
+}
+
+void mqtt_keepalive_network_select(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct wifi_iface_status status = {0};
+
+	if (!iface || net_mgmt(NET_REQUEST_WIFI_IFACE_STATUS, iface, &status, sizeof(status)) ||
+	    status.state != WIFI_STATE_COMPLETED) {
+		LOG_WRN("BSSID unknown, keepalive interval not persisted");
+		net = &unknown_net;
+	} else {
+		net = net_lookup(status.bssid);
+		net->last_used = ++use_seq;
+	}
+
+	probe_set(net->safe_sec ? net->safe_sec : CONFIG_MQTT_CLIENT_KEEPALIVE_FLOOR_SEC);
+
+	LOG_INF("Keepalive %u s (safe %u s, unsafe %u s)", probe_sec, net->safe_sec,
+		net->unsafe_sec);
+}
+
+uint32_t mqtt_keepalive_interval_sec(void)
+{
+	return probe_sec;
+}
+
+void mqtt_keepalive_probe_acked(void)
+{
+	uint16_t next;
+
+	if (++confirmed < CONFIG_MQTT_CLIENT_KEEPALIVE_CONFIRMATIONS) {
+		return;
+	}
+
+	confirmed = 0;
+
+	if (probe_sec > net->safe_sec) {
+		net->safe_sec = probe_sec;
+		LOG_INF("Keepalive %u s confirmed", probe_sec);
+		save();
+	}
+
+	next = next_interval();
+	if (next != probe_sec) {
+		LOG_INF("Probing keepalive %u s", next);
+		probe_set(next);
+	}
+}
+
+void mqtt_keepalive_probe_lost(void)
+{
+	MEMFAULT_METRIC_ADD(mqtt_keepalive_nat_drop_count, 1);
+
+	net->unsafe_sec = probe_sec;
+
+	if (probe_sec <= net->safe_sec) {
+		/* A confirmed interval failed, the path changed: search again below it */
+		net->safe_sec = 0;
+		probe_set(MAX(probe_sec / 2, CONFIG_MQTT_CLIENT_KEEPALIVE_FLOOR_SEC));
+	} else {
+		probe_set(net->safe_sec ? net->safe_sec : CONFIG_MQTT_CLIENT_KEEPALIVE_FLOOR_SEC);
+	}
+
+	LOG_WRN("Connection lost after %u s idle, keepalive back to %u s", net->unsafe_sec,
+		probe_sec);
+	save();
+}
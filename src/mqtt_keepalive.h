@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef MQTT_KEEPALIVE_H_
+#define MQTT_KEEPALIVE_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Adaptive keepalive interval controller
+ *
+ * Finds the longest idle time the network path (typically a NAT) keeps the
+ * broker connection alive for. The MQTT client sends a probe after the
+ * connection was idle for mqtt_keepalive_interval_sec() and reports whether
+ * the broker acknowledged it. Starting from CONFIG_MQTT_CLIENT_KEEPALIVE_FLOOR_SEC
+ * the interval is doubled after each confirmed step, and narrowed down by
+ * bisection once a probe was lost. The result is kept per access point BSSID
+ * in settings, so known networks start at their converged interval.
+ *
+ * Not thread safe, all functions are called from the MQTT client thread.
+ */
+
+/**
+ * @brief Load the intervals learned before reboot
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int mqtt_keepalive_init(void);
+
+/**
+ * @brief Switch to the network the device is currently associated with
+ *
+ * Call after each broker connection is established.
+ */
+void mqtt_keepalive_network_select(void);
+
+/**
+ * @brief Idle time after which the next probe is due
+ */
+uint32_t mqtt_keepalive_interval_sec(void);
+
+/**
+ * @brief The probe sent after a full idle interval was acknowledged
+ */
+void mqtt_keepalive_probe_acked(void);
+
+/**
+ * @brief The probe sent after a full idle interval was not acknowledged
+ *
+ * The connection is assumed to have been dropped silently by the path.
+ */
+void mqtt_keepalive_probe_lost(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_KEEPALIVE_H_ */
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Store-and-forward queue for MQTT publishes.
+ *
+ * Payloads are queued in a small RAM cache first, so short outages never touch
+ * flash. When the cache overflows, its oldest entry is moved to the flash ring,
+ * which keeps every payload in flash older than every payload in RAM: draining
+ * flash first and RAM second preserves publish order.
+ */
+
+#include "mqtt_pub_queue.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/random/random.h>
+#include <zephyr/storage/flash_map.h>
+#include <memfault/metrics/metrics.h>
+
+#include "flash_ring.h"
+
+LOG_MODULE_REGISTER(mqtt_pub_queue, CONFIG_MQTT_CLIENT_LOG_LEVEL);
+
+/* Queued payload as stored in RAM and, up to the payload length, in flash */
+struct pub_rec {
+	/* Random per boot, tells whether enqueued_ms is comparable to the current uptime */
+	uint32_t boot_token;
+	uint32_t enqueued_ms;
+	uint8_t payload[CONFIG_MQTT_PUB_QUEUE_MAX_PAYLOAD];
+};
+
+#define PUB_REC_HDR_LEN offsetof(struct pub_rec, payload)
+
+struct ram_entry {
+	struct pub_rec rec;
+	uint16_t len;
+};
+
+static struct ram_entry ram_cache[CONFIG_MQTT_PUB_QUEUE_RAM_ENTRIES];
+static size_t ram_head;
+static size_t ram_count;
+static uint32_t ram_dropped;
+
+static struct flash_ring ring;
+static bool ring_ready;
+static uint32_t boot_token;
+
+/* Scratch record for flash reads, used with queue_lock held */
+static struct pub_rec flash_rec;
+
+static K_MUTEX_DEFINE(queue_lock);
+
+static uint32_t dropped_total(void)
+{
+	return ram_dropped + (ring_ready ? flash_ring_dropped(&ring) : 0);
+}
+
+static void metrics_update(void)
+{
+	MEMFAULT_METRIC_SET_UNSIGNED(mqtt_queue_depth, mqtt_pub_queue_depth());
+	MEMFAULT_METRIC_SET_UNSIGNED(mqtt_queue_drop_count, dropped_total());
+}
+
+static void ram_pop(void)
+{
+	ram_head = (ram_head + 1) % ARRAY_SIZE(ram_cache);
+	ram_count--;
+}
+
+/* Make room in the RAM cache by moving its oldest entry to flash */
+static void ram_spill(void)
+{
+	struct ram_entry *oldest = &ram_cache[ram_head];
+	int err = -ENODEV;
+
+	if (ring_ready) {
+		err = flash_ring_append(&ring, &oldest->rec, PUB_REC_HDR_LEN + oldest->len);
+	}
+
+	if (err) {
+		LOG_WRN("Queue full, dropping oldest publish (err %d)", err);
+		ram_dropped++;
+	}
+
+	ram_pop();
+}
+
+int mqtt_pub_queue_init(void)
+{
+	int err;
+
+	boot_token = sys_rand32_get();
+
+	err = flash_ring_init(&ring, FIXED_PARTITION_ID(mqtt_queue_storage));
+	if (err) {
+		LOG_ERR("Flash queue unavailable, err %d, queueing in RAM only", err);
+		return err;
+	}
+
+	if (flash_ring_max_record_len(&ring) < sizeof(struct pub_rec)) {
+		LOG_ERR("CONFIG_MQTT_PUB_QUEUE_MAX_PAYLOAD exceeds the flash sector size");
+		return -EINVAL;
+	}
+
+	ring_ready = true;
+
+	if (flash_ring_count(&ring) > 0) {
+		LOG_INF("%u publish(es) queued before reboot", flash_ring_count(&ring));
+	}
+
+	metrics_update();
+	return 0;
+}
+
+int mqtt_pub_queue_push(const void *payload, size_t len)
+{
+	struct ram_entry *entry;
+
+	if (len > CONFIG_MQTT_PUB_QUEUE_MAX_PAYLOAD) {
+		return -EMSGSIZE;
+	}
+
+	k_mutex_lock(&queue_lock, K_FOREVER);
+
+	if (ram_count == ARRAY_SIZE(ram_cache)) {
+		ram_spill();
+	}
+
+	entry = &ram_cache[(ram_head + ram_count) % ARRAY_SIZE(ram_cache)];
+	entry->rec.boot_token = boot_token;
+	entry->rec.enqueued_ms = k_uptime_get_32();
+	entry->len = len;
+	memcpy(entry->rec.payload, payload, len);
+	ram_count++;
+
+	metrics_update();
+
+	k_mutex_unlock(&queue_lock);
+
+	LOG_DBG("Queued %zu byte publish, depth %u", len, mqtt_pub_queue_depth());
+	return 0;
+}
+
+static int64_t rec_age_ms(const struct pub_rec *rec)
+{
+	if (rec->boot_token != boot_token) {
+		return -1;
+	}
+
+	return (uint32_t)(k_uptime_get_32() - rec->enqueued_ms);
+}
+
+int mqtt_pub_queue_peek(void *buf, size_t size, int64_t *age_ms)
+{
+	const struct pub_rec *rec = NULL;
+	int len = -ENODATA;
+
+	k_mutex_lock(&queue_lock, K_FOREVER);
+
+	if (ring_ready && flash_ring_count(&ring) > 0) {
+		len = flash_ring_peek(&ring, &flash_rec, sizeof(flash_rec));
+		if (len >= (int)PUB_REC_HDR_LEN) {
+			rec = &flash_rec;
+			len -= PUB_REC_HDR_LEN;
+		} else if (len >= 0) {
+			/* Not one of ours, discard it */
+			(void)flash_ring_consume(&ring);
+			len = -EAGAIN;
+		}
+	} else if (ram_count > 0) {
+		rec = &ram_cache[ram_head].rec;
+		len = ram_cache[ram_head].len;
+	}
+
+	if (rec) {
+		if ((size_t)len > size) {
+			len = -ENOBUFS;
+		} else {
+			memcpy(buf, rec->payload, len);
+			if (age_ms) {
+				*age_ms = rec_age_ms(rec);
+			}
+		}
+	}
+
+	k_mutex_unlock(&queue_lock);
+	return len;
+}
+
+void mqtt_pub_queue_pop(void)
+{
+	k_mutex_lock(&queue_lock, K_FOREVER);
+
+	if (ring_ready && flash_ring_count(&ring) > 0) {
+		(void)flash_ring_consume(&ring);
+	} else if (ram_count > 0) {
+		ram_pop();
+	}
+
+	metrics_update();
+
+	k_mutex_unlock(&queue_lock);
+}
+
+uint32_t mqtt_pub_queue_depth(void)
+{
+	return ram_count + (ring_ready ? flash_ring_count(&ring) : 0);
+}
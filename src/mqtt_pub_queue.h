@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef MQTT_PUB_QUEUE_H_
+#define MQTT_PUB_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Initialize the publish queue
+ *
+ * Recovers publishes persisted before a reboot from the mqtt_queue_storage
+ * partition. If the partition cannot be used the queue keeps working from RAM
+ * only.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int mqtt_pub_queue_init(void);
+
+/**
+ * @brief Queue a payload for later publishing
+ *
+ * New payloads are kept in RAM. When the RAM cache is full its oldest entry is
+ * moved to flash, and when flash is full its oldest sector is dropped.
+ *
+ * @return 0 on success, -EMSGSIZE if the payload is larger than
+ *         CONFIG_MQTT_PUB_QUEUE_MAX_PAYLOAD
+ */
+int mqtt_pub_queue_push(const void *payload, size_t len);
+
+/**
+ * @brief Read the oldest queued payload without removing it
+ *
+ * @param buf Destination buffer, at least CONFIG_MQTT_PUB_QUEUE_MAX_PAYLOAD bytes
+ * @param size Size of @p buf
+ * @param age_ms Set to the time the payload has been queued, or -1 if it was
+ *               queued before the last reboot
+ * @return Payload length on success, -ENODATA if the queue is empty,
+ *         -EAGAIN if an unusable record was discarded and the call should be retried
+ */
+int mqtt_pub_queue_peek(void *buf, size_t size, int64_t *age_ms);
+
+/**
+ * @brief Remove the oldest queued payload after it was published
+ */
+void mqtt_pub_queue_pop(void);
+
+/**
+ * @brief Number of queued payloads
+ */
+uint32_t mqtt_pub_queue_depth(void);
+
+#endif /* MQTT_PUB_QUEUE_H_ */
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Connectivity event fan-out. The net_mgmt callback only records the new
+ * state and submits one work item per subscriber, the handlers run on a
+ * dedicated workqueue. A slow subscriber delays the others, but not the
+ * network stack, and is named in the log.
+ *
+ * State is level-triggered: a generation counter counts every change, a
+ * subscriber compares it with the generation it last saw, so bursts merge
+ * into one call and a flap it missed is replayed as both edges.
+ */
+
+#include "net_events.h"
+
+#include <zephyr/logging/log.h>
+#include <zephyr/net/conn_mgr_monitor.h>
+#include <zephyr/net/net_mgmt.h>
+#include <memfault/metrics/metrics.h>
+
+LOG_MODULE_REGISTER(net_events, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define L4_EVENT_MASK	      (NET_EVENT_L4_CONNECTED | NET_EVENT_L4_DISCONNECTED)
+#define CONN_LAYER_EVENT_MASK (NET_EVENT_CONN_IF_FATAL_ERROR)
+
+#define NET_EVENTS_PRIORITY K_PRIO_PREEMPT(5)
+
+K_THREAD_STACK_DEFINE(net_events_stack, CONFIG_NET_EVENTS_STACK_SIZE);
+static struct k_work_q net_events_wq;
+
+static struct net_mgmt_event_callback l4_cb;
+static struct net_mgmt_event_callback conn_cb;
+
+static struct k_spinlock lock;
+static sys_slist_t subs = SYS_SLIST_STATIC_INIT(&subs);
+static bool wq_started;
+static bool connected;
+static uint32_t generation;
+static int64_t changed_at;
+
+/* Worst cases of the current heartbeat interval */
+static uint32_t deliveries;
+static uint32_t max_latency_ms;
+static uint32_t max_handler_ms;
+
+static void deliver(struct net_events_sub *sub, bool state, int64_t since)
+{
+	int64_t start = k_uptime_get();
+	uint32_t latency_ms = (uint32_t)(start - since);
+	uint32_t handler_ms;
+	k_spinlock_key_t key;
+
+	sub->handler(state);
+	handler_ms = (uint32_t)(k_uptime_get() - start);
+
+	if (handler_ms >= CONFIG_NET_EVENTS_SLOW_HANDLER_MS) {
+		LOG_WRN("Subscriber %s took %u ms", sub->name, handler_ms);
+	}
+
+	key = k_spin_lock(&lock);
+	deliveries++;
+	max_latency_ms = MAX(max_latency_ms, latency_ms);
+	max_handler_ms = MAX(max_handler_ms, handler_ms);
+	k_spin_unlock(&lock, key);
+}
+
+static void sub_work_fn(struct k_work *work)
+{
+	struct net_events_sub *sub = CONTAINER_OF(work, struct net_events_sub, work);
+	k_spinlock_key_t key;
+	uint32_t gen;
+	bool state;
+	int64_t since;
+
+	key = k_spin_lock(&lock);
+	gen = generation;
+	state = connected;
+	since = changed_at;
+	k_spin_unlock(&lock, key);
+
+	if (gen == sub->seen_gen) {
+		return;
+	}
+
+	if (state == sub->seen_connected) {
+		/* Changed and changed back before we ran */
+		deliver(sub, !state, since);
+	}
+	deliver(sub, state, since);
+
+	sub->seen_gen = gen;
+	sub->seen_connected = state;
+}
+
+static void state_set(bool state)
+{
+	struct net_events_sub *sub;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	if (state == connected) {
+		k_spin_unlock(&lock, key);
+		return;
+	}
+
+	connected = state;
+	generation++;
+	changed_at = k_uptime_get();
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&subs, sub, node) {
+		k_work_submit_to_queue(&net_events_wq, &sub->work);
+	}
+	k_spin_unlock(&lock, key);
+}
+
+static void l4_event_handler(struct net_mgmt_event_callback *cb, uint64_t mgmt_event,
+			     struct net_if *iface)
+{
+	ARG_UNUSED(cb);
+	ARG_UNUSED(iface);
+
+	switch (mgmt_event) {
+	case NET_EVENT_L4_CONNECTED:
+		LOG_INF("Network connectivity established");
+		state_set(true);
+		break;
+	case NET_EVENT_L4_DISCONNECTED:
+		LOG_INF("Network connectivity lost");
+		state_set(false);
+		break;
+	default:
+		break;
+	}
+}
+
+static void conn_event_handler(struct net_mgmt_event_callback *cb, uint64_t mgmt_event,
+			       struct net_if *iface)
+{
+	ARG_UNUSED(cb);
+	ARG_UNUSED(iface);
+
+	if (mgmt_event == NET_EVENT_CONN_IF_FATAL_ERROR) {
+		LOG_ERR("Connectivity fatal error");
+		state_set(false);
+	}
+}
+
+void net_events_init(void)
+{
+	struct k_work_queue_config cfg = {
+		.name = "net_events",
+	};
+	k_spinlock_key_t key;
+
+	k_work_queue_start(&net_events_wq, net_events_stack,
+			   K_THREAD_STACK_SIZEOF(net_events_stack), NET_EVENTS_PRIORITY, &cfg);
+
+	key = k_spin_lock(&lock);
+	wq_started = true;
+	k_spin_unlock(&lock, key);
+
+	net_mgmt_init_event_callback(&l4_cb, l4_event_handler, L4_EVENT_MASK);
+	net_mgmt_add_event_callback(&l4_cb);
+
+	net_mgmt_init_event_callback(&conn_cb, conn_event_handler, CONN_LAYER_EVENT_MASK);
+	net_mgmt_add_event_callback(&conn_cb);
+}
+
+void net_events_subscribe(struct net_events_sub *sub)
+{
+	k_spinlock_key_t key;
+
+	k_work_init(&sub->work, sub_work_fn);
+
+	key = k_spin_lock(&lock);
+	/* Seen as disconnected, one generation behind if connected */
+	sub->seen_connected = false;
+	sub->seen_gen = connected ? generation - 1 : generation;
+	sys_slist_append(&subs, &sub->node);
+	if (connected && wq_started) {
+		k_work_submit_to_queue(&net_events_wq, &sub->work);
+	}
+	k_spin_unlock(&lock, key);
+
+	LOG_DBG("Subscriber %s added", sub->name);
+}
+
+bool net_events_connected(void)
+{
+	return connected;
+}
+
+void net_events_collect(void)
+{
+	uint32_t count, latency_ms, handler_ms;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	count = deliveries;
+	latency_ms = max_latency_ms;
+	handler_ms = max_handler_ms;
+	deliveries = 0;
+	max_latency_ms = 0;
+	max_handler_ms = 0;
+	k_spin_unlock(&lock, key);
+
+	MEMFAULT_METRIC_SET_UNSIGNED(net_event_delivery_count, count);
+
+	/* Leave timing metrics unset for intervals without a delivery */
+	if (count > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(net_event_max_latency_ms, latency_ms);
+		MEMFAULT_METRIC_SET_UNSIGNED(net_event_max_handler_ms, handler_ms);
+	}
+}
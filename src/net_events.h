@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Connectivity change handler
+ *
+ * Runs on the network event workqueue, never on the net_mgmt thread.
+ *
+ * @param connected true once L4 connectivity is up, false when it is lost.
+ */
+typedef void (*net_events_handler_t)(bool connected);
+
+/** Subscriber, define with NET_EVENTS_SUB_DEFINE(). */
+struct net_events_sub {
+	const char *name;
+	net_events_handler_t handler;
+
+	/* Private */
+	sys_snode_t node;
+	struct k_work work;
+	uint32_t seen_gen;
+	bool seen_connected;
+};
+
+#define NET_EVENTS_SUB_DEFINE(_name, _handler)                                                     \
+	static struct net_events_sub _name = {                                                     \
+		.name = #_name,                                                                    \
+		.handler = _handler,                                                               \
+	}
+
+/**
+ * @brief Start the workqueue and register for connectivity events.
+ *
+ * Subscribing is possible before, e.g. from SYS_INIT.
+ */
+void net_events_init(void);
+
+/**
+ * @brief Subscribe to connectivity changes.
+ *
+ * A subscriber added while connected is told so right away. Each subscriber
+ * has its own work item; changes that pile up while it is busy are merged,
+ * a missed disconnect and reconnect is still delivered as both.
+ */
+void net_events_subscribe(struct net_events_sub *sub);
+
+/**
+ * @brief Get the current L4 connectivity state.
+ */
+bool net_events_connected(void);
+
+/**
+ * @brief Publish delivery latency and handler time of the elapsed interval.
+ *
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void net_events_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
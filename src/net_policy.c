@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "net_policy.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/random/random.h>
+#include <zephyr/sys/util.h>
+
+/* RFC 6298 gains: alpha = 1/8, beta = 1/4, K = 4 */
+#define RTT_ALPHA_SHIFT 3
+#define RTT_BETA_SHIFT  2
+#define RTT_K           4
+
+/* Keep base * 2^attempt within 32 bits */
+#define BACKOFF_MAX_SHIFT 16
+
+static uint32_t rto_compute(const struct net_rtt_estimator *est)
+{
+	uint64_t rto = (uint64_t)est->srtt_ms + MAX(1U, RTT_K * est->rttvar_ms);
+
+	return CLAMP(rto, est->min_rto_ms, est->max_rto_ms);
+}
+
+void net_rtt_init(struct net_rtt_estimator *est, uint32_t initial_rto_ms, uint32_t min_rto_ms,
+		  uint32_t max_rto_ms)
+{
+	est->srtt_ms = 0;
+	est->rttvar_ms = 0;
+	est->min_rto_ms = min_rto_ms;
+	est->max_rto_ms = max_rto_ms;
+	est->rto_ms = CLAMP(initial_rto_ms, min_rto_ms, max_rto_ms);
+	est->has_sample = false;
+}
+
+void net_rtt_update(struct net_rtt_estimator *est, uint32_t sample_ms)
+{
+	if (!est->has_sample) {
+		est->srtt_ms = sample_ms;
+		est->rttvar_ms = sample_ms / 2;
+		est->has_sample = true;
+	} else {
+		uint32_t delta = (est->srtt_ms > sample_ms) ? est->srtt_ms - sample_ms
+							    : sample_ms - est->srtt_ms;
+
+		est->rttvar_ms = est->rttvar_ms - (est->rttvar_ms >> RTT_BETA_SHIFT) +
+				 (delta >> RTT_BETA_SHIFT);
+		est->srtt_ms = est->srtt_ms - (est->srtt_ms >> RTT_ALPHA_SHIFT) +
+			       (sample_ms >> RTT_ALPHA_SHIFT);
+	}
+
+	est->rto_ms = rto_compute(est);
+}
+
+void net_rtt_timeout_backoff(struct net_rtt_estimator *est)
+{
+	est->rto_ms = MIN((uint64_t)est->rto_ms * 2, est->max_rto_ms);
+}
+
+uint32_t net_rtt_timeout_ms(const struct net_rtt_estimator *est)
+{
+	return est->rto_ms;
+}
+
+void net_backoff_init(struct net_backoff *backoff, uint32_t base_ms, uint32_t cap_ms)
+{
+	backoff->base_ms = base_ms;
+	backoff->cap_ms = MAX(base_ms, cap_ms);
+	backoff->attempt = 0;
+}
+
+uint32_t net_backoff_next_ms(struct net_backoff *backoff)
+{
+	uint64_t ceiling = (uint64_t)backoff->base_ms << MIN(backoff->attempt, BACKOFF_MAX_SHIFT);
+
+	ceiling = MIN(ceiling, backoff->cap_ms);
+
+	if (backoff->attempt < UINT8_MAX) {
+		backoff->attempt++;
+	}
+
+	return sys_rand32_get() % ((uint32_t)ceiling + 1);
+}
+
+void net_backoff_reset(struct net_backoff *backoff)
+{
+	backoff->attempt = 0;
+}
+
+void net_breaker_init(struct net_breaker *breaker, uint16_t threshold, uint32_t open_ms)
+{
+	breaker->state = NET_BREAKER_CLOSED;
+	breaker->failures = 0;
+	breaker->threshold = MAX(threshold, 1);
+	breaker->open_ms = open_ms;
+	breaker->opened_at = 0;
+}
+
+bool net_breaker_allow(struct net_breaker *breaker)
+{
+	switch (breaker->state) {
+	case NET_BREAKER_CLOSED:
+		return true;
+	case NET_BREAKER_OPEN:
+		if (net_breaker_remaining_ms(breaker) == 0) {
+			/* Cool-down elapsed, let a single trial attempt through */
+			breaker->state = NET_BREAKER_HALF_OPEN;
+			return true;
+		}
+		return false;
+	case NET_BREAKER_HALF_OPEN:
+	default:
+		/* Trial attempt in progress */
+		return false;
+	}
+}
+
+void net_breaker_success(struct net_breaker *breaker)
+{
+	breaker->state = NET_BREAKER_CLOSED;
+	breaker->failures = 0;
+}
+
+bool net_breaker_failure(struct net_breaker *breaker)
+{
+	if (breaker->failures < UINT16_MAX) {
+		breaker->failures++;
+	}
+
+	if (breaker->state == NET_BREAKER_HALF_OPEN ||
+	    (breaker->state == NET_BREAKER_CLOSED && breaker->failures >= breaker->threshold)) {
+		breaker->state = NET_BREAKER_OPEN;
+		breaker->opened_at = k_uptime_get();
+		return true;
+	}
+
+	return false;
+}
+
+void net_breaker_abort(struct net_breaker *breaker)
+{
+	if (breaker->state == NET_BREAKER_HALF_OPEN) {
+		breaker->state = NET_BREAKER_OPEN;
+		breaker->opened_at = k_uptime_get() - breaker->open_ms;
+	}
+}
+
+uint32_t net_breaker_remaining_ms(const struct net_breaker *breaker)
+{
+	int64_t elapsed;
+
+	if (breaker->state == NET_BREAKER_HALF_OPEN) {
+		/* The trial has to be resolved first */
+		return MAX(breaker->open_ms, 1);
+	}
+
+	if (breaker->state != NET_BREAKER_OPEN) {
+		return 0;
+	}
+
+	elapsed = k_uptime_get() - breaker->opened_at;
+	if (elapsed >= breaker->open_ms) {
+		return 0;
+	}
+
+	return breaker->open_ms - (uint32_t)elapsed;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef NET_POLICY_H_
+#define NET_POLICY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Round-trip time estimator (RFC 6298 SRTT/RTTVAR)
+ *
+ * Derives a request timeout from measured round-trip times instead of a fixed
+ * constant, so failures are detected quickly on good links while slow links
+ * still get enough time.
+ */
+struct net_rtt_estimator {
+	uint32_t srtt_ms;
+	uint32_t rttvar_ms;
+	uint32_t rto_ms;
+	uint32_t min_rto_ms;
+	uint32_t max_rto_ms;
+	bool has_sample;
+};
+
+/**
+ * @brief Exponential backoff with full jitter
+ *
+ * Each call to net_backoff_next_ms() returns a random delay in
+ * [0, min(cap, base * 2^attempt)], which spreads retries of a fleet
+ * recovering from the same outage instead of synchronizing them.
+ */
+struct net_backoff {
+	uint32_t base_ms;
+	uint32_t cap_ms;
+	uint8_t attempt;
+};
+
+enum net_breaker_state {
+	NET_BREAKER_CLOSED,
+	NET_BREAKER_OPEN,
+	NET_BREAKER_HALF_OPEN,
+};
+
+/**
+ * @brief Circuit breaker
+ *
+ * Opens after a number of consecutive failures and rejects attempts for a
+ * cool-down period. Afterwards a single trial attempt is allowed; its outcome
+ * closes or re-opens the breaker.
+ */
+struct net_breaker {
+	enum net_breaker_state state;
+	uint16_t failures;
+	uint16_t threshold;
+	uint32_t open_ms;
+	int64_t opened_at;
+};
+
+/**
+ * @brief Initialize an RTT estimator
+ *
+ * @param est Estimator to initialize
+ * @param initial_rto_ms Timeout used until the first sample is taken
+ * @param min_rto_ms Lower bound of the computed timeout
+ * @param max_rto_ms Upper bound of the computed timeout
+ */
+void net_rtt_init(struct net_rtt_estimator *est, uint32_t initial_rto_ms, uint32_t min_rto_ms,
+		  uint32_t max_rto_ms);
+
+/**
+ * @brief Feed a measured round-trip time into the estimator
+ *
+ * Only samples from attempts that were not retried should be fed (Karn's algorithm).
+ */
+void net_rtt_update(struct net_rtt_estimator *est, uint32_t sample_ms);
+
+/**
+ * @brief Double the current timeout after an attempt timed out
+ */
+void net_rtt_timeout_backoff(struct net_rtt_estimator *est);
+
+/**
+ * @brief Get the current adaptive timeout in milliseconds
+ */
+uint32_t net_rtt_timeout_ms(const struct net_rtt_estimator *est);
+
+/**
+ * @brief Initialize a backoff sequence
+ *
+ * @param backoff Backoff to initialize
+ * @param base_ms Delay ceiling of the first retry
+ * @param cap_ms Maximum delay ceiling
+ */
+void net_backoff_init(struct net_backoff *backoff, uint32_t base_ms, uint32_t cap_ms);
+
+/**
+ * @brief Get the delay before the next retry and advance the sequence
+ */
+uint32_t net_backoff_next_ms(struct net_backoff *backoff);
+
+/**
+ * @brief Restart the sequence after a successful attempt
+ */
+void net_backoff_reset(struct net_backoff *backoff);
+
+/**
+ * @brief Initialize a circuit breaker in the closed state
+ *
+ * @param breaker Breaker to initialize
+ * @param threshold Consecutive failures that open the breaker
+ * @param open_ms Time the breaker stays open before a trial attempt is allowed
+ */
+void net_breaker_init(struct net_breaker *breaker, uint16_t threshold, uint32_t open_ms);
+
+/**
+ * @brief Check whether an attempt may be made now
+ *
+ * @return true if the attempt is allowed, false while the breaker is open
+ */
+bool net_breaker_allow(struct net_breaker *breaker);
+
+/**
+ * @brief Record a successful attempt, closing the breaker
+ */
+void net_breaker_success(struct net_breaker *breaker);
+
+/**
+ * @brief Record a failed attempt
+ *
+ * @return true if this failure opened the breaker
+ */
+bool net_breaker_failure(struct net_breaker *breaker);
+
+/**
+ * @brief Abandon a trial attempt without an outcome
+ *
+ * For a trial cut short by something other than the peer, e.g. the network
+ * going down. The breaker returns to open with the cool-down elapsed, so the
+ * next attempt is a new trial. No effect unless a trial is in progress.
+ */
+void net_breaker_abort(struct net_breaker *breaker);
+
+/**
+ * @brief Get the time left until an open breaker allows a trial attempt
+ *
+ * While a trial is in progress the full cool-down is returned, so a caller
+ * waiting for the breaker never reschedules with 0 ms.
+ *
+ * @return Remaining milliseconds, 0 if the breaker is closed or a trial
+ *         attempt is allowed now
+ */
+uint32_t net_breaker_remaining_ms(const struct net_breaker *breaker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_POLICY_H_ */
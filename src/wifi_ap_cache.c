@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Last-good AP cache for fast reconnects. A connect request by SSID makes
+ * the supplicant scan every channel of every band first, which is most of
+ * the reconnect time after a short AP drop. With the BSSID, channel and band
+ * of the last connection the request scans a single channel.
+ *
+ * Only the AP is cached, the password is read from the Wi-Fi credentials
+ * store for each request.
+ */
+
+#include "wifi_ap_cache.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/net_mgmt.h>
+#include <zephyr/net/wifi_credentials.h>
+#include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/settings/settings.h>
+
+LOG_MODULE_REGISTER(wifi_ap_cache, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define SETTINGS_SUBTREE "wifi_ap"
+#define SETTINGS_KEY	 "last"
+
+struct ap_entry {
+	char ssid[WIFI_SSID_MAX_LEN];
+	uint8_t ssid_len;
+	uint8_t bssid[WIFI_MAC_ADDR_LEN];
+	uint8_t channel;
+	uint8_t band;
+};
+
+/* ssid_len 0 marks an empty cache */
+static struct ap_entry ap;
+
+static int ap_settings_set(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	const char *next;
+	int rc;
+
+	if (!settings_name_steq(key, SETTINGS_KEY, &next) || next) {
+		return -ENOENT;
+	}
+
+	if (len != sizeof(ap)) {
+		return 0;
+	}
+
+	rc = read_cb(cb_arg, &ap, sizeof(ap));
+	if (rc < 0 || ap.ssid_len > sizeof(ap.ssid)) {
+		memset(&ap, 0, sizeof(ap));
+		return rc < 0 ? rc : 0;
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(wifi_ap, SETTINGS_SUBTREE, NULL, ap_settings_set, NULL, NULL);
+
+int wifi_ap_cache_init(void)
+{
+	int err;
+
+	err = settings_subsys_init();
+	if (err) {
+		LOG_ERR("Settings init failed: %d", err);
+		return err;
+	}
+
+	err = settings_load_subtree(SETTINGS_SUBTREE);
+	if (!err && ap.ssid_len > 0) {
+		LOG_INF("Cached AP %02x:%02x:%02x:%02x:%02x:%02x on channel %u", ap.bssid[0],
+			ap.bssid[1], ap.bssid[2], ap.bssid[3], ap.bssid[4], ap.bssid[5],
+			ap.channel);
+	}
+
+	return err;
+}
+
+bool wifi_ap_cache_valid(void)
+{
+	return ap.ssid_len > 0 && ap.channel > 0;
+}
+
+int wifi_ap_cache_connect(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct wifi_credentials_personal creds = {0};
+	struct wifi_connect_req_params params = {0};
+	int err;
+
+	if (!wifi_ap_cache_valid() || !iface) {
+		return -ENOENT;
+	}
+
+	/* The credentials were removed or replaced since the AP was cached */
+	err = wifi_credentials_get_by_ssid_personal_struct(ap.ssid, ap.ssid_len, &creds);
+	if (err) {
+		LOG_DBG("No credentials for the cached AP: %d", err);
+		return -ENOENT;
+	}
+
+	params.ssid = (const uint8_t *)ap.ssid;
+	params.ssid_length = ap.ssid_len;
+	params.security = creds.header.type;
+	if (params.security == WIFI_SECURITY_TYPE_SAE) {
+		params.sae_password = (const uint8_t *)creds.password;
+		params.sae_password_length = creds.password_len;
+	} else {
+		params.psk = (const uint8_t *)creds.password;
+		params.psk_length = creds.password_len;
+	}
+	params.band = ap.band;
+	params.channel = ap.channel;
+	memcpy(params.bssid, ap.bssid, sizeof(params.bssid));
+	params.mfp = WIFI_MFP_OPTIONAL;
+	params.timeout = SYS_FOREVER_MS;
+
+	LOG_INF("Fast reconnect on channel %u", ap.channel);
+
+	err = net_mgmt(NET_REQUEST_WIFI_CONNECT, iface, &params, sizeof(params));
+	memset(&creds, 0, sizeof(creds));
+
+	return err;
+}
+
+void wifi_ap_cache_update(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct wifi_iface_status status = {0};
+	struct ap_entry entry = {0};
+	int err;
+
+	if (!iface || net_mgmt(NET_REQUEST_WIFI_IFACE_STATUS, iface, &status, sizeof(status)) ||
+	    status.state < WIFI_STATE_ASSOCIATED || status.ssid_len > sizeof(entry.ssid)) {
+		return;
+	}
+
+	memcpy(entry.ssid, status.ssid, status.ssid_len);
+	entry.ssid_len = status.ssid_len;
+	memcpy(entry.bssid, status.bssid, sizeof(entry.bssid));
+	entry.channel = status.channel;
+	entry.band = status.band;
+
+	if (memcmp(&entry, &ap, sizeof(ap)) == 0) {
+		return;
+	}
+
+	ap = entry;
+
+	/* Flash is written only when the AP, its channel or band changed */
+	err = settings_save_one(SETTINGS_SUBTREE "/" SETTINGS_KEY, &ap, sizeof(ap));
+	if (err) {
+		LOG_WRN("Failed to persist the AP: %d", err);
+	}
+}
+
+void wifi_ap_cache_clear(void)
+{
+	if (ap.ssid_len == 0) {
+		return;
+	}
+
+	memset(&ap, 0, sizeof(ap));
+	(void)settings_delete(SETTINGS_SUBTREE "/" SETTINGS_KEY);
+}
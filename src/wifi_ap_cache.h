@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Load the last AP connected to from settings.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int wifi_ap_cache_init(void);
+
+/**
+ * @brief Check whether an AP is cached.
+ */
+bool wifi_ap_cache_valid(void);
+
+/**
+ * @brief Connect to the cached AP, scanning only its channel.
+ *
+ * The result is reported by NET_EVENT_WIFI_CONNECT_RESULT like any other
+ * connect request.
+ *
+ * @return 0 if the request was issued, -ENOENT without a cached AP or
+ *         credentials for it, other negative error codes from net_mgmt
+ */
+int wifi_ap_cache_connect(void);
+
+/**
+ * @brief Remember the AP of the current connection.
+ *
+ * Written to settings only when BSSID, channel or band changed.
+ */
+void wifi_ap_cache_update(void);
+
+/**
+ * @brief Forget the cached AP, e.g. after new credentials were provisioned.
+ */
+void wifi_ap_cache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
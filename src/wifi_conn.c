@@ -0,0 +1,540 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Wi-Fi connectivity manager. The boot, BLE provisioning and link losses
+ * all feed one state machine on the system workqueue, which is the only
+ * place that asks the interface to connect:
+ *
+ *   IDLE --start--> CONNECTING --result ok--> CONNECTED
+ *                    |      ^                    |
+ *              fail  |      | timer         lost |
+ *                    v      |                    |
+ *                   BACKOFF <--------------------+
+ *                    |      ^
+ *    auth fail x N   |      | timer
+ *                    v      |
+ *                   AUTH_HOLD
+ *
+ * Retries follow a jittered exponential backoff. Rejected credentials open a
+ * circuit breaker that holds off the AP much longer, a wrong password does
+ * not fix itself; provisioning new credentials closes it. While waiting the
+ * interface is disconnected, so the supplicant does not retry on its own.
+ *
+ * The first attempt waits for the supplicant to report ready rather than a
+ * fixed delay, bounded by CONFIG_WIFI_CONN_READY_TIMEOUT_SEC.
+ *
+ * With CONFIG_WIFI_CONN_FAST_RECONNECT the first attempt after a link loss
+ * or boot goes to the last AP on its channel only (wifi_ap_cache.c). A miss
+ * falls back to a full scan right away, without a backoff step.
+ */
+
+#include "wifi_conn.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/conn_mgr_connectivity.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/net_mgmt.h>
+#include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/net/wifi_nm.h>
+#include <zephyr/net/wifi_credentials.h>
+#include <memfault/metrics/metrics.h>
+#include <supp_events.h>
+
+#include "boot_timeline.h"
+#include "net_policy.h"
+#include "wifi_ap_cache.h"
+
+LOG_MODULE_REGISTER(wifi_conn, CONFIG_MEMFAULT_SAMPLE_LOG_LEVEL);
+
+#define WIFI_EVENT_MASK (NET_EVENT_WIFI_CONNECT_RESULT | NET_EVENT_WIFI_DISCONNECT_RESULT)
+#define CONN_EVENT_MASK (NET_EVENT_CONN_IF_FATAL_ERROR | NET_EVENT_CONN_IF_TIMEOUT)
+#define SUPP_EVENT_MASK (NET_EVENT_SUPPLICANT_READY)
+
+/* Time for the provisioning client to finish before the first attempt */
+#define PROVISIONED_DELAY K_SECONDS(2)
+
+/* Lets the aborted fast attempt be torn down before the full scan */
+#define FAST_FALLBACK_DELAY_MS 250
+
+#define EVENT_QUEUE_LEN 8
+
+enum conn_event {
+	EVT_READY,
+	EVT_START,
+	EVT_CREDENTIALS,
+	EVT_PAUSE,
+	EVT_RESUME,
+	EVT_ASSOCIATED,
+	EVT_FAILED,
+	EVT_AUTH_FAILED,
+	EVT_DISCONNECTED,
+};
+
+static const char *const state_names[] = {
+	[WIFI_CONN_IDLE] = "idle",
+	[WIFI_CONN_CONNECTING] = "connecting",
+	[WIFI_CONN_CONNECTED] = "connected",
+	[WIFI_CONN_BACKOFF] = "backoff",
+	[WIFI_CONN_AUTH_HOLD] = "auth hold",
+};
+
+/* Totals of the current heartbeat interval */
+struct conn_stats {
+	uint32_t attempts;
+	uint32_t failures;
+	uint32_t auth_failures;
+	uint32_t losses;
+	uint32_t fast_hits;
+	uint32_t fast_misses;
+	uint32_t fast_ms;
+	uint32_t full_count;
+	uint32_t full_ms;
+	uint32_t state_ms[WIFI_CONN_STATE_COUNT];
+};
+
+static struct k_spinlock lock;
+static struct conn_stats stats;
+static enum wifi_conn_state state;
+static int64_t state_entered_at;
+
+/* Owned by the system workqueue */
+static bool ready;
+static bool start_pending;
+static bool paused;
+static struct net_backoff backoff;
+static struct net_breaker auth_breaker;
+/* Start of the current outage, 0 while connected */
+static int64_t down_since;
+/* The pending attempt went to the cached AP */
+static bool fast_attempt;
+/* The cached AP was tried in the current outage */
+static bool fast_tried;
+
+K_MSGQ_DEFINE(event_q, sizeof(uint8_t), EVENT_QUEUE_LEN, 1);
+
+static void event_work_fn(struct k_work *work);
+static K_WORK_DEFINE(event_work, event_work_fn);
+static void timer_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(timer_work, timer_work_fn);
+
+static struct net_mgmt_event_callback wifi_cb;
+static struct net_mgmt_event_callback conn_cb;
+static struct net_mgmt_event_callback supp_cb;
+
+static void event_post(enum conn_event evt)
+{
+	uint8_t e = evt;
+
+	if (k_msgq_put(&event_q, &e, K_NO_WAIT)) {
+		LOG_WRN("Event queue full, event %u dropped", e);
+		return;
+	}
+
+	k_work_submit(&event_work);
+}
+
+static void stat_add(uint32_t *counter)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	(*counter)++;
+	k_spin_unlock(&lock, key);
+}
+
+static void state_set(enum wifi_conn_state next)
+{
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	stats.state_ms[state] += (uint32_t)(now - state_entered_at);
+	state = next;
+	state_entered_at = now;
+	k_spin_unlock(&lock, key);
+
+	LOG_DBG("State %s", state_names[next]);
+}
+
+/* Stop the supplicant from retrying on its own, then wait */
+static void wait(enum wifi_conn_state next, uint32_t delay_ms)
+{
+	int err;
+
+	state_set(next);
+
+	err = conn_mgr_all_if_disconnect(true);
+	if (err) {
+		LOG_DBG("conn_mgr_all_if_disconnect: %d", err);
+	}
+
+	k_work_reschedule(&timer_work, K_MSEC(delay_ms));
+}
+
+static void failed(bool auth)
+{
+	uint32_t delay_ms;
+
+	if (fast_attempt) {
+		fast_attempt = false;
+		stat_add(&stats.fast_misses);
+		if (!auth) {
+			LOG_INF("Cached AP not found, scanning all channels");
+			wait(WIFI_CONN_BACKOFF, FAST_FALLBACK_DELAY_MS);
+			return;
+		}
+	}
+
+	stat_add(&stats.failures);
+
+	if (auth) {
+		stat_add(&stats.auth_failures);
+		if (net_breaker_failure(&auth_breaker)) {
+			delay_ms = net_breaker_remaining_ms(&auth_breaker);
+			LOG_WRN("Credentials rejected by the AP, next attempt in %u s",
+				delay_ms / MSEC_PER_SEC);
+			wait(WIFI_CONN_AUTH_HOLD, delay_ms);
+			return;
+		}
+	}
+
+	delay_ms = net_backoff_next_ms(&backoff);
+	LOG_INF("Wi-Fi connection attempt failed, retry in %u ms", delay_ms);
+	wait(WIFI_CONN_BACKOFF, delay_ms);
+}
+
+static void attempt(void)
+{
+	int err;
+
+	if (wifi_credentials_is_empty()) {
+		LOG_INF("No stored Wi-Fi credentials, waiting for provisioning");
+		state_set(WIFI_CONN_IDLE);
+		return;
+	}
+
+	stat_add(&stats.attempts);
+	state_set(WIFI_CONN_CONNECTING);
+
+	err = conn_mgr_all_if_up(true);
+	if (err) {
+		LOG_ERR("Wi-Fi interface up failed: %d", err);
+		failed(false);
+		return;
+	}
+
+#ifdef CONFIG_WIFI_CONN_FAST_RECONNECT
+	if (!fast_tried && wifi_ap_cache_valid()) {
+		fast_tried = true;
+		fast_attempt = (wifi_ap_cache_connect() == 0);
+	}
+
+	if (fast_attempt) {
+		k_work_reschedule(&timer_work, K_SECONDS(CONFIG_WIFI_CONN_FAST_TIMEOUT_SEC));
+		return;
+	}
+#endif
+
+	k_work_reschedule(&timer_work, K_SECONDS(CONFIG_WIFI_CONN_ATTEMPT_TIMEOUT_SEC));
+
+	err = conn_mgr_all_if_connect(true);
+	if (err) {
+		LOG_ERR("Wi-Fi connect request failed: %d", err);
+		failed(false);
+	}
+}
+
+/* Time to connect, split by whether the cached AP was hit */
+static void connected(void)
+{
+	uint32_t elapsed_ms = (uint32_t)(k_uptime_get() - down_since);
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	if (down_since == 0) {
+		/* Not an attempt of ours, nothing to time */
+	} else if (fast_attempt) {
+		stats.fast_hits++;
+		stats.fast_ms += elapsed_ms;
+	} else {
+		stats.full_count++;
+		stats.full_ms += elapsed_ms;
+	}
+	k_spin_unlock(&lock, key);
+
+	LOG_INF("Wi-Fi connected after %u ms%s", elapsed_ms, fast_attempt ? " (cached AP)" : "");
+
+	down_since = 0;
+	fast_attempt = false;
+	fast_tried = false;
+
+#ifdef CONFIG_WIFI_CONN_FAST_RECONNECT
+	wifi_ap_cache_update();
+#endif
+}
+
+static void handle(enum conn_event evt)
+{
+	switch (evt) {
+	case EVT_READY:
+		ready = true;
+		boot_timeline_mark(BOOT_PHASE_WIFI_READY);
+		if (start_pending) {
+			start_pending = false;
+			k_work_cancel_delayable(&timer_work);
+			if (state == WIFI_CONN_IDLE && !paused) {
+				attempt();
+			}
+		}
+		break;
+	case EVT_START:
+		down_since = k_uptime_get();
+		if (!ready && !wifi_nm_get_instance_iface(net_if_get_first_wifi())) {
+			/* The supplicant registers the interface once it is up */
+			LOG_INF("Waiting for the Wi-Fi supplicant");
+			start_pending = true;
+			k_work_reschedule(&timer_work, K_SECONDS(CONFIG_WIFI_CONN_READY_TIMEOUT_SEC));
+			break;
+		}
+		if (!ready) {
+			ready = true;
+			boot_timeline_mark(BOOT_PHASE_WIFI_READY);
+		}
+		if (state == WIFI_CONN_IDLE && !paused) {
+			attempt();
+		}
+		break;
+	case EVT_CREDENTIALS:
+		/* The backoff and hold were earned by the previous AP */
+		net_backoff_reset(&backoff);
+		net_breaker_success(&auth_breaker);
+#ifdef CONFIG_WIFI_CONN_FAST_RECONNECT
+		wifi_ap_cache_clear();
+#endif
+		if (state != WIFI_CONN_CONNECTED && state != WIFI_CONN_CONNECTING) {
+			down_since = k_uptime_get();
+			k_work_reschedule(&timer_work, PROVISIONED_DELAY);
+		}
+		break;
+	case EVT_PAUSE:
+		paused = true;
+		break;
+	case EVT_RESUME:
+		paused = false;
+		/* An attempt came due while paused */
+		if ((state == WIFI_CONN_BACKOFF || state == WIFI_CONN_AUTH_HOLD) &&
+		    !k_work_delayable_is_pending(&timer_work)) {
+			attempt();
+		}
+		break;
+	case EVT_ASSOCIATED:
+		if (state == WIFI_CONN_CONNECTED) {
+			break;
+		}
+		k_work_cancel_delayable(&timer_work);
+		net_backoff_reset(&backoff);
+		net_breaker_success(&auth_breaker);
+		state_set(WIFI_CONN_CONNECTED);
+		boot_timeline_mark(BOOT_PHASE_WIFI_CONNECTED);
+		connected();
+		break;
+	case EVT_FAILED:
+	case EVT_AUTH_FAILED:
+		/* Results arriving while waiting belong to an aborted attempt */
+		if (state == WIFI_CONN_CONNECTING) {
+			failed(evt == EVT_AUTH_FAILED);
+		}
+		break;
+	case EVT_DISCONNECTED:
+		if (state == WIFI_CONN_CONNECTING) {
+			failed(false);
+		} else if (state == WIFI_CONN_CONNECTED) {
+			uint32_t delay_ms = net_backoff_next_ms(&backoff);
+
+			stat_add(&stats.losses);
+			down_since = k_uptime_get();
+			LOG_INF("Wi-Fi link lost, reconnect in %u ms", delay_ms);
+			wait(WIFI_CONN_BACKOFF, delay_ms);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static void event_work_fn(struct k_work *work)
+{
+	uint8_t evt;
+
+	ARG_UNUSED(work);
+
+	while (k_msgq_get(&event_q, &evt, K_NO_WAIT) == 0) {
+		handle(evt);
+	}
+}
+
+static void timer_work_fn(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	switch (state) {
+	case WIFI_CONN_CONNECTING:
+		LOG_WRN("No Wi-Fi connection result within %d s",
+			fast_attempt ? CONFIG_WIFI_CONN_FAST_TIMEOUT_SEC
+				     : CONFIG_WIFI_CONN_ATTEMPT_TIMEOUT_SEC);
+		failed(false);
+		break;
+	case WIFI_CONN_CONNECTED:
+		break;
+	default:
+		if (start_pending) {
+			start_pending = false;
+			LOG_WRN("Wi-Fi supplicant not ready within %d s, trying anyway",
+				CONFIG_WIFI_CONN_READY_TIMEOUT_SEC);
+		}
+		if (paused) {
+			LOG_INF("Provisioning client connected, Wi-Fi attempt deferred");
+			break;
+		}
+		if (state == WIFI_CONN_AUTH_HOLD) {
+			/* Trial attempt, another rejection re-opens the breaker */
+			(void)net_breaker_allow(&auth_breaker);
+		}
+		attempt();
+		break;
+	}
+}
+
+static void wifi_event_handler(struct net_mgmt_event_callback *cb, uint64_t mgmt_event,
+			       struct net_if *iface)
+{
+	const struct wifi_status *status = (const struct wifi_status *)cb->info;
+
+	ARG_UNUSED(iface);
+
+	switch (mgmt_event) {
+	case NET_EVENT_WIFI_CONNECT_RESULT:
+		if (status && status->status == WIFI_STATUS_CONN_SUCCESS) {
+			event_post(EVT_ASSOCIATED);
+		} else if (status && status->status == WIFI_STATUS_CONN_WRONG_PASSWORD) {
+			event_post(EVT_AUTH_FAILED);
+		} else {
+			event_post(EVT_FAILED);
+		}
+		break;
+	case NET_EVENT_WIFI_DISCONNECT_RESULT:
+		event_post(EVT_DISCONNECTED);
+		break;
+	default:
+		break;
+	}
+}
+
+static void conn_event_handler(struct net_mgmt_event_callback *cb, uint64_t mgmt_event,
+			       struct net_if *iface)
+{
+	ARG_UNUSED(cb);
+	ARG_UNUSED(iface);
+
+	LOG_WRN("Connectivity %s", mgmt_event == NET_EVENT_CONN_IF_TIMEOUT ? "timeout"
+									 : "fatal error");
+	event_post(EVT_DISCONNECTED);
+}
+
+static void supp_event_handler(struct net_mgmt_event_callback *cb, uint64_t mgmt_event,
+			       struct net_if *iface)
+{
+	ARG_UNUSED(cb);
+	ARG_UNUSED(mgmt_event);
+	ARG_UNUSED(iface);
+
+	event_post(EVT_READY);
+}
+
+void wifi_conn_init(void)
+{
+	net_backoff_init(&backoff, CONFIG_WIFI_CONN_BACKOFF_BASE_SEC * MSEC_PER_SEC,
+			 CONFIG_WIFI_CONN_BACKOFF_CAP_SEC * MSEC_PER_SEC);
+	net_breaker_init(&auth_breaker, CONFIG_WIFI_CONN_AUTH_FAIL_THRESHOLD,
+			 CONFIG_WIFI_CONN_AUTH_HOLD_SEC * MSEC_PER_SEC);
+	state_entered_at = k_uptime_get();
+
+#ifdef CONFIG_WIFI_CONN_FAST_RECONNECT
+	if (wifi_ap_cache_init()) {
+		LOG_WRN("AP cache unavailable, reconnects scan all channels");
+	}
+#endif
+
+	net_mgmt_init_event_callback(&wifi_cb, wifi_event_handler, WIFI_EVENT_MASK);
+	net_mgmt_add_event_callback(&wifi_cb);
+
+	net_mgmt_init_event_callback(&conn_cb, conn_event_handler, CONN_EVENT_MASK);
+	net_mgmt_add_event_callback(&conn_cb);
+
+	net_mgmt_init_event_callback(&supp_cb, supp_event_handler, SUPP_EVENT_MASK);
+	net_mgmt_add_event_callback(&supp_cb);
+}
+
+void wifi_conn_start(void)
+{
+	event_post(EVT_START);
+}
+
+void wifi_conn_credentials_changed(void)
+{
+	event_post(EVT_CREDENTIALS);
+}
+
+void wifi_conn_pause(bool pause)
+{
+	event_post(pause ? EVT_PAUSE : EVT_RESUME);
+}
+
+enum wifi_conn_state wifi_conn_state_get(void)
+{
+	return state;
+}
+
+void wifi_conn_collect(void)
+{
+	struct conn_stats interval;
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	stats.state_ms[state] += (uint32_t)(now - state_entered_at);
+	state_entered_at = now;
+	interval = stats;
+	memset(&stats, 0, sizeof(stats));
+	k_spin_unlock(&lock, key);
+
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_attempt_count, interval.attempts);
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_fail_count, interval.failures);
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_auth_fail_count, interval.auth_failures);
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_loss_count, interval.losses);
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_connecting_ms,
+				     interval.state_ms[WIFI_CONN_CONNECTING]);
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_backoff_ms, interval.state_ms[WIFI_CONN_BACKOFF]);
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_auth_hold_ms,
+				     interval.state_ms[WIFI_CONN_AUTH_HOLD]);
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_fast_hit_count, interval.fast_hits);
+	MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_fast_miss_count, interval.fast_misses);
+
+	/* Leave timing metrics unset for intervals without a connection */
+	if (interval.fast_hits > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_fast_connect_avg_ms,
+					     interval.fast_ms / interval.fast_hits);
+	}
+
+	if (interval.full_count > 0) {
+		MEMFAULT_METRIC_SET_UNSIGNED(wifi_conn_full_connect_avg_ms,
+					     interval.full_ms / interval.full_count);
+	}
+
+	LOG_INF("Wi-Fi interval - attempts: %u, failures: %u (auth %u), losses: %u, "
+		"backoff: %u ms",
+		interval.attempts, interval.failures, interval.auth_failures, interval.losses,
+		interval.state_ms[WIFI_CONN_BACKOFF]);
+}
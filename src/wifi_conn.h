@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** States of the Wi-Fi connectivity manager. */
+enum wifi_conn_state {
+	/** Not started or no credentials stored */
+	WIFI_CONN_IDLE,
+	/** Connect request issued, waiting for the result */
+	WIFI_CONN_CONNECTING,
+	/** Associated with the AP */
+	WIFI_CONN_CONNECTED,
+	/** Waiting before the next attempt */
+	WIFI_CONN_BACKOFF,
+	/** AP rejected the credentials repeatedly, attempts held off */
+	WIFI_CONN_AUTH_HOLD,
+	WIFI_CONN_STATE_COUNT,
+};
+
+/**
+ * @brief Register for Wi-Fi and connectivity events.
+ *
+ * Must be called before any other function of this module.
+ */
+void wifi_conn_init(void);
+
+/**
+ * @brief Start connecting with the stored credentials.
+ *
+ * Without credentials the manager stays idle until
+ * wifi_conn_credentials_changed() is called.
+ */
+void wifi_conn_start(void);
+
+/**
+ * @brief Report newly provisioned credentials.
+ *
+ * Clears the backoff and the authentication hold, which belong to the
+ * previous AP, and connects shortly after unless already connected.
+ */
+void wifi_conn_credentials_changed(void);
+
+/**
+ * @brief Hold connection attempts, e.g. while a provisioning client is connected.
+ *
+ * @param pause true to hold attempts, false to resume them.
+ */
+void wifi_conn_pause(bool pause);
+
+/**
+ * @brief Get the current state.
+ */
+enum wifi_conn_state wifi_conn_state_get(void);
+
+/**
+ * @brief Publish attempt counters and time in state of the elapsed interval.
+ *
+ * Called from memfault_metrics_heartbeat_collect_data().
+ */
+void wifi_conn_collect(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Stand-in for the Memfault SDK metrics API, heartbeat metrics are not
+ * checked by the test.
+ */
+
+#pragma once
+
+#define MEMFAULT_METRIC_SET_UNSIGNED(key, value) ((void)(value), 0)
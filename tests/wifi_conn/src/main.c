@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2026 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ *
+ * Fast reconnect of the Wi-Fi connectivity manager against a mocked Wi-Fi
+ * management layer. A fake interface on the dummy L2 stands in for the nRF70:
+ *
+ * - connect requests to the cached AP end up in the NET_REQUEST_WIFI_CONNECT
+ *   handler below, which records them,
+ * - full scans go through the connection manager to the connectivity
+ *   implementation bound to the interface, which counts them,
+ * - the AP the interface is associated with is reported by the
+ *   NET_REQUEST_WIFI_IFACE_STATUS handler,
+ * - connect results and link losses are raised as Wi-Fi management events.
+ *
+ * Every test starts and ends connected to current_ap, with the AP cached.
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/net/conn_mgr_connectivity.h>
+#include <zephyr/net/conn_mgr_connectivity_impl.h>
+#include <zephyr/net/dummy.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/net_mgmt.h>
+#include <zephyr/net/wifi_credentials.h>
+#include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/net/wifi_nm.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/ztest.h>
+#include <supp_events.h>
+
+#include "boot_timeline.h"
+#include "wifi_ap_cache.h"
+#include "wifi_conn.h"
+
+/* Longest backoff after a loss plus the fast attempt timeout, with margin */
+#define WAIT_TIMEOUT_US (6 * USEC_PER_SEC)
+
+#define WAIT_UNTIL(expr) zassert_true(WAIT_FOR(expr, WAIT_TIMEOUT_US, k_msleep(10)), #expr)
+
+struct fake_ap {
+	const char *ssid;
+	const char *password;
+	uint8_t bssid[WIFI_MAC_ADDR_LEN];
+	uint8_t channel;
+	enum wifi_frequency_bands band;
+};
+
+static const struct fake_ap ap_home = {
+	.ssid = "home",
+	.password = "home-password",
+	.bssid = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01},
+	.channel = 6,
+	.band = WIFI_FREQ_BAND_2_4_GHZ,
+};
+
+static const struct fake_ap ap_office = {
+	.ssid = "office",
+	.password = "office-password",
+	.bssid = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02},
+	.channel = 36,
+	.band = WIFI_FREQ_BAND_5_GHZ,
+};
+
+/* AP with stored credentials, reported by the interface once associated */
+static const struct fake_ap *current_ap;
+
+static struct net_if *iface;
+
+/* Connect requests to the cached AP and full scans seen so far */
+static atomic_t fast_connects;
+static atomic_t full_connects;
+
+/* Last connect request to the cached AP, copied as the caller wipes the PSK */
+static struct wifi_connect_req_params last_req;
+static char last_ssid[WIFI_SSID_MAX_LEN + 1];
+static char last_psk[WIFI_CREDENTIALS_MAX_PASSWORD_LEN + 1];
+
+int net_mgmt_NET_REQUEST_WIFI_CONNECT(uint64_t mgmt_request, struct net_if *req_iface,
+				      void *data, size_t len)
+{
+	const struct wifi_connect_req_params *params = data;
+
+	ARG_UNUSED(mgmt_request);
+
+	if (req_iface != iface || len != sizeof(*params) ||
+	    params->ssid_length >= sizeof(last_ssid) || params->psk_length >= sizeof(last_psk)) {
+		return -EINVAL;
+	}
+
+	last_req = *params;
+	memset(last_ssid, 0, sizeof(last_ssid));
+	memcpy(last_ssid, params->ssid, params->ssid_length);
+	memset(last_psk, 0, sizeof(last_psk));
+	memcpy(last_psk, params->psk, params->psk_length);
+
+	atomic_inc(&fast_connects);
+	return 0;
+}
+
+int net_mgmt_NET_REQUEST_WIFI_IFACE_STATUS(uint64_t mgmt_request, struct net_if *req_iface,
+					   void *data, size_t len)
+{
+	struct wifi_iface_status *status = data;
+
+	ARG_UNUSED(mgmt_request);
+
+	if (req_iface != iface || len != sizeof(*status)) {
+		return -EINVAL;
+	}
+
+	memset(status, 0, sizeof(*status));
+	status->state = WIFI_STATE_COMPLETED;
+	status->ssid_len = strlen(current_ap->ssid);
+	memcpy(status->ssid, current_ap->ssid, status->ssid_len);
+	memcpy(status->bssid, current_ap->bssid, sizeof(status->bssid));
+	status->channel = current_ap->channel;
+	status->band = current_ap->band;
+
+	return 0;
+}
+
+/* No supplicant, readiness is reported with NET_EVENT_SUPPLICANT_READY */
+struct wifi_nm_instance *wifi_nm_get_instance_iface(struct net_if *nm_iface)
+{
+	ARG_UNUSED(nm_iface);
+
+	return NULL;
+}
+
+void boot_timeline_mark(enum boot_phase phase)
+{
+	ARG_UNUSED(phase);
+}
+
+static int fake_conn_connect(struct conn_mgr_conn_binding *const binding)
+{
+	ARG_UNUSED(binding);
+
+	atomic_inc(&full_connects);
+	return 0;
+}
+
+static int fake_conn_disconnect(struct conn_mgr_conn_binding *const binding)
+{
+	ARG_UNUSED(binding);
+
+	return 0;
+}
+
+static void fake_conn_init(struct conn_mgr_conn_binding *const binding)
+{
+	/* Only wifi_conn.c asks for connections */
+	conn_mgr_binding_set_flag(binding, CONN_MGR_IF_NO_AUTO_CONNECT, true);
+	conn_mgr_binding_set_flag(binding, CONN_MGR_IF_NO_AUTO_DOWN, true);
+}
+
+static struct conn_mgr_conn_api fake_conn_api = {
+	.connect = fake_conn_connect,
+	.disconnect = fake_conn_disconnect,
+	.init = fake_conn_init,
+};
+
+#define FAKE_WIFI_CONN_CTX_TYPE int
+CONN_MGR_CONN_DEFINE(FAKE_WIFI_CONN, &fake_conn_api);
+
+static uint8_t fake_mac[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x10};
+
+static void fake_iface_init(struct net_if *init_iface)
+{
+	net_if_set_link_addr(init_iface, fake_mac, sizeof(fake_mac), NET_LINK_ETHERNET);
+}
+
+static int fake_iface_send(const struct device *dev, struct net_pkt *pkt)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static const struct dummy_api fake_iface_api = {
+	.iface_api.init = fake_iface_init,
+	.send = fake_iface_send,
+};
+
+NET_DEVICE_INIT(fake_wifi, "fake_wifi", NULL, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &fake_iface_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 1500);
+
+CONN_MGR_BIND_CONN(fake_wifi, FAKE_WIFI_CONN);
+
+static void provision(const struct fake_ap *ap)
+{
+	struct wifi_credentials_personal creds = {
+		.header = {
+			.type = WIFI_SECURITY_TYPE_PSK,
+			.ssid_len = strlen(ap->ssid),
+		},
+		.password_len = strlen(ap->password),
+	};
+
+	memcpy(creds.header.ssid, ap->ssid, creds.header.ssid_len);
+	memcpy(creds.password, ap->password, creds.password_len);
+
+	if (current_ap) {
+		zassert_ok(wifi_credentials_delete_by_ssid(current_ap->ssid,
+							   strlen(current_ap->ssid)));
+	}
+
+	zassert_ok(wifi_credentials_set_personal_struct(&creds));
+	current_ap = ap;
+}
+
+static void raise_connect_result(enum wifi_conn_status result)
+{
+	struct wifi_status status = {.status = result};
+
+	net_mgmt_event_notify_with_info(NET_EVENT_WIFI_CONNECT_RESULT, iface, &status,
+					sizeof(status));
+}
+
+static void associate(void)
+{
+	raise_connect_result(WIFI_STATUS_CONN_SUCCESS);
+	WAIT_UNTIL(wifi_conn_state_get() == WIFI_CONN_CONNECTED);
+}
+
+static void link_lost(void)
+{
+	net_mgmt_event_notify(NET_EVENT_WIFI_DISCONNECT_RESULT, iface);
+	WAIT_UNTIL(wifi_conn_state_get() != WIFI_CONN_CONNECTED);
+}
+
+static void expect_fast_connect(const struct fake_ap *ap)
+{
+	zassert_str_equal(last_ssid, ap->ssid);
+	zassert_str_equal(last_psk, ap->password);
+	zassert_equal(last_req.security, WIFI_SECURITY_TYPE_PSK);
+	zassert_mem_equal(last_req.bssid, ap->bssid, sizeof(last_req.bssid));
+	zassert_equal(last_req.channel, ap->channel);
+	zassert_equal(last_req.band, ap->band);
+}
+
+static void *wifi_conn_setup(void)
+{
+	atomic_val_t full = atomic_get(&full_connects);
+
+	iface = net_if_get_default();
+	zassert_not_null(iface);
+
+	provision(&ap_home);
+
+	wifi_conn_init();
+	wifi_conn_start();
+	net_mgmt_event_notify(NET_EVENT_SUPPLICANT_READY, iface);
+
+	/* Nothing cached at the first boot */
+	WAIT_UNTIL(atomic_get(&full_connects) == full + 1);
+	zassert_equal(atomic_get(&fast_connects), 0);
+
+	associate();
+	zassert_true(wifi_ap_cache_valid());
+
+	return NULL;
+}
+
+ZTEST(wifi_conn, test_cache_hit)
+{
+	atomic_val_t fast = atomic_get(&fast_connects);
+	atomic_val_t full = atomic_get(&full_connects);
+
+	link_lost();
+
+	WAIT_UNTIL(atomic_get(&fast_connects) == fast + 1);
+	expect_fast_connect(current_ap);
+
+	associate();
+	zassert_equal(atomic_get(&full_connects), full, "full scan despite a cache hit");
+}
+
+ZTEST(wifi_conn, test_cache_miss_falls_back_to_full_scan)
+{
+	atomic_val_t fast = atomic_get(&fast_connects);
+	atomic_val_t full = atomic_get(&full_connects);
+
+	link_lost();
+
+	WAIT_UNTIL(atomic_get(&fast_connects) == fast + 1);
+	raise_connect_result(WIFI_STATUS_CONN_FAIL);
+
+	WAIT_UNTIL(atomic_get(&full_connects) == full + 1);
+	zassert_equal(atomic_get(&fast_connects), fast + 1, "cached AP tried twice");
+
+	associate();
+	zassert_true(wifi_ap_cache_valid());
+}
+
+ZTEST(wifi_conn, test_cache_timeout_falls_back_to_full_scan)
+{
+	atomic_val_t fast = atomic_get(&fast_connects);
+	atomic_val_t full = atomic_get(&full_connects);
+
+	link_lost();
+
+	/* No result for the cached AP within CONFIG_WIFI_CONN_FAST_TIMEOUT_SEC */
+	WAIT_UNTIL(atomic_get(&fast_connects) == fast + 1);
+	WAIT_UNTIL(atomic_get(&full_connects) == full + 1);
+	zassert_equal(atomic_get(&fast_connects), fast + 1, "cached AP tried twice");
+
+	associate();
+}
+
+ZTEST(wifi_conn, test_reprovisioning_invalidates_cache)
+{
+	atomic_val_t fast;
+	atomic_val_t full;
+
+	provision(&ap_office);
+	wifi_conn_credentials_changed();
+	WAIT_UNTIL(!wifi_ap_cache_valid());
+
+	fast = atomic_get(&fast_connects);
+	full = atomic_get(&full_connects);
+
+	link_lost();
+
+	WAIT_UNTIL(atomic_get(&full_connects) == full + 1);
+	zassert_equal(atomic_get(&fast_connects), fast, "previous AP tried after reprovisioning");
+
+	/* The new AP is cached once connected */
+	associate();
+	zassert_true(wifi_ap_cache_valid());
+
+	link_lost();
+
+	WAIT_UNTIL(atomic_get(&fast_connects) == fast + 1);
+	expect_fast_connect(&ap_office);
+
+	associate();
+}
+
+ZTEST_SUITE(wifi_conn, NULL, wifi_conn_setup, NULL, NULL, NULL);